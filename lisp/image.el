@@ -844,6 +844,16 @@ defimage
   (declare (doc-string 3) (indent defun))
   `(defvar ,symbol (find-image ',specs) ,doc))
 
+(defun image--display-deferred ()
+  "Display the images whose loading redisplay deferred.
+Redisplay arranges for this to be called when Emacs is idle, after
+it deferred loading images because of `image-load-time-limit'.
+Redisplay again until all images are loaded, or until there is input
+to process."
+  (while (and (image-display-deferred)
+              (not (input-pending-p)))
+    (redisplay)))
+
 
 ;;; Animated image API
 
@@ -0,0 +1,2626 @@
+;;; emoji-zwj.el --- emoji zwj character composition table  -*- lexical-binding:t -*-
+;;; Automatically generated from admin/unidata/emoji-{zwj-,}sequences.txt
+(eval-when-compile (require 'regexp-opt))
+(setq auto-composition-emoji-eligible-codepoints
+'(
+?\N{U+270C}
+?\N{U+1F441}
+?\N{U+1F3F3}
+?\N{U+1F3CB}
+?\N{U+2764}
+?\N{U+26F9}
+?\N{U+1F574}
+?\N{U+261D}
+?\N{U+270D}
+?\N{U+1F575}
+?\N{U+1F3F4}
+?\N{U+1F3CC}
+?\N{U+1F590}
+))
+
+(dolist (elt `(
+(#x1F932 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F932}\N{U+1F3FB}"
+"\N{U+1F932}\N{U+1F3FC}"
+"\N{U+1F932}\N{U+1F3FD}"
+"\N{U+1F932}\N{U+1F3FE}"
+"\N{U+1F932}\N{U+1F3FF}"
+))))
+(#x270B .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+270B}\N{U+1F3FB}"
+"\N{U+270B}\N{U+1F3FC}"
+"\N{U+270B}\N{U+1F3FD}"
+"\N{U+270B}\N{U+1F3FE}"
+"\N{U+270B}\N{U+1F3FF}"
+))))
+(#x1F3F3 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3F3}\N{U+FE0F}\N{U+200D}\N{U+26A7}\N{U+FE0F}"
+"\N{U+1F3F3}\N{U+FE0F}\N{U+200D}\N{U+1F308}"
+"\N{U+1F3F3}\N{U+FE0F}"
+))))
+(#x1F9D8 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D8}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D8}\N{U+1F3FB}"
+"\N{U+1F9D8}\N{U+1F3FC}"
+"\N{U+1F9D8}\N{U+1F3FD}"
+"\N{U+1F9D8}\N{U+1F3FE}"
+"\N{U+1F9D8}\N{U+1F3FF}"
+))))
+(#x1F3C7 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3C7}\N{U+1F3FB}"
+"\N{U+1F3C7}\N{U+1F3FC}"
+"\N{U+1F3C7}\N{U+1F3FD}"
+"\N{U+1F3C7}\N{U+1F3FE}"
+"\N{U+1F3C7}\N{U+1F3FF}"
+))))
+(#x1F93D .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F93D}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93D}\N{U+1F3FB}"
+"\N{U+1F93D}\N{U+1F3FC}"
+"\N{U+1F93D}\N{U+1F3FD}"
+"\N{U+1F93D}\N{U+1F3FE}"
+"\N{U+1F93D}\N{U+1F3FF}"
+))))
+(#x1F64B .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F64B}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64B}\N{U+1F3FB}"
+"\N{U+1F64B}\N{U+1F3FC}"
+"\N{U+1F64B}\N{U+1F3FD}"
+"\N{U+1F64B}\N{U+1F3FE}"
+"\N{U+1F64B}\N{U+1F3FF}"
+))))
+(#x1F574 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F574}\N{U+1F3FB}"
+"\N{U+1F574}\N{U+1F3FC}"
+"\N{U+1F574}\N{U+1F3FD}"
+"\N{U+1F574}\N{U+1F3FE}"
+"\N{U+1F574}\N{U+1F3FF}"
+"\N{U+1F574}\N{U+FE0F}"
+))))
+(#x1FAF0 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAF0}\N{U+1F3FB}"
+"\N{U+1FAF0}\N{U+1F3FC}"
+"\N{U+1FAF0}\N{U+1F3FD}"
+"\N{U+1FAF0}\N{U+1F3FE}"
+"\N{U+1FAF0}\N{U+1F3FF}"
+))))
+(#x1F9D2 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D2}\N{U+1F3FB}"
+"\N{U+1F9D2}\N{U+1F3FC}"
+"\N{U+1F9D2}\N{U+1F3FD}"
+"\N{U+1F9D2}\N{U+1F3FE}"
+"\N{U+1F9D2}\N{U+1F3FF}"
+))))
+(#x1F977 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F977}\N{U+1F3FB}"
+"\N{U+1F977}\N{U+1F3FC}"
+"\N{U+1F977}\N{U+1F3FD}"
+"\N{U+1F977}\N{U+1F3FE}"
+"\N{U+1F977}\N{U+1F3FF}"
+))))
+(#x1F483 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F483}\N{U+1F3FB}"
+"\N{U+1F483}\N{U+1F3FC}"
+"\N{U+1F483}\N{U+1F3FD}"
+"\N{U+1F483}\N{U+1F3FE}"
+"\N{U+1F483}\N{U+1F3FF}"
+))))
+(#x1F9B9 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9B9}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B9}\N{U+1F3FB}"
+"\N{U+1F9B9}\N{U+1F3FC}"
+"\N{U+1F9B9}\N{U+1F3FD}"
+"\N{U+1F9B9}\N{U+1F3FE}"
+"\N{U+1F9B9}\N{U+1F3FF}"
+))))
+(#x1F477 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F477}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F477}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F477}\N{U+1F3FB}"
+"\N{U+1F477}\N{U+1F3FC}"
+"\N{U+1F477}\N{U+1F3FD}"
+"\N{U+1F477}\N{U+1F3FE}"
+"\N{U+1F477}\N{U+1F3FF}"
+))))
+(#x1F44B .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F44B}\N{U+1F3FB}"
+"\N{U+1F44B}\N{U+1F3FC}"
+"\N{U+1F44B}\N{U+1F3FD}"
+"\N{U+1F44B}\N{U+1F3FE}"
+"\N{U+1F44B}\N{U+1F3FF}"
+))))
+(#x1F9CE .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9CE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CE}\N{U+1F3FB}"
+"\N{U+1F9CE}\N{U+1F3FC}"
+"\N{U+1F9CE}\N{U+1F3FD}"
+"\N{U+1F9CE}\N{U+1F3FE}"
+"\N{U+1F9CE}\N{U+1F3FF}"
+))))
+(#x1F935 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F935}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F935}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F935}\N{U+1F3FB}"
+"\N{U+1F935}\N{U+1F3FC}"
+"\N{U+1F935}\N{U+1F3FD}"
+"\N{U+1F935}\N{U+1F3FE}"
+"\N{U+1F935}\N{U+1F3FF}"
+))))
+(#x1F3F4 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3F4}\N{U+200D}\N{U+2620}\N{U+FE0F}"
+"\N{U+1F3F4}\N{U+FE0F}"
+))))
+(#x1F9DA .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9DA}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DA}\N{U+1F3FB}"
+"\N{U+1F9DA}\N{U+1F3FC}"
+"\N{U+1F9DA}\N{U+1F3FD}"
+"\N{U+1F9DA}\N{U+1F3FE}"
+"\N{U+1F9DA}\N{U+1F3FF}"
+))))
+(#x1F6A3 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F6A3}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6A3}\N{U+1F3FB}"
+"\N{U+1F6A3}\N{U+1F3FC}"
+"\N{U+1F6A3}\N{U+1F3FD}"
+"\N{U+1F6A3}\N{U+1F3FE}"
+"\N{U+1F6A3}\N{U+1F3FF}"
+))))
+(#x1F590 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F590}\N{U+1F3FB}"
+"\N{U+1F590}\N{U+1F3FC}"
+"\N{U+1F590}\N{U+1F3FD}"
+"\N{U+1F590}\N{U+1F3FE}"
+"\N{U+1F590}\N{U+1F3FF}"
+"\N{U+1F590}\N{U+FE0F}"
+))))
+(#x1F47C .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F47C}\N{U+1F3FB}"
+"\N{U+1F47C}\N{U+1F3FC}"
+"\N{U+1F47C}\N{U+1F3FD}"
+"\N{U+1F47C}\N{U+1F3FE}"
+"\N{U+1F47C}\N{U+1F3FF}"
+))))
+(#x1F446 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F446}\N{U+1F3FB}"
+"\N{U+1F446}\N{U+1F3FC}"
+"\N{U+1F446}\N{U+1F3FD}"
+"\N{U+1F446}\N{U+1F3FE}"
+"\N{U+1F446}\N{U+1F3FF}"
+))))
+(#x1F3C4 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3C4}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C4}\N{U+1F3FB}"
+"\N{U+1F3C4}\N{U+1F3FC}"
+"\N{U+1F3C4}\N{U+1F3FD}"
+"\N{U+1F3C4}\N{U+1F3FE}"
+"\N{U+1F3C4}\N{U+1F3FF}"
+))))
+(#x1F926 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F926}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F926}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F926}\N{U+1F3FB}"
+"\N{U+1F926}\N{U+1F3FC}"
+"\N{U+1F926}\N{U+1F3FD}"
+"\N{U+1F926}\N{U+1F3FE}"
+"\N{U+1F926}\N{U+1F3FF}"
+))))
+(#x1F91B .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F91B}\N{U+1F3FB}"
+"\N{U+1F91B}\N{U+1F3FC}"
+"\N{U+1F91B}\N{U+1F3FD}"
+"\N{U+1F91B}\N{U+1F3FE}"
+"\N{U+1F91B}\N{U+1F3FF}"
+))))
+(#x1F46F .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F46F}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F46F}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+))))
+(#x1FAC3 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAC3}\N{U+1F3FB}"
+"\N{U+1FAC3}\N{U+1F3FC}"
+"\N{U+1FAC3}\N{U+1F3FD}"
+"\N{U+1FAC3}\N{U+1F3FE}"
+"\N{U+1FAC3}\N{U+1F3FF}"
+))))
+(#x1F472 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F472}\N{U+1F3FB}"
+"\N{U+1F472}\N{U+1F3FC}"
+"\N{U+1F472}\N{U+1F3FD}"
+"\N{U+1F472}\N{U+1F3FE}"
+"\N{U+1F472}\N{U+1F3FF}"
+))))
+(#x1F9CF .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9CF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CF}\N{U+1F3FB}"
+"\N{U+1F9CF}\N{U+1F3FC}"
+"\N{U+1F9CF}\N{U+1F3FD}"
+"\N{U+1F9CF}\N{U+1F3FE}"
+"\N{U+1F9CF}\N{U+1F3FF}"
+))))
+(#x1F936 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F936}\N{U+1F3FB}"
+"\N{U+1F936}\N{U+1F3FC}"
+"\N{U+1F936}\N{U+1F3FD}"
+"\N{U+1F936}\N{U+1F3FE}"
+"\N{U+1F936}\N{U+1F3FF}"
+))))
+(#x1F491 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F491}\N{U+1F3FB}"
+"\N{U+1F491}\N{U+1F3FC}"
+"\N{U+1F491}\N{U+1F3FD}"
+"\N{U+1F491}\N{U+1F3FE}"
+"\N{U+1F491}\N{U+1F3FF}"
+))))
+(#x1F3C3 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3C3}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3C3}\N{U+1F3FB}"
+"\N{U+1F3C3}\N{U+1F3FC}"
+"\N{U+1F3C3}\N{U+1F3FD}"
+"\N{U+1F3C3}\N{U+1F3FE}"
+"\N{U+1F3C3}\N{U+1F3FF}"
+))))
+(#x1F441 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F441}\N{U+FE0F}\N{U+200D}\N{U+1F5E8}\N{U+FE0F}"
+"\N{U+1F441}\N{U+FE0F}"
+))))
+(#x1FAF4 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAF4}\N{U+1F3FB}"
+"\N{U+1FAF4}\N{U+1F3FC}"
+"\N{U+1FAF4}\N{U+1F3FD}"
+"\N{U+1FAF4}\N{U+1F3FE}"
+"\N{U+1FAF4}\N{U+1F3FF}"
+))))
+(#x1F9D6 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D6}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D6}\N{U+1F3FB}"
+"\N{U+1F9D6}\N{U+1F3FC}"
+"\N{U+1F9D6}\N{U+1F3FD}"
+"\N{U+1F9D6}\N{U+1F3FE}"
+"\N{U+1F9D6}\N{U+1F3FF}"
+))))
+(#x1F487 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F487}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F487}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F487}\N{U+1F3FB}"
+"\N{U+1F487}\N{U+1F3FC}"
+"\N{U+1F487}\N{U+1F3FD}"
+"\N{U+1F487}\N{U+1F3FE}"
+"\N{U+1F487}\N{U+1F3FF}"
+))))
+(#x1F64D .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F64D}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64D}\N{U+1F3FB}"
+"\N{U+1F64D}\N{U+1F3FC}"
+"\N{U+1F64D}\N{U+1F3FD}"
+"\N{U+1F64D}\N{U+1F3FE}"
+"\N{U+1F64D}\N{U+1F3FF}"
+))))
+(#x1F468 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F468}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}"
+"\N{U+1F468}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}"
+"\N{U+1F468}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F466}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F467}"
+"\N{U+1F468}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F467}"
+"\N{U+1F468}\N{U+200D}\N{U+1F468}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F468}\N{U+200D}\N{U+1F466}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F468}\N{U+200D}\N{U+1F467}"
+"\N{U+1F468}\N{U+200D}\N{U+1F468}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F468}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F467}"
+"\N{U+1F468}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F466}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F467}"
+"\N{U+1F468}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F466}"
+"\N{U+1F468}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F467}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F468}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F468}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F468}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F468}\N{U+200D}\N{U+1F373}"
+"\N{U+1F468}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F468}\N{U+200D}\N{U+1F393}"
+"\N{U+1F468}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F468}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F468}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F468}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F468}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F468}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F468}\N{U+200D}\N{U+1F527}"
+"\N{U+1F468}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F468}\N{U+200D}\N{U+1F680}"
+"\N{U+1F468}\N{U+200D}\N{U+1F692}"
+"\N{U+1F468}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F468}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F468}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F373}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F393}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F527}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F680}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F692}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F373}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F393}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F527}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F680}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F692}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F373}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F393}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F527}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F680}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F692}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F373}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F393}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F527}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F680}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F692}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F373}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F393}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F527}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F680}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F692}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F468}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F468}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F468}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F468}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F468}\N{U+1F3FB}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F468}\N{U+1F3FC}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F468}\N{U+1F3FD}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F468}\N{U+1F3FE}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F468}\N{U+1F3FF}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F468}\N{U+1F3FF}"
+))))
+(#x1F939 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F939}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F939}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F939}\N{U+1F3FB}"
+"\N{U+1F939}\N{U+1F3FC}"
+"\N{U+1F939}\N{U+1F3FD}"
+"\N{U+1F939}\N{U+1F3FE}"
+"\N{U+1F939}\N{U+1F3FF}"
+))))
+(#x1F6B5 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F6B5}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B5}\N{U+1F3FB}"
+"\N{U+1F6B5}\N{U+1F3FC}"
+"\N{U+1F6B5}\N{U+1F3FD}"
+"\N{U+1F6B5}\N{U+1F3FE}"
+"\N{U+1F6B5}\N{U+1F3FF}"
+))))
+(#x1F46C .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F46C}\N{U+1F3FB}"
+"\N{U+1F46C}\N{U+1F3FC}"
+"\N{U+1F46C}\N{U+1F3FD}"
+"\N{U+1F46C}\N{U+1F3FE}"
+"\N{U+1F46C}\N{U+1F3FF}"
+))))
+(#x1F62E .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F62E}\N{U+200D}\N{U+1F4A8}"
+))))
+(#x1F9DE .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9DE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+))))
+(#x1F933 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F933}\N{U+1F3FB}"
+"\N{U+1F933}\N{U+1F3FC}"
+"\N{U+1F933}\N{U+1F3FD}"
+"\N{U+1F933}\N{U+1F3FE}"
+"\N{U+1F933}\N{U+1F3FF}"
+))))
+(#x1F645 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F645}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F645}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F645}\N{U+1F3FB}"
+"\N{U+1F645}\N{U+1F3FC}"
+"\N{U+1F645}\N{U+1F3FD}"
+"\N{U+1F645}\N{U+1F3FE}"
+"\N{U+1F645}\N{U+1F3FF}"
+))))
+(#x270C .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+270C}\N{U+1F3FB}"
+"\N{U+270C}\N{U+1F3FC}"
+"\N{U+270C}\N{U+1F3FD}"
+"\N{U+270C}\N{U+1F3FE}"
+"\N{U+270C}\N{U+1F3FF}"
+"\N{U+270C}\N{U+FE0F}"
+))))
+(#x1F90C .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F90C}\N{U+1F3FB}"
+"\N{U+1F90C}\N{U+1F3FC}"
+"\N{U+1F90C}\N{U+1F3FD}"
+"\N{U+1F90C}\N{U+1F3FE}"
+"\N{U+1F90C}\N{U+1F3FF}"
+))))
+(#x1F442 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F442}\N{U+1F3FB}"
+"\N{U+1F442}\N{U+1F3FC}"
+"\N{U+1F442}\N{U+1F3FD}"
+"\N{U+1F442}\N{U+1F3FE}"
+"\N{U+1F442}\N{U+1F3FF}"
+))))
+(#x1F93E .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F93E}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F93E}\N{U+1F3FB}"
+"\N{U+1F93E}\N{U+1F3FC}"
+"\N{U+1F93E}\N{U+1F3FD}"
+"\N{U+1F93E}\N{U+1F3FE}"
+"\N{U+1F93E}\N{U+1F3FF}"
+))))
+(#x1F64C .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F64C}\N{U+1F3FB}"
+"\N{U+1F64C}\N{U+1F3FC}"
+"\N{U+1F64C}\N{U+1F3FD}"
+"\N{U+1F64C}\N{U+1F3FE}"
+"\N{U+1F64C}\N{U+1F3FF}"
+))))
+(#x1F575 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F575}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F575}\N{U+FE0F}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F575}\N{U+FE0F}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F575}\N{U+1F3FB}"
+"\N{U+1F575}\N{U+1F3FC}"
+"\N{U+1F575}\N{U+1F3FD}"
+"\N{U+1F575}\N{U+1F3FE}"
+"\N{U+1F575}\N{U+1F3FF}"
+"\N{U+1F575}\N{U+FE0F}"
+))))
+(#x1FAF3 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAF3}\N{U+1F3FB}"
+"\N{U+1FAF3}\N{U+1F3FC}"
+"\N{U+1FAF3}\N{U+1F3FD}"
+"\N{U+1FAF3}\N{U+1F3FE}"
+"\N{U+1FAF3}\N{U+1F3FF}"
+))))
+(#x1F9D1 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D1}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F384}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F384}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F384}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F384}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F384}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F9D1}\N{U+1F3FF}"
+"\N{U+1F9D1}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F373}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F393}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F527}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F680}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F692}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F373}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F393}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F527}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F680}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F692}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F373}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F393}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F527}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F680}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F692}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F373}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F393}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F527}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F680}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F692}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F373}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F393}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F527}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F680}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F692}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F373}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F393}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F527}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F680}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F692}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F9D1}\N{U+1F3FB}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F9D1}\N{U+1F3FC}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F9D1}\N{U+1F3FD}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F9D1}\N{U+1F3FE}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F9D1}\N{U+1F3FF}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F9D1}\N{U+200D}\N{U+1F384}"
+"\N{U+1F9D1}\N{U+1F3FB}"
+"\N{U+1F9D1}\N{U+1F3FC}"
+"\N{U+1F9D1}\N{U+1F3FD}"
+"\N{U+1F9D1}\N{U+1F3FE}"
+"\N{U+1F9D1}\N{U+1F3FF}"
+))))
+(#x1F6CC .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F6CC}\N{U+1F3FB}"
+"\N{U+1F6CC}\N{U+1F3FC}"
+"\N{U+1F6CC}\N{U+1F3FD}"
+"\N{U+1F6CC}\N{U+1F3FE}"
+"\N{U+1F6CC}\N{U+1F3FF}"
+))))
+(#x1F9B8 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9B8}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9B8}\N{U+1F3FB}"
+"\N{U+1F9B8}\N{U+1F3FC}"
+"\N{U+1F9B8}\N{U+1F3FD}"
+"\N{U+1F9B8}\N{U+1F3FE}"
+"\N{U+1F9B8}\N{U+1F3FF}"
+))))
+(#x1F476 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F476}\N{U+1F3FB}"
+"\N{U+1F476}\N{U+1F3FC}"
+"\N{U+1F476}\N{U+1F3FD}"
+"\N{U+1F476}\N{U+1F3FE}"
+"\N{U+1F476}\N{U+1F3FF}"
+))))
+(#x1F44C .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F44C}\N{U+1F3FB}"
+"\N{U+1F44C}\N{U+1F3FC}"
+"\N{U+1F44C}\N{U+1F3FD}"
+"\N{U+1F44C}\N{U+1F3FE}"
+"\N{U+1F44C}\N{U+1F3FF}"
+))))
+(#x1F3CA .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3CA}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CA}\N{U+1F3FB}"
+"\N{U+1F3CA}\N{U+1F3FC}"
+"\N{U+1F3CA}\N{U+1F3FD}"
+"\N{U+1F3CA}\N{U+1F3FE}"
+"\N{U+1F3CA}\N{U+1F3FF}"
+))))
+(#x1F91D .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F91D}\N{U+1F3FB}"
+"\N{U+1F91D}\N{U+1F3FC}"
+"\N{U+1F91D}\N{U+1F3FD}"
+"\N{U+1F91D}\N{U+1F3FE}"
+"\N{U+1F91D}\N{U+1F3FF}"
+))))
+(#x1F6B6 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F6B6}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B6}\N{U+1F3FB}"
+"\N{U+1F6B6}\N{U+1F3FC}"
+"\N{U+1F6B6}\N{U+1F3FD}"
+"\N{U+1F6B6}\N{U+1F3FE}"
+"\N{U+1F6B6}\N{U+1F3FF}"
+))))
+(#x1F9B6 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9B6}\N{U+1F3FB}"
+"\N{U+1F9B6}\N{U+1F3FC}"
+"\N{U+1F9B6}\N{U+1F3FD}"
+"\N{U+1F9B6}\N{U+1F3FE}"
+"\N{U+1F9B6}\N{U+1F3FF}"
+))))
+(#x1F478 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F478}\N{U+1F3FB}"
+"\N{U+1F478}\N{U+1F3FC}"
+"\N{U+1F478}\N{U+1F3FD}"
+"\N{U+1F478}\N{U+1F3FE}"
+"\N{U+1F478}\N{U+1F3FF}"
+))))
+(#x1F466 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F466}\N{U+1F3FB}"
+"\N{U+1F466}\N{U+1F3FC}"
+"\N{U+1F466}\N{U+1F3FD}"
+"\N{U+1F466}\N{U+1F3FE}"
+"\N{U+1F466}\N{U+1F3FF}"
+))))
+(#x1F90F .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F90F}\N{U+1F3FB}"
+"\N{U+1F90F}\N{U+1F3FC}"
+"\N{U+1F90F}\N{U+1F3FD}"
+"\N{U+1F90F}\N{U+1F3FE}"
+"\N{U+1F90F}\N{U+1F3FF}"
+))))
+(#x1F447 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F447}\N{U+1F3FB}"
+"\N{U+1F447}\N{U+1F3FC}"
+"\N{U+1F447}\N{U+1F3FD}"
+"\N{U+1F447}\N{U+1F3FE}"
+"\N{U+1F447}\N{U+1F3FF}"
+))))
+(#x1F918 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F918}\N{U+1F3FB}"
+"\N{U+1F918}\N{U+1F3FC}"
+"\N{U+1F918}\N{U+1F3FD}"
+"\N{U+1F918}\N{U+1F3FE}"
+"\N{U+1F918}\N{U+1F3FF}"
+))))
+(#x26F9 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+26F9}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+26F9}\N{U+FE0F}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+26F9}\N{U+FE0F}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+26F9}\N{U+1F3FB}"
+"\N{U+26F9}\N{U+1F3FC}"
+"\N{U+26F9}\N{U+1F3FD}"
+"\N{U+26F9}\N{U+1F3FE}"
+"\N{U+26F9}\N{U+1F3FF}"
+"\N{U+26F9}\N{U+FE0F}"
+))))
+(#x1F91C .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F91C}\N{U+1F3FB}"
+"\N{U+1F91C}\N{U+1F3FC}"
+"\N{U+1F91C}\N{U+1F3FD}"
+"\N{U+1F91C}\N{U+1F3FE}"
+"\N{U+1F91C}\N{U+1F3FF}"
+))))
+(#x1F471 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F471}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F471}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F471}\N{U+1F3FB}"
+"\N{U+1F471}\N{U+1F3FC}"
+"\N{U+1F471}\N{U+1F3FD}"
+"\N{U+1F471}\N{U+1F3FE}"
+"\N{U+1F471}\N{U+1F3FF}"
+))))
+(#x1F44D .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F44D}\N{U+1F3FB}"
+"\N{U+1F44D}\N{U+1F3FC}"
+"\N{U+1F44D}\N{U+1F3FD}"
+"\N{U+1F44D}\N{U+1F3FE}"
+"\N{U+1F44D}\N{U+1F3FF}"
+))))
+(#x1F937 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F937}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F937}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F937}\N{U+1F3FB}"
+"\N{U+1F937}\N{U+1F3FC}"
+"\N{U+1F937}\N{U+1F3FD}"
+"\N{U+1F937}\N{U+1F3FE}"
+"\N{U+1F937}\N{U+1F3FF}"
+))))
+(#x1F9DC .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9DC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DC}\N{U+1F3FB}"
+"\N{U+1F9DC}\N{U+1F3FC}"
+"\N{U+1F9DC}\N{U+1F3FD}"
+"\N{U+1F9DC}\N{U+1F3FE}"
+"\N{U+1F9DC}\N{U+1F3FF}"
+))))
+(#x1F9B5 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9B5}\N{U+1F3FB}"
+"\N{U+1F9B5}\N{U+1F3FC}"
+"\N{U+1F9B5}\N{U+1F3FD}"
+"\N{U+1F9B5}\N{U+1F3FE}"
+"\N{U+1F9B5}\N{U+1F3FF}"
+))))
+(#x1F9D5 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D5}\N{U+1F3FB}"
+"\N{U+1F9D5}\N{U+1F3FC}"
+"\N{U+1F9D5}\N{U+1F3FD}"
+"\N{U+1F9D5}\N{U+1F3FE}"
+"\N{U+1F9D5}\N{U+1F3FF}"
+))))
+(#x1F448 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F448}\N{U+1F3FB}"
+"\N{U+1F448}\N{U+1F3FC}"
+"\N{U+1F448}\N{U+1F3FD}"
+"\N{U+1F448}\N{U+1F3FE}"
+"\N{U+1F448}\N{U+1F3FF}"
+))))
+(#x1F64E .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F64E}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F64E}\N{U+1F3FB}"
+"\N{U+1F64E}\N{U+1F3FC}"
+"\N{U+1F64E}\N{U+1F3FD}"
+"\N{U+1F64E}\N{U+1F3FE}"
+"\N{U+1F64E}\N{U+1F3FF}"
+))))
+(#x1F469 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F469}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}"
+"\N{U+1F469}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}"
+"\N{U+1F469}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}"
+"\N{U+1F469}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}"
+"\N{U+1F469}\N{U+200D}\N{U+1F466}"
+"\N{U+1F469}\N{U+200D}\N{U+1F466}\N{U+200D}\N{U+1F466}"
+"\N{U+1F469}\N{U+200D}\N{U+1F467}"
+"\N{U+1F469}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F466}"
+"\N{U+1F469}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F467}"
+"\N{U+1F469}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F466}"
+"\N{U+1F469}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F466}\N{U+200D}\N{U+1F466}"
+"\N{U+1F469}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F467}"
+"\N{U+1F469}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F466}"
+"\N{U+1F469}\N{U+200D}\N{U+1F469}\N{U+200D}\N{U+1F467}\N{U+200D}\N{U+1F467}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F468}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F48B}\N{U+200D}\N{U+1F469}\N{U+1F3FF}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F468}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F91D}\N{U+200D}\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F469}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F469}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F469}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F469}\N{U+200D}\N{U+1F373}"
+"\N{U+1F469}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F469}\N{U+200D}\N{U+1F393}"
+"\N{U+1F469}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F469}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F469}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F469}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F469}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F469}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F469}\N{U+200D}\N{U+1F527}"
+"\N{U+1F469}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F469}\N{U+200D}\N{U+1F680}"
+"\N{U+1F469}\N{U+200D}\N{U+1F692}"
+"\N{U+1F469}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F469}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F469}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F373}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F393}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F527}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F680}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F692}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F373}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F393}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F527}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F680}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F692}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F373}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F393}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F527}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F680}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F692}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F373}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F393}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F527}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F680}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F692}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2695}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2696}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+2708}\N{U+FE0F}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F33E}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F373}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F37C}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F393}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F3A4}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F3A8}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F3EB}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F3ED}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F4BB}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F4BC}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F527}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F52C}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F680}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F692}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F9AF}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F9BC}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F9BD}"
+"\N{U+1F469}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F469}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F469}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F469}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F469}\N{U+1F3FB}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F469}\N{U+1F3FC}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F469}\N{U+1F3FD}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F469}\N{U+1F3FE}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F9B0}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F9B1}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F9B2}"
+"\N{U+1F469}\N{U+1F3FF}\N{U+200D}\N{U+1F9B3}"
+"\N{U+1F469}\N{U+1F3FB}"
+"\N{U+1F469}\N{U+1F3FC}"
+"\N{U+1F469}\N{U+1F3FD}"
+"\N{U+1F469}\N{U+1F3FE}"
+"\N{U+1F469}\N{U+1F3FF}"
+))))
+(#x1F450 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F450}\N{U+1F3FB}"
+"\N{U+1F450}\N{U+1F3FC}"
+"\N{U+1F450}\N{U+1F3FD}"
+"\N{U+1F450}\N{U+1F3FE}"
+"\N{U+1F450}\N{U+1F3FF}"
+))))
+(#x1F93C .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F93C}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F93C}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+))))
+(#x1F46D .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F46D}\N{U+1F3FB}"
+"\N{U+1F46D}\N{U+1F3FC}"
+"\N{U+1F46D}\N{U+1F3FD}"
+"\N{U+1F46D}\N{U+1F3FE}"
+"\N{U+1F46D}\N{U+1F3FF}"
+))))
+(#x1F9DD .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9DD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DD}\N{U+1F3FB}"
+"\N{U+1F9DD}\N{U+1F3FC}"
+"\N{U+1F9DD}\N{U+1F3FD}"
+"\N{U+1F9DD}\N{U+1F3FE}"
+"\N{U+1F9DD}\N{U+1F3FF}"
+))))
+(#x1F930 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F930}\N{U+1F3FB}"
+"\N{U+1F930}\N{U+1F3FC}"
+"\N{U+1F930}\N{U+1F3FD}"
+"\N{U+1F930}\N{U+1F3FE}"
+"\N{U+1F930}\N{U+1F3FF}"
+))))
+(#x1F646 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F646}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F646}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F646}\N{U+1F3FB}"
+"\N{U+1F646}\N{U+1F3FC}"
+"\N{U+1F646}\N{U+1F3FD}"
+"\N{U+1F646}\N{U+1F3FE}"
+"\N{U+1F646}\N{U+1F3FF}"
+))))
+(#x1F408 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F408}\N{U+200D}\N{U+2B1B}"
+))))
+(#x1F595 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F595}\N{U+1F3FB}"
+"\N{U+1F595}\N{U+1F3FC}"
+"\N{U+1F595}\N{U+1F3FD}"
+"\N{U+1F595}\N{U+1F3FE}"
+"\N{U+1F595}\N{U+1F3FF}"
+))))
+(#x1F443 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F443}\N{U+1F3FB}"
+"\N{U+1F443}\N{U+1F3FC}"
+"\N{U+1F443}\N{U+1F3FD}"
+"\N{U+1F443}\N{U+1F3FE}"
+"\N{U+1F443}\N{U+1F3FF}"
+))))
+(#x1F385 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F385}\N{U+1F3FB}"
+"\N{U+1F385}\N{U+1F3FC}"
+"\N{U+1F385}\N{U+1F3FD}"
+"\N{U+1F385}\N{U+1F3FE}"
+"\N{U+1F385}\N{U+1F3FF}"
+))))
+(#x1F415 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F415}\N{U+200D}\N{U+1F9BA}"
+))))
+(#x1FAF2 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAF2}\N{U+1F3FB}"
+"\N{U+1FAF2}\N{U+1F3FC}"
+"\N{U+1FAF2}\N{U+1F3FD}"
+"\N{U+1FAF2}\N{U+1F3FE}"
+"\N{U+1FAF2}\N{U+1F3FF}"
+))))
+(#x1F481 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F481}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F481}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F481}\N{U+1F3FB}"
+"\N{U+1F481}\N{U+1F3FC}"
+"\N{U+1F481}\N{U+1F3FD}"
+"\N{U+1F481}\N{U+1F3FE}"
+"\N{U+1F481}\N{U+1F3FF}"
+))))
+(#x1FAC4 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAC4}\N{U+1F3FB}"
+"\N{U+1FAC4}\N{U+1F3FC}"
+"\N{U+1FAC4}\N{U+1F3FD}"
+"\N{U+1FAC4}\N{U+1F3FE}"
+"\N{U+1FAC4}\N{U+1F3FF}"
+))))
+(#x1F475 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F475}\N{U+1F3FB}"
+"\N{U+1F475}\N{U+1F3FC}"
+"\N{U+1F475}\N{U+1F3FD}"
+"\N{U+1F475}\N{U+1F3FE}"
+"\N{U+1F475}\N{U+1F3FF}"
+))))
+(#x1F3CB .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3CB}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+FE0F}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+FE0F}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CB}\N{U+1F3FB}"
+"\N{U+1F3CB}\N{U+1F3FC}"
+"\N{U+1F3CB}\N{U+1F3FD}"
+"\N{U+1F3CB}\N{U+1F3FE}"
+"\N{U+1F3CB}\N{U+1F3FF}"
+"\N{U+1F3CB}\N{U+FE0F}"
+))))
+(#x1F91E .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F91E}\N{U+1F3FB}"
+"\N{U+1F91E}\N{U+1F3FC}"
+"\N{U+1F91E}\N{U+1F3FD}"
+"\N{U+1F91E}\N{U+1F3FE}"
+"\N{U+1F91E}\N{U+1F3FF}"
+))))
+(#x1F48F .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F48F}\N{U+1F3FB}"
+"\N{U+1F48F}\N{U+1F3FC}"
+"\N{U+1F48F}\N{U+1F3FD}"
+"\N{U+1F48F}\N{U+1F3FE}"
+"\N{U+1F48F}\N{U+1F3FF}"
+))))
+(#x2764 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1F525}"
+"\N{U+2764}\N{U+FE0F}\N{U+200D}\N{U+1FA79}"
+"\N{U+2764}\N{U+FE0F}"
+))))
+(#x1F467 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F467}\N{U+1F3FB}"
+"\N{U+1F467}\N{U+1F3FC}"
+"\N{U+1F467}\N{U+1F3FD}"
+"\N{U+1F467}\N{U+1F3FE}"
+"\N{U+1F467}\N{U+1F3FF}"
+))))
+(#x1F9D9 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D9}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D9}\N{U+1F3FB}"
+"\N{U+1F9D9}\N{U+1F3FC}"
+"\N{U+1F9D9}\N{U+1F3FD}"
+"\N{U+1F9D9}\N{U+1F3FE}"
+"\N{U+1F9D9}\N{U+1F3FF}"
+))))
+(#x1F919 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F919}\N{U+1F3FB}"
+"\N{U+1F919}\N{U+1F3FC}"
+"\N{U+1F919}\N{U+1F3FD}"
+"\N{U+1F919}\N{U+1F3FE}"
+"\N{U+1F919}\N{U+1F3FF}"
+))))
+(#x1FAF1 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAF1}\N{U+1F3FB}\N{U+200D}\N{U+1FAF2}\N{U+1F3FC}"
+"\N{U+1FAF1}\N{U+1F3FB}\N{U+200D}\N{U+1FAF2}\N{U+1F3FD}"
+"\N{U+1FAF1}\N{U+1F3FB}\N{U+200D}\N{U+1FAF2}\N{U+1F3FE}"
+"\N{U+1FAF1}\N{U+1F3FB}\N{U+200D}\N{U+1FAF2}\N{U+1F3FF}"
+"\N{U+1FAF1}\N{U+1F3FC}\N{U+200D}\N{U+1FAF2}\N{U+1F3FB}"
+"\N{U+1FAF1}\N{U+1F3FC}\N{U+200D}\N{U+1FAF2}\N{U+1F3FD}"
+"\N{U+1FAF1}\N{U+1F3FC}\N{U+200D}\N{U+1FAF2}\N{U+1F3FE}"
+"\N{U+1FAF1}\N{U+1F3FC}\N{U+200D}\N{U+1FAF2}\N{U+1F3FF}"
+"\N{U+1FAF1}\N{U+1F3FD}\N{U+200D}\N{U+1FAF2}\N{U+1F3FB}"
+"\N{U+1FAF1}\N{U+1F3FD}\N{U+200D}\N{U+1FAF2}\N{U+1F3FC}"
+"\N{U+1FAF1}\N{U+1F3FD}\N{U+200D}\N{U+1FAF2}\N{U+1F3FE}"
+"\N{U+1FAF1}\N{U+1F3FD}\N{U+200D}\N{U+1FAF2}\N{U+1F3FF}"
+"\N{U+1FAF1}\N{U+1F3FE}\N{U+200D}\N{U+1FAF2}\N{U+1F3FB}"
+"\N{U+1FAF1}\N{U+1F3FE}\N{U+200D}\N{U+1FAF2}\N{U+1F3FC}"
+"\N{U+1FAF1}\N{U+1F3FE}\N{U+200D}\N{U+1FAF2}\N{U+1F3FD}"
+"\N{U+1FAF1}\N{U+1F3FE}\N{U+200D}\N{U+1FAF2}\N{U+1F3FF}"
+"\N{U+1FAF1}\N{U+1F3FF}\N{U+200D}\N{U+1FAF2}\N{U+1F3FB}"
+"\N{U+1FAF1}\N{U+1F3FF}\N{U+200D}\N{U+1FAF2}\N{U+1F3FC}"
+"\N{U+1FAF1}\N{U+1F3FF}\N{U+200D}\N{U+1FAF2}\N{U+1F3FD}"
+"\N{U+1FAF1}\N{U+1F3FF}\N{U+200D}\N{U+1FAF2}\N{U+1F3FE}"
+"\N{U+1FAF1}\N{U+1F3FB}"
+"\N{U+1FAF1}\N{U+1F3FC}"
+"\N{U+1FAF1}\N{U+1F3FD}"
+"\N{U+1FAF1}\N{U+1F3FE}"
+"\N{U+1FAF1}\N{U+1F3FF}"
+))))
+(#x1F9D3 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D3}\N{U+1F3FB}"
+"\N{U+1F9D3}\N{U+1F3FC}"
+"\N{U+1F9D3}\N{U+1F3FD}"
+"\N{U+1F9D3}\N{U+1F3FE}"
+"\N{U+1F9D3}\N{U+1F3FF}"
+))))
+(#x1F482 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F482}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F482}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F482}\N{U+1F3FB}"
+"\N{U+1F482}\N{U+1F3FC}"
+"\N{U+1F482}\N{U+1F3FD}"
+"\N{U+1F482}\N{U+1F3FE}"
+"\N{U+1F482}\N{U+1F3FF}"
+))))
+(#x1F470 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F470}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F470}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F470}\N{U+1F3FB}"
+"\N{U+1F470}\N{U+1F3FC}"
+"\N{U+1F470}\N{U+1F3FD}"
+"\N{U+1F470}\N{U+1F3FE}"
+"\N{U+1F470}\N{U+1F3FF}"
+))))
+(#x1F44E .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F44E}\N{U+1F3FB}"
+"\N{U+1F44E}\N{U+1F3FC}"
+"\N{U+1F44E}\N{U+1F3FD}"
+"\N{U+1F44E}\N{U+1F3FE}"
+"\N{U+1F44E}\N{U+1F3FF}"
+))))
+(#x1F9CD .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9CD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9CD}\N{U+1F3FB}"
+"\N{U+1F9CD}\N{U+1F3FC}"
+"\N{U+1F9CD}\N{U+1F3FD}"
+"\N{U+1F9CD}\N{U+1F3FE}"
+"\N{U+1F9CD}\N{U+1F3FF}"
+))))
+(#x1F934 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F934}\N{U+1F3FB}"
+"\N{U+1F934}\N{U+1F3FC}"
+"\N{U+1F934}\N{U+1F3FD}"
+"\N{U+1F934}\N{U+1F3FE}"
+"\N{U+1F934}\N{U+1F3FF}"
+))))
+(#x270D .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+270D}\N{U+1F3FB}"
+"\N{U+270D}\N{U+1F3FC}"
+"\N{U+270D}\N{U+1F3FD}"
+"\N{U+270D}\N{U+1F3FE}"
+"\N{U+270D}\N{U+1F3FF}"
+"\N{U+270D}\N{U+FE0F}"
+))))
+(#x1F9DB .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9DB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9DB}\N{U+1F3FB}"
+"\N{U+1F9DB}\N{U+1F3FC}"
+"\N{U+1F9DB}\N{U+1F3FD}"
+"\N{U+1F9DB}\N{U+1F3FE}"
+"\N{U+1F9DB}\N{U+1F3FF}"
+))))
+(#x1F6C0 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F6C0}\N{U+1F3FB}"
+"\N{U+1F6C0}\N{U+1F3FC}"
+"\N{U+1F6C0}\N{U+1F3FD}"
+"\N{U+1F6C0}\N{U+1F3FE}"
+"\N{U+1F6C0}\N{U+1F3FF}"
+))))
+(#x1F4AA .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F4AA}\N{U+1F3FB}"
+"\N{U+1F4AA}\N{U+1F3FC}"
+"\N{U+1F4AA}\N{U+1F3FD}"
+"\N{U+1F4AA}\N{U+1F3FE}"
+"\N{U+1F4AA}\N{U+1F3FF}"
+))))
+(#x261D .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+261D}\N{U+1F3FB}"
+"\N{U+261D}\N{U+1F3FC}"
+"\N{U+261D}\N{U+1F3FD}"
+"\N{U+261D}\N{U+1F3FE}"
+"\N{U+261D}\N{U+1F3FF}"
+"\N{U+261D}\N{U+FE0F}"
+))))
+(#x1FAF6 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAF6}\N{U+1F3FB}"
+"\N{U+1FAF6}\N{U+1F3FC}"
+"\N{U+1FAF6}\N{U+1F3FD}"
+"\N{U+1FAF6}\N{U+1F3FE}"
+"\N{U+1FAF6}\N{U+1F3FF}"
+))))
+(#x1F9D4 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D4}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D4}\N{U+1F3FB}"
+"\N{U+1F9D4}\N{U+1F3FC}"
+"\N{U+1F9D4}\N{U+1F3FD}"
+"\N{U+1F9D4}\N{U+1F3FE}"
+"\N{U+1F9D4}\N{U+1F3FF}"
+))))
+(#x1F9BB .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9BB}\N{U+1F3FB}"
+"\N{U+1F9BB}\N{U+1F3FC}"
+"\N{U+1F9BB}\N{U+1F3FD}"
+"\N{U+1F9BB}\N{U+1F3FE}"
+"\N{U+1F9BB}\N{U+1F3FF}"
+))))
+(#x1F485 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F485}\N{U+1F3FB}"
+"\N{U+1F485}\N{U+1F3FC}"
+"\N{U+1F485}\N{U+1F3FD}"
+"\N{U+1F485}\N{U+1F3FE}"
+"\N{U+1F485}\N{U+1F3FF}"
+))))
+(#x1F449 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F449}\N{U+1F3FB}"
+"\N{U+1F449}\N{U+1F3FC}"
+"\N{U+1F449}\N{U+1F3FD}"
+"\N{U+1F449}\N{U+1F3FE}"
+"\N{U+1F449}\N{U+1F3FF}"
+))))
+(#x1F636 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F636}\N{U+200D}\N{U+1F32B}\N{U+FE0F}"
+))))
+(#x1F64F .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F64F}\N{U+1F3FB}"
+"\N{U+1F64F}\N{U+1F3FC}"
+"\N{U+1F64F}\N{U+1F3FD}"
+"\N{U+1F64F}\N{U+1F3FE}"
+"\N{U+1F64F}\N{U+1F3FF}"
+))))
+(#x1F91A .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F91A}\N{U+1F3FB}"
+"\N{U+1F91A}\N{U+1F3FC}"
+"\N{U+1F91A}\N{U+1F3FD}"
+"\N{U+1F91A}\N{U+1F3FE}"
+"\N{U+1F91A}\N{U+1F3FF}"
+))))
+(#x1F46E .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F46E}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F46E}\N{U+1F3FB}"
+"\N{U+1F46E}\N{U+1F3FC}"
+"\N{U+1F46E}\N{U+1F3FD}"
+"\N{U+1F46E}\N{U+1F3FE}"
+"\N{U+1F46E}\N{U+1F3FF}"
+))))
+(#x1F473 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F473}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F473}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F473}\N{U+1F3FB}"
+"\N{U+1F473}\N{U+1F3FC}"
+"\N{U+1F473}\N{U+1F3FD}"
+"\N{U+1F473}\N{U+1F3FE}"
+"\N{U+1F473}\N{U+1F3FF}"
+))))
+(#x1F44F .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F44F}\N{U+1F3FB}"
+"\N{U+1F44F}\N{U+1F3FC}"
+"\N{U+1F44F}\N{U+1F3FD}"
+"\N{U+1F44F}\N{U+1F3FE}"
+"\N{U+1F44F}\N{U+1F3FF}"
+))))
+(#x1F931 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F931}\N{U+1F3FB}"
+"\N{U+1F931}\N{U+1F3FC}"
+"\N{U+1F931}\N{U+1F3FD}"
+"\N{U+1F931}\N{U+1F3FE}"
+"\N{U+1F931}\N{U+1F3FF}"
+))))
+(#x1F647 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F647}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F647}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F647}\N{U+1F3FB}"
+"\N{U+1F647}\N{U+1F3FC}"
+"\N{U+1F647}\N{U+1F3FD}"
+"\N{U+1F647}\N{U+1F3FE}"
+"\N{U+1F647}\N{U+1F3FF}"
+))))
+(#x1F57A .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F57A}\N{U+1F3FB}"
+"\N{U+1F57A}\N{U+1F3FC}"
+"\N{U+1F57A}\N{U+1F3FD}"
+"\N{U+1F57A}\N{U+1F3FE}"
+"\N{U+1F57A}\N{U+1F3FF}"
+))))
+(#x270A .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+270A}\N{U+1F3FB}"
+"\N{U+270A}\N{U+1F3FC}"
+"\N{U+270A}\N{U+1F3FD}"
+"\N{U+270A}\N{U+1F3FE}"
+"\N{U+270A}\N{U+1F3FF}"
+))))
+(#x1F596 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F596}\N{U+1F3FB}"
+"\N{U+1F596}\N{U+1F3FC}"
+"\N{U+1F596}\N{U+1F3FD}"
+"\N{U+1F596}\N{U+1F3FE}"
+"\N{U+1F596}\N{U+1F3FF}"
+))))
+(#x1F3C2 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3C2}\N{U+1F3FB}"
+"\N{U+1F3C2}\N{U+1F3FC}"
+"\N{U+1F3C2}\N{U+1F3FD}"
+"\N{U+1F3C2}\N{U+1F3FE}"
+"\N{U+1F3C2}\N{U+1F3FF}"
+))))
+(#x1FAF5 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAF5}\N{U+1F3FB}"
+"\N{U+1FAF5}\N{U+1F3FC}"
+"\N{U+1FAF5}\N{U+1F3FD}"
+"\N{U+1FAF5}\N{U+1F3FE}"
+"\N{U+1FAF5}\N{U+1F3FF}"
+))))
+(#x1F9D7 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9D7}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F9D7}\N{U+1F3FB}"
+"\N{U+1F9D7}\N{U+1F3FC}"
+"\N{U+1F9D7}\N{U+1F3FD}"
+"\N{U+1F9D7}\N{U+1F3FE}"
+"\N{U+1F9D7}\N{U+1F3FF}"
+))))
+(#x1F486 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F486}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F486}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F486}\N{U+1F3FB}"
+"\N{U+1F486}\N{U+1F3FC}"
+"\N{U+1F486}\N{U+1F3FD}"
+"\N{U+1F486}\N{U+1F3FE}"
+"\N{U+1F486}\N{U+1F3FF}"
+))))
+(#x1F635 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F635}\N{U+200D}\N{U+1F4AB}"
+))))
+(#x1FAC5 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1FAC5}\N{U+1F3FB}"
+"\N{U+1FAC5}\N{U+1F3FC}"
+"\N{U+1FAC5}\N{U+1F3FD}"
+"\N{U+1FAC5}\N{U+1F3FE}"
+"\N{U+1FAC5}\N{U+1F3FF}"
+))))
+(#x1F474 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F474}\N{U+1F3FB}"
+"\N{U+1F474}\N{U+1F3FC}"
+"\N{U+1F474}\N{U+1F3FD}"
+"\N{U+1F474}\N{U+1F3FE}"
+"\N{U+1F474}\N{U+1F3FF}"
+))))
+(#x1F44A .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F44A}\N{U+1F3FB}"
+"\N{U+1F44A}\N{U+1F3FC}"
+"\N{U+1F44A}\N{U+1F3FD}"
+"\N{U+1F44A}\N{U+1F3FE}"
+"\N{U+1F44A}\N{U+1F3FF}"
+))))
+(#x1F3CC .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F3CC}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+FE0F}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+FE0F}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F3CC}\N{U+1F3FB}"
+"\N{U+1F3CC}\N{U+1F3FC}"
+"\N{U+1F3CC}\N{U+1F3FD}"
+"\N{U+1F3CC}\N{U+1F3FE}"
+"\N{U+1F3CC}\N{U+1F3FF}"
+"\N{U+1F3CC}\N{U+FE0F}"
+))))
+(#x1F938 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F938}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F938}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F938}\N{U+1F3FB}"
+"\N{U+1F938}\N{U+1F3FC}"
+"\N{U+1F938}\N{U+1F3FD}"
+"\N{U+1F938}\N{U+1F3FE}"
+"\N{U+1F938}\N{U+1F3FF}"
+))))
+(#x1F91F .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F91F}\N{U+1F3FB}"
+"\N{U+1F91F}\N{U+1F3FC}"
+"\N{U+1F91F}\N{U+1F3FD}"
+"\N{U+1F91F}\N{U+1F3FE}"
+"\N{U+1F91F}\N{U+1F3FF}"
+))))
+(#x1F6B4 .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F6B4}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FB}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FB}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FC}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FC}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FD}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FD}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FE}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FE}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+"\N{U+1F6B4}\N{U+1F3FB}"
+"\N{U+1F6B4}\N{U+1F3FC}"
+"\N{U+1F6B4}\N{U+1F3FD}"
+"\N{U+1F6B4}\N{U+1F3FE}"
+"\N{U+1F6B4}\N{U+1F3FF}"
+))))
+(#x1F46B .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F46B}\N{U+1F3FB}"
+"\N{U+1F46B}\N{U+1F3FC}"
+"\N{U+1F46B}\N{U+1F3FD}"
+"\N{U+1F46B}\N{U+1F3FE}"
+"\N{U+1F46B}\N{U+1F3FF}"
+))))
+(#x1F43B .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F43B}\N{U+200D}\N{U+2744}\N{U+FE0F}"
+))))
+(#x1F9DF .
+,(eval-when-compile (regexp-opt
+'(
+"\N{U+1F9DF}\N{U+200D}\N{U+2640}\N{U+FE0F}"
+"\N{U+1F9DF}\N{U+200D}\N{U+2642}\N{U+FE0F}"
+))))
+))
+  (set-char-table-range composition-function-table
+                        (car elt)
+                        (nconc (char-table-range composition-function-table (car elt))
+                               (list (vector (cdr elt)
+                                             0
+                                             #'compose-gstring-for-graphic)))))
+;; The following two blocks are derived by hand from emoji-sequences.txt
+;; FIXME: add support for Emoji_Keycap_Sequence once we learn how to respect FE0F/VS-16
+;; for ASCII characters.
+;; Flags
+(set-char-table-range composition-function-table
+                      '(#x1F1E6 . #x1F1FF)
+                      (nconc (char-table-range composition-function-table '(#x1F1E6 . #x1F1FF))
+                             (list (vector "[\U0001F1E6-\U0001F1FF][\U0001F1E6-\U0001F1FF]"
+                                           0
+                                           #'compose-gstring-for-graphic))))
+;; UK Flags
+(set-char-table-range composition-function-table
+                      #x1F3F4
+                      (nconc (char-table-range composition-function-table #x1F3F4)
+                             (list (vector "\U0001F3F4\U000E0067\U000E0062\\(?:\U000E0065\U000E006E\U000E0067\\|\U000E0073\U000E0063\U000E0074\\|\U000E0077\U000E006C\U000E0073\\)\U000E007F"
+                                           0
+                                           #'compose-gstring-for-graphic))))
+
+(provide 'emoji-zwj)
\ No newline at end of file
@@ -100,6 +100,30 @@ jit-lock-stealth-verbose
   :type 'boolean)
 
 
+(defcustom jit-lock-stealth-lookahead 2
+  "How many windowfuls of text stealth fontification fontifies first.
+Before fontifying the rest of the buffers, stealth fontification
+fontifies this many windowfuls of text after the end of each window
+showing a buffer in JIT Lock mode, and as many before its start,
+nearest to the window first, so that scrolling shows text that is
+already fontified.  If nil or 0, it does not favor that text.
+See also `jit-lock-stealth-lookahead-budget'."
+  :type '(choice (const :tag "none" nil)
+		 (natnum :tag "windowfuls"))
+  :version "29.1")
+
+
+(defcustom jit-lock-stealth-lookahead-budget 0.05
+  "Time in seconds that fontifying the text around windows may take at once.
+Stealth fontification fontifies the text given by
+`jit-lock-stealth-lookahead' a chunk at a time, and after each chunk
+it checks whether it has taken this long.  If so, it pauses like it
+does between chunks of the rest of the text; see
+`jit-lock-stealth-nice'."
+  :type 'number
+  :version "29.1")
+
+
 (defvaralias 'jit-lock-defer-contextually 'jit-lock-contextually)
 (defcustom jit-lock-contextually 'syntax-driven
   "If non-nil, fontification should be syntactically true.
@@ -205,7 +229,10 @@ jit-lock-mode
 - Stealthy buffer fontification if `jit-lock-stealth-time' is non-nil.
   This means remaining unfontified areas of buffers are fontified if Emacs has
   been idle for `jit-lock-stealth-time' seconds, while Emacs remains idle.
-  This is useful if any buffer has any deferred fontification.
+  This is useful if any buffer has any deferred fontification.  The text
+  around the windows, as given by `jit-lock-stealth-lookahead', is
+  fontified first, so that scrolling shows text that is already
+  fontified.
 
 - Deferred context fontification if `jit-lock-contextually' is
   non-nil.  This means fontification updates the buffer corresponding to
@@ -580,31 +607,112 @@ jit-lock-stealth-fontify
 	       (> (or (car (load-average)) 0) jit-lock-stealth-load))
 	  ;; Wait a little if load is too high.
 	  (setq delay jit-lock-stealth-time)
-	(if (buffer-live-p buffer)
-	    (with-current-buffer buffer
-	      (if (and jit-lock-mode
-		       (setq start (jit-lock-stealth-chunk-start (point))))
-		  ;; Fontify one block of at most `jit-lock-chunk-size'
-		  ;; characters.
-		  (with-temp-message (if jit-lock-stealth-verbose
-					 (concat "JIT stealth lock "
-						 (buffer-name)))
-		    (jit-lock-fontify-now start
-					  (+ start jit-lock-chunk-size))
-		    ;; Run again after `jit-lock-stealth-nice' seconds.
-		    (setq delay (or jit-lock-stealth-nice 0)))
-		;; Nothing to fontify here.  Remove this buffer from
-		;; `jit-lock-stealth-buffers' and run again immediately.
-		(setq jit-lock-stealth-buffers (cdr jit-lock-stealth-buffers))))
+	(cond
+	 ((jit-lock--stealth-lookahead)
+	  ;; Fontified some of the text around the windows.  Run again
+	  ;; after `jit-lock-stealth-nice' seconds.
+	  (setq delay (or jit-lock-stealth-nice 0)))
+	 ((buffer-live-p buffer)
+	  (with-current-buffer buffer
+	    (if (and jit-lock-mode
+		     (setq start (jit-lock-stealth-chunk-start (point))))
+		;; Fontify one block of at most `jit-lock-chunk-size'
+		;; characters.
+		(with-temp-message (if jit-lock-stealth-verbose
+				       (concat "JIT stealth lock "
+					       (buffer-name)))
+		  (jit-lock-fontify-now start
+					(+ start jit-lock-chunk-size))
+		  ;; Run again after `jit-lock-stealth-nice' seconds.
+		  (setq delay (or jit-lock-stealth-nice 0)))
+	      ;; Nothing to fontify here.  Remove this buffer from
+	      ;; `jit-lock-stealth-buffers' and run again immediately.
+	      (setq jit-lock-stealth-buffers (cdr jit-lock-stealth-buffers)))))
+	 (t
 	  ;; Buffer is no longer live.  Remove it from
 	  ;; `jit-lock-stealth-buffers' and run again immediately.
-	  (setq jit-lock-stealth-buffers (cdr jit-lock-stealth-buffers))))
+	  (setq jit-lock-stealth-buffers (cdr jit-lock-stealth-buffers)))))
       ;; Call us again.
       (when jit-lock-stealth-buffers
 	(timer-set-idle-time jit-lock-stealth-repeat-timer (current-idle-time))
 	(timer-inc-time jit-lock-stealth-repeat-timer delay)
 	(timer-activate-when-idle jit-lock-stealth-repeat-timer t)))))
 
+(defun jit-lock--lookahead-regions ()
+  "Return the regions of text that stealth fontification fontifies first.
+Value is a list of elements (BUFFER START END AROUND), one for the
+text after each window showing a buffer in JIT Lock mode and one for
+the text before it, where AROUND is the edge of the window that the
+region START..END adjoins.  See `jit-lock-stealth-lookahead'."
+  (let (regions)
+    (walk-windows
+     (lambda (window)
+       (let ((buffer (window-buffer window)))
+         (when (buffer-local-value 'jit-lock-mode buffer)
+           (let* ((start (window-start window))
+                  (end (window-end window))
+                  (size (* jit-lock-stealth-lookahead
+                           (max (- end start) jit-lock-chunk-size))))
+             (push (list buffer end (+ end size) end) regions)
+             (push (list buffer (- start size) start start) regions)))))
+     'nomini 'visible)
+    (nreverse regions)))
+
+(defun jit-lock--lookahead-chunk (region)
+  "Return the unfontified chunk of REGION nearest to its window.
+REGION is an element of the value of `jit-lock--lookahead-regions'.
+Value is (DISTANCE START . END), where DISTANCE is the number of
+characters between the chunk START..END and the window, or nil if
+all of REGION is already fontified."
+  (pcase-let ((`(,buffer ,beg ,end ,around) region))
+    (when (buffer-live-p buffer)
+      (with-current-buffer buffer
+        (if (= around beg)
+            ;; The region follows the window.
+            (let* ((end (min end (point-max)))
+                   (start (and (< beg end)
+                               (text-property-not-all beg end
+                                                      'fontified t))))
+              (when start
+                (cons (- start around)
+                      (cons start (min end (+ start jit-lock-chunk-size))))))
+          ;; The region precedes the window.
+          (let ((beg (max beg (point-min)))
+                (pos (min end (point-max))))
+            (while (and (> pos beg)
+                        (eq (get-text-property (1- pos) 'fontified) t))
+              (setq pos (previous-single-property-change
+                         pos 'fontified nil beg)))
+            (when (> pos beg)
+              (cons (- around pos)
+                    (cons (max beg (- pos jit-lock-chunk-size)) pos)))))))))
+
+(defun jit-lock--stealth-lookahead ()
+  "Fontify some of the text around the windows, nearest to them first.
+Fontify the text given by `jit-lock-stealth-lookahead' a chunk at a
+time, the chunk nearest to its window first, until
+`jit-lock-stealth-lookahead-budget' seconds have passed or input is
+pending.  Return nil if there was nothing left to fontify."
+  (when (and jit-lock-stealth-lookahead
+             (> jit-lock-stealth-lookahead 0))
+    (let ((deadline (time-add nil jit-lock-stealth-lookahead-budget))
+          (regions (jit-lock--lookahead-regions))
+          fontified)
+      (while (let (nearest buffer)
+               (dolist (region regions)
+                 (let ((chunk (jit-lock--lookahead-chunk region)))
+                   (when (and chunk (or (null nearest)
+                                        (< (car chunk) (car nearest))))
+                     (setq nearest chunk
+                           buffer (car region)))))
+               (when nearest
+                 (with-current-buffer buffer
+                   (jit-lock-fontify-now (cadr nearest) (cddr nearest)))
+                 (setq fontified t)
+                 (and (time-less-p nil deadline)
+                      (not (input-pending-p))))))
+      fontified)))
+
 
 ;;; Deferred fontification.
 
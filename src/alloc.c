@@ -115,6 +115,7 @@ Copyright (C) 1985-1986, 1988, 1993-1995, 1997-2022 Free Software
   struct Lisp_Bignum Lisp_Bignum;
   struct Lisp_Bool_Vector Lisp_Bool_Vector;
   struct Lisp_Char_Table Lisp_Char_Table;
+  struct Lisp_Completion_Index Lisp_Completion_Index;
   struct Lisp_CondVar Lisp_CondVar;
   struct Lisp_Finalizer Lisp_Finalizer;
   struct Lisp_Float Lisp_Float;
@@ -3168,6 +3169,8 @@ cleanup_vector (struct Lisp_Vector *vector)
       if (uptr->finalizer)
 	uptr->finalizer (uptr->p);
     }
+  else if (PSEUDOVECTOR_TYPEP (&vector->header, PVEC_COMPLETION_INDEX))
+    xfree (PSEUDOVEC_STRUCT (vector, Lisp_Completion_Index)->nodes);
 #ifdef HAVE_MODULES
   else if (PSEUDOVECTOR_TYPEP (&vector->header, PVEC_MODULE_FUNCTION))
     {
@@ -3725,6 +3728,7 @@ DEFUN ("make-marker", Fmake_marker, Smake_marker, 0, 0, 0,
   p->bytepos = 0;
   p->charpos = 0;
   p->next = NULL;
+  p->chunk = NULL;
   p->insertion_type = 0;
   p->need_adjustment = 0;
   return make_lisp_ptr (p, Lisp_Vectorlike);
@@ -3744,13 +3748,13 @@ build_marker (struct buffer *buf, ptrdiff_t charpos, ptrdiff_t bytepos)
 
   struct Lisp_Marker *m = ALLOCATE_PLAIN_PSEUDOVECTOR (struct Lisp_Marker,
 						       PVEC_MARKER);
-  m->buffer = buf;
+  m->buffer = NULL;
   m->charpos = charpos;
   m->bytepos = bytepos;
   m->insertion_type = 0;
   m->need_adjustment = 0;
-  m->next = BUF_MARKERS (buf);
-  BUF_MARKERS (buf) = m;
+  m->chunk = NULL;
+  chain_marker (m, buf);
   return make_lisp_ptr (m, Lisp_Vectorlike);
 }
 
@@ -5875,18 +5879,26 @@ #define compact_font_caches() (void)(0)
 #endif /* HAVE_WINDOW_SYSTEM */
 
 /* Remove (MARKER . DATA) entries with unmarked MARKER
-   from buffer undo LIST and return changed list.  */
+   from the undo list of buffer B and return changed list.  */
 
 static Lisp_Object
-compact_undo_list (Lisp_Object list)
+compact_undo_list (struct buffer *b)
 {
+  Lisp_Object list = BVAR (b, undo_list);
   Lisp_Object tail, *prev = &list;
 
   for (tail = list; CONSP (tail); tail = XCDR (tail))
     {
-      if (CONSP (XCAR (tail))
-	  && MARKERP (XCAR (XCAR (tail)))
-	  && !vectorlike_marked_p (&XMARKER (XCAR (XCAR (tail)))->header))
+      /* Skip the records that truncate_undo_list found to have no
+	 marker adjustments.  */
+      if (EQ (tail, b->undo_scan_start) && !b->undo_scan_markers)
+	{
+	  tail = b->undo_scan_end;
+	  prev = xcdr_addr (tail);
+	}
+      else if (CONSP (XCAR (tail))
+	       && MARKERP (XCAR (XCAR (tail)))
+	       && !vectorlike_marked_p (&XMARKER (XCAR (XCAR (tail)))->header))
 	*prev = XCDR (tail);
       else
 	prev = xcdr_addr (tail);
@@ -6223,10 +6235,14 @@ garbage_collect (void)
     {
       struct buffer *nextb = XBUFFER (buffer);
       if (!EQ (BVAR (nextb, undo_list), Qt))
-	bset_undo_list (nextb, compact_undo_list (BVAR (nextb, undo_list)));
+	bset_undo_list (nextb, compact_undo_list (nextb));
       /* Now that we have stripped the elements that need not be
 	 in the undo_list any more, we can finally mark the list.  */
       mark_object (BVAR (nextb, undo_list));
+      /* Forget what truncate_undo_list scanned if it is garbage.  */
+      if (!survives_gc_p (nextb->undo_scan_start)
+	  || !survives_gc_p (nextb->undo_scan_end))
+	nextb->undo_scan_start = nextb->undo_scan_end = Qnil;
     }
 
   /* Now pre-sweep finalizers.  Here, we add any unmarked finalizers
@@ -6245,8 +6261,13 @@ garbage_collect (void)
 
   eassert (mark_stack_empty_p ());
 
+  sweep_char_table_modiffs ();
+
   gc_sweep ();
 
+  /* Char-tables and their values may have been freed.  */
+  clear_char_table_cache ();
+
   unmark_main_thread ();
 
   gc_in_progress = 0;
@@ -6521,6 +6542,12 @@ mark_buffer (struct buffer *buffer)
   /* ...but there are some buffer-specific things.  */
 
   mark_interval_tree (buffer_intervals (buffer));
+  if (!buffer->base_buffer)
+    {
+      mark_parse_state_cache (buffer);
+      mark_column_cache (buffer);
+      mark_bidi_dir_cache (buffer);
+    }
 
   /* For now, we just don't mark the undo_list.  It's done later in
      a special way just before the sweep phase, and after stripping
@@ -6560,6 +6587,10 @@ mark_face_cache (struct face_cache *c)
 	      mark_objects (face->lface, LFACE_VECTOR_SIZE);
 	    }
 	}
+
+      if (c->merge_memo)
+	for (int i = 0; i < FACE_MERGE_MEMO_SIZE; i++)
+	  mark_object (c->merge_memo[i].refs);
     }
 }
 
@@ -7371,6 +7402,8 @@ unchain_dead_markers (struct buffer *buffer)
       prev = &this->next;
     else
       {
+        if (this->chunk)
+          unindex_marker (this);
         this->buffer = NULL;
         *prev = this->next;
       }
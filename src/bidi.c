@@ -244,6 +244,7 @@ Copyright (C) 2000-2001, 2004-2005, 2009-2022 Free Software Foundation,
 #include "character.h"
 #include "buffer.h"
 #include "dispextern.h"
+#include "window.h"
 #include "region-cache.h"
 #include "sysstdio.h"
 
@@ -1668,6 +1669,148 @@ find_first_strong_char (ptrdiff_t pos, ptrdiff_t bytepos, ptrdiff_t end,
   return type;
 }
 
+/* Number of paragraphs whose base direction a buffer remembers.  */
+#define BIDI_DIR_CACHE_SIZE 16
+
+struct bidi_dir_cache_entry
+{
+  /* Where the paragraph starts, and the position just after its first
+     strong character.  */
+  ptrdiff_t start, start_byte, strong_end;
+
+  /* The sequence number of the window whose display strings
+     find_first_strong_char saw, or zero if none, times 2, plus 1 if
+     the window is on a window-system frame.  */
+  EMACS_INT window;
+
+  /* The direction the first strong character gave the paragraph.  */
+  bidi_dir_t dir;
+};
+
+/* The base directions of the paragraphs of a buffer, so that
+   redisplay need not search each paragraph for its first strong
+   character every time it displays the paragraph.  Paragraph
+   boundaries themselves are remembered in bidi_paragraph_cache.  */
+struct bidi_dir_cache
+{
+  /* The buffer the directions are for, which differs from the one
+     holding the cache if it is indirect, and the regexps that found
+     the paragraph ends.  */
+  Lisp_Object buffer, start_re, separate_re;
+
+  /* The entries in use, and the next one to replace.  */
+  int count, next;
+  struct bidi_dir_cache_entry entries[BIDI_DIR_CACHE_SIZE];
+};
+
+/* Return the paragraph direction cache of the current buffer, emptying
+   it if it was for something else.  Return NULL if the buffer does not
+   cache long scans.  */
+static struct bidi_dir_cache *
+bidi_dir_cache_for_current_buffer (void)
+{
+  struct buffer *b = current_buffer;
+  struct buffer *cache_buffer = b->base_buffer ? b->base_buffer : b;
+  struct bidi_dir_cache *cache = cache_buffer->bidi_dir_cache;
+  Lisp_Object buffer;
+
+  if (NILP (BVAR (b, cache_long_scans)))
+    return NULL;
+
+  XSETBUFFER (buffer, b);
+  if (!cache)
+    {
+      cache = xzalloc (sizeof *cache);
+      cache_buffer->bidi_dir_cache = cache;
+    }
+  else if (EQ (cache->buffer, buffer)
+	   && EQ (cache->start_re, BVAR (b, bidi_paragraph_start_re))
+	   && EQ (cache->separate_re, BVAR (b, bidi_paragraph_separate_re)))
+    return cache;
+
+  cache->buffer = buffer;
+  cache->start_re = BVAR (b, bidi_paragraph_start_re);
+  cache->separate_re = BVAR (b, bidi_paragraph_separate_re);
+  cache->count = cache->next = 0;
+  return cache;
+}
+
+/* Return the entry of CACHE for the paragraph starting at byte
+   position START_BYTE, as seen from WINDOW, or NULL if there is none.
+   WINDOW identifies the window as in struct bidi_dir_cache_entry.  */
+static struct bidi_dir_cache_entry *
+bidi_dir_cache_lookup (struct bidi_dir_cache *cache, ptrdiff_t start_byte,
+		       EMACS_INT window)
+{
+  for (int i = 0; i < cache->count; i++)
+    {
+      struct bidi_dir_cache_entry *entry = &cache->entries[i];
+      /* The search for the strong character stops at ZV, so narrowing
+	 can hide the character that gave the direction.  */
+      if (entry->start_byte == start_byte && entry->window == window
+	  && entry->strong_end <= ZV)
+	return entry;
+    }
+  return NULL;
+}
+
+static void
+bidi_dir_cache_add (struct bidi_dir_cache *cache, ptrdiff_t start,
+		    ptrdiff_t start_byte, ptrdiff_t strong_end,
+		    EMACS_INT window, bidi_dir_t dir)
+{
+  struct bidi_dir_cache_entry *entry = &cache->entries[cache->next];
+
+  entry->start = start;
+  entry->start_byte = start_byte;
+  entry->strong_end = strong_end;
+  entry->window = window;
+  entry->dir = dir;
+  cache->next = (cache->next + 1) % BIDI_DIR_CACHE_SIZE;
+  if (cache->count < BIDI_DIR_CACHE_SIZE)
+    cache->count++;
+}
+
+/* Discard the paragraph directions of BUF that a change at START can
+   affect, i.e. those whose search for a strong character reached
+   START.  */
+void
+flush_bidi_dir_cache (struct buffer *buf, ptrdiff_t start)
+{
+  if (buf->base_buffer)
+    buf = buf->base_buffer;
+  struct bidi_dir_cache *cache = buf->bidi_dir_cache;
+  if (cache)
+    {
+      int n = 0;
+      for (int i = 0; i < cache->count; i++)
+	if (cache->entries[i].strong_end < start)
+	  cache->entries[n++] = cache->entries[i];
+      cache->count = n;
+      cache->next = n % BIDI_DIR_CACHE_SIZE;
+    }
+}
+
+void
+free_bidi_dir_cache (struct buffer *buf)
+{
+  xfree (buf->bidi_dir_cache);
+  buf->bidi_dir_cache = NULL;
+}
+
+void
+mark_bidi_dir_cache (struct buffer *buf)
+{
+  struct bidi_dir_cache *cache = buf->bidi_dir_cache;
+
+  if (cache)
+    {
+      mark_object (cache->buffer);
+      mark_object (cache->start_re);
+      mark_object (cache->separate_re);
+    }
+}
+
 /* Determine the base direction, a.k.a. base embedding level, of the
    paragraph we are about to iterate through.  If DIR is either L2R or
    R2L, just use that.  Otherwise, determine the paragraph direction
@@ -1762,16 +1905,44 @@ bidi_paragraph_init (bidi_dir_t dir, struct bidi_it *bidi_it, bool no_default_p)
       bidi_it->separator_limit = -1;
       bidi_it->new_paragraph = 0;
 
+      struct bidi_dir_cache *dir_cache
+	= string_p ? NULL : bidi_dir_cache_for_current_buffer ();
+      EMACS_INT window = ((bidi_it->w ? bidi_it->w->sequence_number * 2 : 0)
+			  + bidi_it->frame_window_p);
+
       /* The following loop is run more than once only if NO_DEFAULT_P,
 	 and only if we are iterating on a buffer.  */
       do {
+	struct bidi_dir_cache_entry *entry
+	  = (dir_cache
+	     ? bidi_dir_cache_lookup (dir_cache, pstartbyte, window)
+	     : NULL);
+
 	bytepos = pstartbyte;
-	if (!string_p)
-	  pos = BYTE_TO_CHAR (bytepos);
-	type = find_first_strong_char (pos, bytepos, end, &disp_pos, &disp_prop,
-				       &bidi_it->string, bidi_it->w,
-				       string_p, bidi_it->frame_window_p,
-				       &ch_len, &nchars, false);
+	if (entry)
+	  {
+	    pos = entry->start;
+	    type = entry->dir == R2L ? STRONG_R : STRONG_L;
+	  }
+	else
+	  {
+	    ptrdiff_t nsearched = nsearch_for_strong;
+
+	    if (!string_p)
+	      pos = BYTE_TO_CHAR (bytepos);
+	    type = find_first_strong_char (pos, bytepos, end,
+					   &disp_pos, &disp_prop,
+					   &bidi_it->string, bidi_it->w,
+					   string_p, bidi_it->frame_window_p,
+					   &ch_len, &nchars, false);
+	    /* Without a strong character, the direction depends on the
+	       previous paragraph, so don't remember that.  */
+	    if (dir_cache && (type == STRONG_L || type == STRONG_R
+			      || type == STRONG_AL))
+	      bidi_dir_cache_add (dir_cache, pos, bytepos,
+				  pos + nsearch_for_strong - nsearched,
+				  window, type == STRONG_L ? L2R : R2L);
+	  }
 	if (type == STRONG_R || type == STRONG_AL) /* P3 */
 	  bidi_it->paragraph_dir = R2L;
 	else if (type == STRONG_L)
@@ -3441,6 +3612,77 @@ bidi_find_other_level_edge (struct bidi_it *bidi_it, int level, bool end_flag)
     }
 }
 
+/* If BIDI_IT is at a strong L character on the base level of a
+   left-to-right paragraph in a buffer, and the next character is an
+   ASCII character of type L, move BIDI_IT to that character and
+   return true.  This is the common case of plain left-to-right text,
+   where the next character needs no resolution at all; the state left
+   in BIDI_IT is the one bidi_level_of_next_char would produce.  */
+static bool
+bidi_move_to_next_ascii_l (struct bidi_it *bidi_it)
+{
+  ptrdiff_t charpos = bidi_it->charpos + bidi_it->nchars;
+  ptrdiff_t bytepos = bidi_it->bytepos + bidi_it->ch_len;
+  int ch;
+
+  if (bidi__inhibit_ascii_fast_path
+      || bidi_it->first_elt
+      || bidi_it->scan_dir != 1
+      || bidi_cache_idx != bidi_cache_start
+      || bidi_it->string.s || STRINGP (bidi_it->string.lstring)
+      || bidi_it->stack_idx != 0
+      || bidi_it->level_stack[0].level != 0
+      || OVERRIDE (bidi_it, 0) != NEUTRAL_DIR
+      || bidi_it->resolved_level != 0
+      || bidi_it->orig_type != STRONG_L
+      || bidi_it->type != STRONG_L
+      || bidi_it->type_after_wn != STRONG_L
+      || bidi_it->bytepos < BEGV_BYTE
+      || bidi_it->nchars <= 0 || bidi_it->ch_len <= 0
+      /* The next character must not be covered by a display string,
+	 and bidi_fetch_char must not need to look for the next one.  */
+      || charpos >= ZV || charpos >= bidi_it->disp_pos)
+    return false;
+
+  ch = FETCH_BYTE (bytepos);
+  if (!ASCII_CHAR_P (ch) || bidi_get_type (ch, NEUTRAL_DIR) != STRONG_L)
+    return false;
+
+  /* Record the current character as bidi_resolve_explicit does.  */
+  bidi_remember_char (&bidi_it->prev, bidi_it, 0);
+  bidi_remember_char (&bidi_it->last_strong, bidi_it, 0);
+  bidi_remember_char (&bidi_it->prev_for_neutral, bidi_it, 1);
+  if (bidi_it->charpos >= bidi_it->next_for_neutral.charpos)
+    {
+      bidi_it->next_for_neutral.type = UNKNOWN_BT;
+      if (bidi_it->bracket_pairing_pos == ZV)
+	bidi_it->bracket_pairing_pos = -1;
+    }
+  if (bidi_it->next_en_pos >= 0
+      && bidi_it->charpos >= bidi_it->next_en_pos)
+    {
+      bidi_it->next_en_pos = 0;
+      bidi_it->next_en_type = UNKNOWN_BT;
+    }
+  if (bidi_it->bracket_pairing_pos != ZV)
+    {
+      bidi_it->bracket_pairing_pos = -1;
+      bidi_it->bracket_enclosed_type = UNKNOWN_BT;
+    }
+
+  /* The next character has the same types and level as this one.  */
+  bidi_it->charpos = charpos;
+  bidi_it->bytepos = bytepos;
+  bidi_it->ch = ch;
+  bidi_it->ch_len = 1;
+  bidi_it->nchars = 1;
+
+  /* The full resolution caches the previous state as a sentinel, then
+     discards it once past it.  */
+  bidi_cache_reset ();
+  return true;
+}
+
 void
 bidi_move_to_visually_next (struct bidi_it *bidi_it)
 {
@@ -3460,6 +3702,9 @@ bidi_move_to_visually_next (struct bidi_it *bidi_it)
       && (bidi_it->ch == '\n' || bidi_it->ch == BIDI_EOB))
     bidi_line_init (bidi_it);
 
+  if (bidi_move_to_next_ascii_l (bidi_it))
+    return;
+
   /* Prepare the sentinel iterator state, and cache it.  When we bump
      into it, scanning backwards, we'll know that the last non-base
      level is exhausted.  */
@@ -3608,6 +3853,27 @@ bidi_move_to_visually_next (struct bidi_it *bidi_it)
 	   && bidi_it->resolved_level <= BIDI_MAXDEPTH + 2);
 }
 
+/* Return true if BIDI_IT is at a strong left-to-right character of
+   buffer text, at the base level of a left-to-right paragraph, with
+   no state left from the text before it that could affect the levels
+   of the text after it.  An iterator started afresh at that character
+   then reorders the rest of the paragraph the same way.  */
+bool
+bidi_restartable_p (struct bidi_it *bidi_it)
+{
+  return (!bidi_it->first_elt
+	  && bidi_it->scan_dir == 1
+	  && bidi_cache_idx == bidi_cache_start
+	  && !bidi_it->string.s && !STRINGP (bidi_it->string.lstring)
+	  && bidi_it->paragraph_dir == L2R
+	  && bidi_it->stack_idx == 0
+	  && bidi_it->level_stack[0].level == 0
+	  && OVERRIDE (bidi_it, 0) == NEUTRAL_DIR
+	  && bidi_it->resolved_level == 0
+	  && bidi_it->orig_type == STRONG_L
+	  && bidi_it->type == STRONG_L);
+}
+
 /* Utility function for looking for strong directional characters
    whose bidi type was overridden by directional override or embedding
    or isolate control characters.  */
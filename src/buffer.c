@@ -607,6 +607,8 @@ DEFUN ("get-buffer-create", Fget_buffer_create, Sget_buffer_create, 1, 2, 0,
   b->newline_cache = 0;
   b->width_run_cache = 0;
   b->bidi_paragraph_cache = 0;
+  b->column_cache = NULL;
+  b->bidi_dir_cache = NULL;
   bset_width_table (b, Qnil);
   b->prevent_redisplay_optimizations_p = 1;
 
@@ -628,6 +630,9 @@ DEFUN ("get-buffer-create", Fget_buffer_create, Sget_buffer_create, 1, 2, 0,
 
   bset_mark (b, Fmake_marker ());
   BUF_MARKERS (b) = NULL;
+  b->text->marker_index = NULL;
+  b->text->position_index = NULL;
+  b->text->parse_state_cache = NULL;
 
   /* Put this in the alist of all live buffers.  */
   XSETBUFFER (buffer, b);
@@ -654,12 +659,12 @@ copy_overlays (struct buffer *b, struct Lisp_Overlay *list)
 
       eassert (MARKERP (list->start));
       m = XMARKER (list->start);
-      start = build_marker (b, m->charpos, m->bytepos);
+      start = build_marker (b, marker_charpos (m), marker_bytepos (m));
       XMARKER (start)->insertion_type = m->insertion_type;
 
       eassert (MARKERP (list->end));
       m = XMARKER (list->end);
-      end = build_marker (b, m->charpos, m->bytepos);
+      end = build_marker (b, marker_charpos (m), marker_bytepos (m));
       XMARKER (end)->insertion_type = m->insertion_type;
 
       overlay = build_overlay (start, end, Fcopy_sequence (list->plist));
@@ -717,7 +722,7 @@ clone_per_buffer_values (struct buffer *from, struct buffer *to)
 	{
 	  struct Lisp_Marker *m = XMARKER (obj);
 
-	  obj = build_marker (to, m->charpos, m->bytepos);
+	  obj = build_marker (to, marker_charpos (m), marker_bytepos (m));
 	  XMARKER (obj)->insertion_type = m->insertion_type;
 	}
 
@@ -847,6 +852,8 @@ DEFUN ("make-indirect-buffer", Fmake_indirect_buffer, Smake_indirect_buffer,
   b->newline_cache = 0;
   b->width_run_cache = 0;
   b->bidi_paragraph_cache = 0;
+  b->column_cache = NULL;
+  b->bidi_dir_cache = NULL;
   bset_width_table (b, Qnil);
 
   name = Fcopy_sequence (name);
@@ -996,6 +1003,9 @@ reset_buffer (register struct buffer *b)
   set_buffer_overlays_before (b, NULL);
   set_buffer_overlays_after (b, NULL);
   b->overlay_center = BEG;
+  b->undo_scan_start = b->undo_scan_end = Qnil;
+  b->undo_scan_size = 0;
+  b->undo_scan_markers = false;
   bset_mark_active (b, Qnil);
   bset_point_before_scroll (b, Qnil);
   bset_file_format (b, Qnil);
@@ -1737,11 +1747,11 @@ compact_buffer (struct buffer *buffer)
       if (!buffer->text->inhibit_shrinking)
 	{
 	  /* If a buffer's gap size is more than 10% of the buffer
-	     size, or larger than GAP_BYTES_DFL bytes, then shrink it
+	     size, or larger than its gap allowance, then shrink it
 	     accordingly.  Keep a minimum size of GAP_BYTES_MIN bytes.  */
-	  ptrdiff_t size = clip_to_bounds (GAP_BYTES_MIN,
-					   BUF_Z_BYTE (buffer) / 10,
-					   GAP_BYTES_DFL);
+	  ptrdiff_t z_byte = BUF_Z_BYTE (buffer);
+	  ptrdiff_t size = clip_to_bounds (GAP_BYTES_MIN, z_byte / 10,
+					   buf_gap_allowance (z_byte));
 	  if (BUF_GAP_SIZE (buffer) > size)
 	    make_gap_1 (buffer, -(BUF_GAP_SIZE (buffer) - size));
 	}
@@ -1947,6 +1957,8 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
 	{
 	  if (m->buffer == b)
 	    {
+	      if (m->chunk)
+		unindex_marker (m);
 	      m->buffer = NULL;
 	      *mp = m->next;
 	    }
@@ -1966,6 +1978,9 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
     {
       /* Unchain all markers of this buffer and its indirect buffers.
 	 and leave them pointing nowhere.  */
+      free_marker_index (b);
+      free_position_index (b);
+      free_parse_state_cache (b);
       for (m = BUF_MARKERS (b); m; )
 	{
 	  struct Lisp_Marker *next = m->next;
@@ -2024,6 +2039,8 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
       free_region_cache (b->bidi_paragraph_cache);
       b->bidi_paragraph_cache = 0;
     }
+  free_column_cache (b);
+  free_bidi_dir_cache (b);
   bset_width_table (b, Qnil);
   unblock_input ();
 
@@ -2449,6 +2466,8 @@ #define swapfield_(field, type) \
   swapfield (newline_cache, struct region_cache *);
   swapfield (width_run_cache, struct region_cache *);
   swapfield (bidi_paragraph_cache, struct region_cache *);
+  swapfield (column_cache, struct column_cache *);
+  swapfield (bidi_dir_cache, struct bidi_dir_cache *);
   current_buffer->prevent_redisplay_optimizations_p = 1;
   other_buffer->prevent_redisplay_optimizations_p = 1;
   swapfield (long_line_optimizations_p, bool_bf);
@@ -2456,6 +2475,10 @@ #define swapfield_(field, type) \
   swapfield (overlays_after, struct Lisp_Overlay *);
   swapfield (overlay_center, ptrdiff_t);
   swapfield_ (undo_list, Lisp_Object);
+  swapfield (undo_scan_start, Lisp_Object);
+  swapfield (undo_scan_end, Lisp_Object);
+  swapfield (undo_scan_size, intmax_t);
+  swapfield (undo_scan_markers, bool);
   swapfield_ (mark, Lisp_Object);
   swapfield_ (mark_active, Lisp_Object); /* Belongs with the `mark'.  */
   swapfield_ (enable_multibyte_characters, Lisp_Object);
@@ -2608,6 +2631,10 @@ DEFUN ("set-buffer-multibyte", Fset_buffer_multibyte, Sset_buffer_multibyte,
       TEMP_SET_PT_BOTH (PT_BYTE, PT_BYTE);
 
 
+      free_marker_index (current_buffer);
+      free_position_index (current_buffer);
+      free_column_cache (current_buffer);
+      free_bidi_dir_cache (current_buffer);
       for (tail = BUF_MARKERS (current_buffer); tail; tail = tail->next)
 	tail->charpos = tail->bytepos;
 
@@ -2759,6 +2786,10 @@ DEFUN ("set-buffer-multibyte", Fset_buffer_multibyte, Sset_buffer_multibyte,
 	TEMP_SET_PT_BOTH (position, byte);
       }
 
+      free_marker_index (current_buffer);
+      free_position_index (current_buffer);
+      free_column_cache (current_buffer);
+      free_bidi_dir_cache (current_buffer);
       tail = markers = BUF_MARKERS (current_buffer);
 
       /* This prevents BYTE_TO_CHAR (that is, buf_bytepos_to_charpos) from
@@ -4014,6 +4045,8 @@ modify_overlay (struct buffer *buf, ptrdiff_t start, ptrdiff_t end)
   BUF_COMPUTE_UNCHANGED (buf, start, end);
 
   bset_redisplay (buf);
+  flush_column_cache (buf, start);
+  flush_bidi_dir_cache (buf, start);
 
   modiff_incr (&BUF_OVERLAY_MODIFF (buf), 1);
 }
@@ -6260,6 +6293,17 @@ from (abs POSITION).  If POSITION is positive, point was at the front
 cache), and the caches will use memory roughly proportional to the
 number of newlines and characters whose screen width varies.
 
+`current-column' and `move-to-column' also record, every few thousand
+characters of a long line, the column they reached, and later start
+from the nearest such column instead of the beginning of the line.
+Likewise, `compute-motion', and `vertical-motion' in batch mode, record
+where they were on the screen in a long line to start from there
+later.  On text terminals, the display engine likewise records where
+screen lines start in a long line, so that `vertical-motion',
+`recenter' and redisplay can lay out the line from there.  It doesn't
+when the window shows line numbers, or when the line is longer than
+`long-line-threshold'; nor does it on graphical displays.
+
 Bidirectional editing also requires buffer scans to find paragraph
 separators.  If you have large paragraphs or no paragraph separators
 at all, these scans may be slow.  If `cache-long-scans' is non-nil,
@@ -205,8 +205,9 @@ BUF_TEMP_SET_PT (struct buffer *buffer, ptrdiff_t position)
 #define BUF_BYTES_MAX \
   (ptrdiff_t) min (MOST_POSITIVE_FIXNUM - 1, min (SIZE_MAX, PTRDIFF_MAX))
 
-/* Maximum gap size after compact_buffer, in bytes.  Also
-   used in make_gap_larger to get some extra reserved space.  */
+/* Maximum gap size after compact_buffer, in bytes, for all but large
+   buffers.  Also used in make_gap_larger to get some extra reserved
+   space.  See buf_gap_allowance.  */
 
 enum { GAP_BYTES_DFL = 2000 };
 
@@ -215,6 +216,18 @@ #define BUF_BYTES_MAX \
 
 enum { GAP_BYTES_MIN = 20 };
 
+/* Return the extra space to reserve in the gap of a buffer text that
+   is NBYTES bytes long, when enlarging the gap or compacting the
+   buffer.  It grows with the text, so that a series of insertions
+   into a large buffer does not have to reallocate the text, and move
+   everything after the gap, over and over again.  */
+
+INLINE ptrdiff_t
+buf_gap_allowance (ptrdiff_t nbytes)
+{
+  return max (GAP_BYTES_DFL, nbytes / 64);
+}
+
 /* For those very rare cases where you may have a "random" pointer into
    the middle of a multibyte char, this moves to the next boundary.  */
 extern ptrdiff_t advance_to_char_boundary (ptrdiff_t byte_pos);
@@ -291,6 +304,18 @@ #define FETCH_BYTE(n) *(BYTE_POS_ADDR ((n)))
        to move a marker within a buffer.  */
     struct Lisp_Marker *markers;
 
+    /* The same markers, sorted by position, or NULL if the index has
+       not been built yet.  See marker.c.  */
+    struct marker_index *marker_index;
+
+    /* Known correspondences between character and byte positions of
+       multibyte text, or NULL.  See marker.c.  */
+    struct position_index *position_index;
+
+    /* Parse states at regular intervals of the text, or NULL.  See
+       syntax.c.  */
+    struct parse_state_cache *parse_state_cache;
+
     /* Usually false.  Temporarily true in decode_coding_gap to
        prevent Fgarbage_collect from shrinking the gap and losing
        not-yet-decoded bytes.  */
@@ -679,6 +704,14 @@ #define BVAR(buf, field) ((buf)->field ## _)
   struct region_cache *width_run_cache;
   struct region_cache *bidi_paragraph_cache;
 
+  /* Column checkpoints within long lines; see indent.c.  Like the
+     caches above, only the base buffer has one.  */
+  struct column_cache *column_cache;
+
+  /* Base directions of paragraphs; see bidi.c.  Likewise only in the
+     base buffer.  */
+  struct bidi_dir_cache *bidi_dir_cache;
+
   /* Non-zero means disable redisplay optimizations when rebuilding the glyph
      matrices (but not when redrawing).  */
   bool_bf prevent_redisplay_optimizations_p : 1;
@@ -714,6 +747,19 @@ #define BVAR(buf, field) ((buf)->field ## _)
      struct buffer_text because local variables have to be right in
      the struct buffer. So we copy it around in set_buffer_internal.  */
   Lisp_Object undo_list_;
+
+  /* The undo records of the most recent command, as measured by
+     truncate_undo_list: the first and last conses of undo_list_ that
+     were scanned, the size of the records they hold, and whether any
+     of them is a marker adjustment.  This lets truncate_undo_list and
+     the garbage collector skip the records they have already seen
+     when a command records lots of changes.  The conses are not
+     marked by the garbage collector, which resets these fields
+     instead if the conses do not survive it.  */
+  Lisp_Object undo_scan_start;
+  Lisp_Object undo_scan_end;
+  intmax_t undo_scan_size;
+  bool_bf undo_scan_markers : 1;
 };
 
 INLINE bool
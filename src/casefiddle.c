@@ -32,6 +32,16 @@ Copyright (C) 1985, 1994, 1997-1999, 2001-2022 Free Software Foundation,
 
 enum case_action {CASE_UP, CASE_DOWN, CASE_CAPITALIZE, CASE_CAPITALIZE_UP};
 
+/* Bits of struct casing_context's ascii_memo.  */
+enum
+  {
+    ASCII_CASED = 0177,		/* The cased character.  */
+    ASCII_KNOWN = 0200,		/* The other bits are set.  */
+    ASCII_WORD = 0400,		/* The character has word syntax...  */
+    ASCII_PREFIX = 01000,	/* ...and the prefix flag, in a buffer.  */
+    ASCII_SLOW = 02000		/* Casing it is not ASCII to ASCII.  */
+  };
+
 /* State for casing individual characters.  */
 struct casing_context
 {
@@ -57,6 +67,10 @@ Copyright (C) 1985, 1994, 1997-1999, 2001-2022 Free Software Foundation,
 
   /* What the last operation was.  */
   bool downcase_last;
+
+  /* For CASE_UP and CASE_DOWN, what case_ascii_character found out
+     about each ASCII character, or 0 if it has not been cased yet.  */
+  unsigned short ascii_memo[0200];
 };
 
 /* Initialize CTX structure for casing characters.  */
@@ -67,6 +81,7 @@ prepare_casing_context (struct casing_context *ctx,
   ctx->flag = flag;
   ctx->inbuffer = inbuffer;
   ctx->inword = false;
+  memset (ctx->ascii_memo, 0, sizeof ctx->ascii_memo);
   ctx->titlecase_char_table
     = (flag < CASE_CAPITALIZE ? Qnil
        : uniprop_table (Qtitlecase));
@@ -227,6 +242,50 @@ case_character (struct casing_str_buf *buf, struct casing_context *ctx,
   return changed;
 }
 
+/* Based on CTX, whose flag must be CASE_UP or CASE_DOWN, case the
+   ASCII character CH and update CTX like case_character would.
+   Return the cased character, or -1 if CH is not cased to a single
+   ASCII character, in which case CTX is not updated and CH should be
+   cased with case_character instead.
+
+   This is much faster than case_character for all but the first
+   occurrence of each character, as casing large amounts of mostly
+   ASCII text needs.  The case and syntax tables must not change
+   while CTX is in use.  */
+static int
+case_ascii_character (struct casing_context *ctx, int ch)
+{
+  int memo = ctx->ascii_memo[ch];
+
+  if (!memo)
+    {
+      struct casing_str_buf buf;
+      bool inword = ctx->inword;
+
+      memo = ASCII_KNOWN;
+      case_character_impl (&buf, ctx, ch);
+      if (buf.len_chars == 1 && buf.len_bytes == 1)
+	memo |= buf.data[0];
+      else
+	memo |= ASCII_SLOW;
+      if (SYNTAX (ch) == Sword)
+	{
+	  memo |= ASCII_WORD;
+	  if (ctx->inbuffer && syntax_prefix_flag_p (ch))
+	    memo |= ASCII_PREFIX;
+	}
+      ctx->ascii_memo[ch] = memo;
+      ctx->inword = inword;
+    }
+
+  if (memo & ASCII_SLOW)
+    return -1;
+  ctx->inword = ((memo & ASCII_WORD)
+		 && (ctx->inword || !(memo & ASCII_PREFIX)));
+  ctx->downcase_last = ctx->flag == CASE_DOWN;
+  return memo & ASCII_CASED;
+}
+
 /* If C is not ASCII, make it unibyte. */
 static inline int
 make_char_unibyte (int c)
@@ -287,11 +346,23 @@ do_casify_multibyte_string (struct casing_context *ctx, Lisp_Object obj)
   unsigned char *o = dst;
 
   const unsigned char *src = SDATA (obj);
+  bool ascii_ok = ctx->flag <= CASE_DOWN;
 
   for (n = 0; size; --size)
     {
       if (dst_end - o < sizeof (struct casing_str_buf))
 	string_overflow ();
+      if (ascii_ok && ASCII_CHAR_P (*src))
+	{
+	  int cased = case_ascii_character (ctx, *src);
+	  if (cased >= 0)
+	    {
+	      *o++ = cased;
+	      src++;
+	      n++;
+	      continue;
+	    }
+	}
       int ch = string_char_advance (&src);
       case_character ((struct casing_str_buf *) o, ctx, ch,
 		      size > 1 ? src : NULL);
@@ -319,12 +390,17 @@ do_casify_unibyte_string (struct casing_context *ctx, Lisp_Object obj)
 {
   ptrdiff_t i, size = SCHARS (obj);
   int ch, cased;
+  bool ascii_ok = ctx->flag <= CASE_DOWN;
 
   obj = Fcopy_sequence (obj);
   for (i = 0; i < size; i++)
     {
       ch = make_char_multibyte (SREF (obj, i));
-      cased = case_single_character (ctx, ch);
+      cased = -1;
+      if (ascii_ok && ASCII_CHAR_P (ch))
+	cased = case_ascii_character (ctx, ch);
+      if (cased < 0)
+	cased = case_single_character (ctx, ch);
       if (ch == cased)
 	continue;
       /* If down/upcasing changed an ASCII character into a non-ASCII
@@ -435,11 +511,16 @@ do_casify_unibyte_region (struct casing_context *ctx,
 {
   ptrdiff_t first = -1, last = -1;  /* Position of first and last changes.  */
   ptrdiff_t end = *endp;
+  bool ascii_ok = ctx->flag <= CASE_DOWN;
 
   for (ptrdiff_t pos = *startp; pos < end; ++pos)
     {
       int ch = make_char_multibyte (FETCH_BYTE (pos));
-      int cased = case_single_character (ctx, ch);
+      int cased = -1;
+      if (ascii_ok && ASCII_CHAR_P (ch))
+	cased = case_ascii_character (ctx, ch);
+      if (cased < 0)
+	cased = case_single_character (ctx, ch);
       if (cased == ch)
 	continue;
 
@@ -468,10 +549,30 @@ do_casify_multibyte_region (struct casing_context *ctx,
   ptrdiff_t first = -1, last = -1;  /* Position of first and last changes.  */
   ptrdiff_t pos = *startp, pos_byte = CHAR_TO_BYTE (pos), size = *endp - pos;
   ptrdiff_t opoint = PT, added = 0;
+  bool ascii_ok = ctx->flag <= CASE_DOWN;
 
   for (; size; --size)
     {
-      int len, ch = string_char_and_length (BYTE_POS_ADDR (pos_byte), &len);
+      unsigned char *p = BYTE_POS_ADDR (pos_byte);
+      if (ascii_ok && ASCII_CHAR_P (*p))
+	{
+	  int cased = case_ascii_character (ctx, *p);
+	  if (cased >= 0)
+	    {
+	      if (cased != *p)
+		{
+		  *p = cased;
+		  last = pos + 1;
+		  if (first < 0)
+		    first = pos;
+		}
+	      pos_byte++;
+	      pos++;
+	      continue;
+	    }
+	}
+
+      int len, ch = string_char_and_length (p, &len);
       struct casing_str_buf buf;
       if (!case_character (&buf, ctx, ch,
 			   size > 1 ? BYTE_POS_ADDR (pos_byte + len) : NULL))
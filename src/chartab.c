@@ -223,8 +223,234 @@ sub_char_table_ref (Lisp_Object table, int c, bool is_uniprop)
   return val;
 }
 
+/* Cache of the values of non-ASCII characters in char-tables, as
+   found by char_table_ref.  A lookup in a char-table walks down to
+   three levels of sub char-tables, and does that again in the parent
+   if the value is nil, as it usually is in syntax tables of major
+   modes.  Characters looked up one after the other are usually close
+   to each other, so each entry holds the values of the characters in
+   a small block of consecutive characters of one char-table.
+
+   Each entry is valid as long as char_table_modiff of its char-table
+   is the same.  Garbage collection empties the cache, since it does
+   not keep the char-tables and values alive.  */
+
+enum
+  {
+    CHAR_TABLE_CACHE_BLOCK_BITS = 5,
+    CHAR_TABLE_CACHE_BLOCK = 1 << CHAR_TABLE_CACHE_BLOCK_BITS,
+    CHAR_TABLE_CACHE_SIZE = 256
+  };
+
+struct char_table_cache_entry
+{
+  /* The char-table whose values are here, or NULL.  */
+  struct Lisp_Char_Table *table;
+
+  /* The first character of the block divided by
+     CHAR_TABLE_CACHE_BLOCK.  */
+  int block;
+
+  /* Bit I is set if VAL[I] is the value of the Ith character of the
+     block.  */
+  uint_least32_t found;
+
+  /* The value of char_table_modiff when the entry was made.  */
+  EMACS_UINT modiff;
+
+  Lisp_Object val[CHAR_TABLE_CACHE_BLOCK];
+};
+
+static struct char_table_cache_entry char_table_cache[CHAR_TABLE_CACHE_SIZE];
+
+/* Modification counts of char-tables.
+
+   Data computed from char-tables, like the entries of
+   char_table_cache, the parse states cached by syntax.c and the
+   column checkpoints of indent.c, remember char_table_modiff of the
+   tables they were computed from, and are valid while it stays the
+   same.  A char-table gets a count the first time char_table_modiff is
+   asked about it, and a new one whenever it is changed after that, so
+   changing a char-table does not affect what was computed from other
+   char-tables.  The counts come from one counter and are never
+   reused.
+
+   The counts are in a hash table indexed by the address of the
+   char-table, with linear probing.  An entry whose count is zero is
+   for a char-table that garbage collection has freed; it is reused if
+   a new char-table gets the same address, and dropped when the table
+   is resized.  */
+
+struct char_table_modiff_entry
+{
+  struct Lisp_Char_Table *table;
+  EMACS_UINT modiff;
+};
+
+static struct char_table_modiff_entry *char_table_modiffs;
+
+/* The size of char_table_modiffs, a power of 2 or zero, and the
+   number of its entries that are in use.  */
+static ptrdiff_t char_table_modiffs_size, char_table_modiffs_used;
+
+/* The last count given to a char-table.  */
+static EMACS_UINT char_table_modiff_counter;
+
+/* Return the entry of char_table_modiffs for TBL, or the empty entry
+   where it should go.  */
+
+static struct char_table_modiff_entry *
+char_table_modiff_entry (struct Lisp_Char_Table *tbl)
+{
+  ptrdiff_t mask = char_table_modiffs_size - 1;
+  ptrdiff_t i = ((uintptr_t) tbl / GCALIGNMENT) & mask;
+
+  while (char_table_modiffs[i].table && char_table_modiffs[i].table != tbl)
+    i = (i + 1) & mask;
+  return &char_table_modiffs[i];
+}
+
+/* Make char_table_modiffs big enough for one more entry.  */
+
+static void
+grow_char_table_modiffs (void)
+{
+  struct char_table_modiff_entry *old = char_table_modiffs;
+  ptrdiff_t old_size = char_table_modiffs_size, live = 0, size = 64;
+
+  for (ptrdiff_t i = 0; i < old_size; i++)
+    live += old[i].modiff != 0;
+  while (size < 4 * (live + 1))
+    size *= 2;
+
+  char_table_modiffs = xzalloc (size * sizeof *char_table_modiffs);
+  char_table_modiffs_size = size;
+  char_table_modiffs_used = live;
+  for (ptrdiff_t i = 0; i < old_size; i++)
+    if (old[i].modiff)
+      *char_table_modiff_entry (old[i].table) = old[i];
+  xfree (old);
+}
+
+/* Return the modification count of char-table TABLE, which changes
+   whenever TABLE or one of its parents changes.  */
+
+EMACS_UINT
+char_table_modiff (Lisp_Object table)
+{
+  EMACS_UINT modiff = 0;
+
+  do
+    {
+      struct Lisp_Char_Table *tbl = XCHAR_TABLE (table);
+      struct char_table_modiff_entry *e = NULL;
+
+      if (char_table_modiffs_size)
+	e = char_table_modiff_entry (tbl);
+      if (!e || !e->table)
+	{
+	  if (2 * (char_table_modiffs_used + 1) > char_table_modiffs_size)
+	    {
+	      grow_char_table_modiffs ();
+	      e = char_table_modiff_entry (tbl);
+	    }
+	  e->table = tbl;
+	  char_table_modiffs_used++;
+	}
+      if (!e->modiff)
+	e->modiff = ++char_table_modiff_counter;
+      modiff = max (modiff, e->modiff);
+      table = tbl->parent;
+    }
+  while (CHAR_TABLE_P (table));
+
+  return modiff;
+}
+
+/* Note that the values or extra slots of char-table TABLE are
+   changing.  */
+
+void
+char_table_modified (Lisp_Object table)
+{
+  if (char_table_modiffs_used)
+    {
+      struct char_table_modiff_entry *e
+	= char_table_modiff_entry (XCHAR_TABLE (table));
+      if (e->modiff)
+	e->modiff = ++char_table_modiff_counter;
+    }
+}
+
+/* Forget the modification counts of the char-tables that the current
+   garbage collection is about to free.  */
+
+void
+sweep_char_table_modiffs (void)
+{
+  for (ptrdiff_t i = 0; i < char_table_modiffs_size; i++)
+    {
+      struct char_table_modiff_entry *e = &char_table_modiffs[i];
+      if (e->modiff)
+	{
+	  Lisp_Object table;
+	  XSETCHAR_TABLE (table, e->table);
+	  if (!survives_gc_p (table))
+	    e->modiff = 0;
+	}
+    }
+}
+
+/* Empty char_table_cache.  */
+
+void
+clear_char_table_cache (void)
+{
+  memset (char_table_cache, 0, sizeof char_table_cache);
+}
+
+static Lisp_Object char_table_ref_1 (Lisp_Object, int);
+
 Lisp_Object
 char_table_ref (Lisp_Object table, int c)
+{
+  struct Lisp_Char_Table *tbl = XCHAR_TABLE (table);
+
+  if (ASCII_CHAR_P (c))
+    return char_table_ref_1 (table, c);
+
+  int block = c >> CHAR_TABLE_CACHE_BLOCK_BITS;
+  int i = c & (CHAR_TABLE_CACHE_BLOCK - 1);
+  struct char_table_cache_entry *e
+    = &char_table_cache[(block ^ ((uintptr_t) tbl / GCALIGNMENT))
+			% CHAR_TABLE_CACHE_SIZE];
+
+  EMACS_UINT modiff = char_table_modiff (table);
+
+  if (e->table == tbl && e->block == block && e->modiff == modiff
+      && e->found & ((uint_least32_t) 1 << i))
+    return e->val[i];
+
+  /* The lookup below can use this entry for the parent of TABLE, so
+     check the entry again afterwards.  */
+  Lisp_Object val = char_table_ref_1 (table, c);
+  if (! (e->table == tbl && e->block == block && e->modiff == modiff))
+    {
+      e->table = tbl;
+      e->block = block;
+      e->found = 0;
+      e->modiff = modiff;
+    }
+  e->val[i] = val;
+  e->found |= (uint_least32_t) 1 << i;
+  return val;
+}
+
+/* Return the value for character C in TABLE, without using
+   char_table_cache.  */
+
+static Lisp_Object
+char_table_ref_1 (Lisp_Object table, int c)
 {
   struct Lisp_Char_Table *tbl = XCHAR_TABLE (table);
   Lisp_Object val;
@@ -402,6 +628,7 @@ char_table_set (Lisp_Object table, int c, Lisp_Object val)
 {
   struct Lisp_Char_Table *tbl = XCHAR_TABLE (table);
 
+  char_table_modified (table);
   if (ASCII_CHAR_P (c)
       && SUB_CHAR_TABLE_P (tbl->ascii))
     set_sub_char_table_contents (tbl->ascii, c, val);
@@ -470,6 +697,8 @@ char_table_set_range (Lisp_Object table, int from, int to, Lisp_Object val)
   else
     {
       bool is_uniprop = UNIPROP_TABLE_P (table);
+
+      char_table_modified (table);
       int lim = CHARTAB_IDX (to, 0, 0);
       int i, c;
 
@@ -541,6 +770,7 @@ DEFUN ("set-char-table-parent", Fset_char_table_parent, Sset_char_table_parent,
 	  error ("Attempt to make a chartable be its own parent");
     }
 
+  char_table_modified (char_table);
   set_char_table_parent (char_table, parent);
 
   return parent;
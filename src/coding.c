@@ -8100,7 +8100,8 @@ decode_coding_object (struct coding_system *coding,
 	  for (tail = BUF_MARKERS (current_buffer); tail; tail = tail->next)
 	    {
 	      tail->need_adjustment
-		= tail->charpos == (tail->insertion_type ? from : to);
+		= (marker_charpos (tail)
+		   == (tail->insertion_type ? from : to));
 	      need_marker_adjustment |= tail->need_adjustment;
 	    }
 	  saved_pt = PT, saved_pt_byte = PT_BYTE;
@@ -8219,16 +8220,15 @@ decode_coding_object (struct coding_system *coding,
 	      {
 		tail->need_adjustment = 0;
 		if (tail->insertion_type)
-		  {
-		    tail->bytepos = from_byte;
-		    tail->charpos = from;
-		  }
+		  reposition_marker (tail, from, from_byte);
 		else
 		  {
-		    tail->bytepos = from_byte + coding->produced;
-		    tail->charpos
-		      = (NILP (BVAR (current_buffer, enable_multibyte_characters))
-			 ? tail->bytepos : from + coding->produced_char);
+		    ptrdiff_t bytepos = from_byte + coding->produced;
+		    reposition_marker
+		      (tail,
+		       (NILP (BVAR (current_buffer, enable_multibyte_characters))
+			? bytepos : from + coding->produced_char),
+		       bytepos);
 		  }
 	      }
 	}
@@ -8307,7 +8307,7 @@ encode_coding_object (struct coding_system *coding,
       for (tail = BUF_MARKERS (XBUFFER (src_object)); tail; tail = tail->next)
 	{
 	  tail->need_adjustment
-	    = tail->charpos == (tail->insertion_type ? from : to);
+	    = marker_charpos (tail) == (tail->insertion_type ? from : to);
 	  need_marker_adjustment |= tail->need_adjustment;
 	}
     }
@@ -8458,16 +8458,15 @@ encode_coding_object (struct coding_system *coding,
 	      {
 		tail->need_adjustment = 0;
 		if (tail->insertion_type)
-		  {
-		    tail->bytepos = from_byte;
-		    tail->charpos = from;
-		  }
+		  reposition_marker (tail, from, from_byte);
 		else
 		  {
-		    tail->bytepos = from_byte + coding->produced;
-		    tail->charpos
-		      = (NILP (BVAR (current_buffer, enable_multibyte_characters))
-			 ? tail->bytepos : from + coding->produced_char);
+		    ptrdiff_t bytepos = from_byte + coding->produced;
+		    reposition_marker
+		      (tail,
+		       (NILP (BVAR (current_buffer, enable_multibyte_characters))
+			? bytepos : from + coding->produced_char),
+		       bytepos);
 		  }
 	      }
 	}
@@ -679,6 +679,128 @@ composition_gstring_from_id (ptrdiff_t id)
   return HASH_VALUE (h, id);
 }
 
+/* Cache of the results of shaping text runs for automatic
+   composition.  The hash table of glyph-strings only remembers
+   glyph-strings that compose all the characters they were made for,
+   so text whose composition functions compose fewer characters, or
+   fail to compose them, would call those functions again in every
+   redisplay.  This cache remembers the result of calling a
+   composition function FUNC on the characters of a glyph-string
+   header (which include the font) in the bidi direction DIRECTION,
+   whether a glyph-string or nil.
+
+   The cache is set-associative: a key can only be in one of
+   SHAPE_CACHE_WAYS slots of the set selected by its hash, and the
+   least recently used slot of the set is replaced when a new key is
+   added.  The slots of shape_cache are pairs of a key [FUNC
+   DIRECTION FONT-OBJECT CHAR ...] and its value.  */
+
+#define SHAPE_CACHE_SETS 256
+#define SHAPE_CACHE_WAYS 4
+#define SHAPE_CACHE_SIZE (SHAPE_CACHE_SETS * SHAPE_CACHE_WAYS)
+
+static Lisp_Object shape_cache;
+static EMACS_UINT shape_cache_hashes[SHAPE_CACHE_SIZE];
+
+/* When each slot was last used, or zero if the slot is empty.  */
+static EMACS_UINT shape_cache_ticks[SHAPE_CACHE_SIZE];
+static EMACS_UINT shape_cache_clock;
+
+enum shape_cache_counter
+  {
+    SC_LOOKUPS,
+    SC_HITS,
+    SC_EVICTIONS,
+    SC_SHAPED,
+    SC_FAST_SHAPED,
+    SC_MAX
+  };
+
+static intmax_t shape_cache_counters[SC_MAX];
+
+static void
+clear_shape_cache (void)
+{
+  memset (shape_cache_ticks, 0, sizeof shape_cache_ticks);
+  if (VECTORP (shape_cache))
+    memclear (XVECTOR (shape_cache)->contents,
+	      ASIZE (shape_cache) * word_size);
+}
+
+static EMACS_UINT
+shape_cache_hash (Lisp_Object func, Lisp_Object direction,
+		  Lisp_Object header)
+{
+  EMACS_UINT hash = sxhash_combine (XHASH (func), XHASH (direction));
+
+  for (ptrdiff_t i = 0; i < ASIZE (header); i++)
+    hash = sxhash_combine (hash, XHASH (AREF (header, i)));
+  return hash;
+}
+
+/* Return the slot of shape_cache holding the result of FUNC for
+   HEADER in DIRECTION, whose hash is HASH, or -1 if there is none.  */
+
+static ptrdiff_t
+shape_cache_lookup (EMACS_UINT hash, Lisp_Object func,
+		    Lisp_Object direction, Lisp_Object header)
+{
+  ptrdiff_t set = hash % SHAPE_CACHE_SETS * SHAPE_CACHE_WAYS;
+  ptrdiff_t len = ASIZE (header);
+
+  shape_cache_counters[SC_LOOKUPS]++;
+  for (ptrdiff_t i = set; i < set + SHAPE_CACHE_WAYS; i++)
+    {
+      Lisp_Object key = AREF (shape_cache, 2 * i);
+      ptrdiff_t j;
+
+      if (shape_cache_ticks[i] == 0
+	  || shape_cache_hashes[i] != hash
+	  || ASIZE (key) != len + 2
+	  || !EQ (AREF (key, 0), func)
+	  || !EQ (AREF (key, 1), direction))
+	continue;
+      for (j = 0; j < len; j++)
+	if (!EQ (AREF (key, j + 2), AREF (header, j)))
+	  break;
+      if (j == len)
+	{
+	  shape_cache_counters[SC_HITS]++;
+	  shape_cache_ticks[i] = ++shape_cache_clock;
+	  return i;
+	}
+    }
+  return -1;
+}
+
+/* Remember VAL as the result of FUNC for HEADER in DIRECTION, whose
+   hash is HASH.  HEADER must not be modified afterwards.  */
+
+static void
+shape_cache_put (EMACS_UINT hash, Lisp_Object func, Lisp_Object direction,
+		 Lisp_Object header, Lisp_Object val)
+{
+  ptrdiff_t set = hash % SHAPE_CACHE_SETS * SHAPE_CACHE_WAYS;
+  ptrdiff_t slot = set;
+  ptrdiff_t len = ASIZE (header);
+  Lisp_Object key = make_uninit_vector (len + 2);
+
+  for (ptrdiff_t i = set + 1; i < set + SHAPE_CACHE_WAYS; i++)
+    if (shape_cache_ticks[i] < shape_cache_ticks[slot])
+      slot = i;
+  if (shape_cache_ticks[slot] != 0)
+    shape_cache_counters[SC_EVICTIONS]++;
+
+  ASET (key, 0, func);
+  ASET (key, 1, direction);
+  for (ptrdiff_t i = 0; i < len; i++)
+    ASET (key, i + 2, AREF (header, i));
+  ASET (shape_cache, 2 * slot, key);
+  ASET (shape_cache, 2 * slot + 1, val);
+  shape_cache_hashes[slot] = hash;
+  shape_cache_ticks[slot] = ++shape_cache_clock;
+}
+
 /* Remove from the composition hash table every lgstring that
    references the given FONT_OBJECT.  */
 void
@@ -698,6 +820,9 @@ composition_gstring_cache_clear_font (Lisp_Object font_object)
 	    hash_remove_from_table (h, k);
 	}
     }
+
+  /* The identifiers of the removed glyph-strings can be reused.  */
+  clear_shape_cache ();
 }
 
 DEFUN ("clear-composition-cache", Fclear_composition_cache,
@@ -708,12 +833,44 @@ DEFUN ("clear-composition-cache", Fclear_composition_cache,
 {
   gstring_hash_table = CALLN (Fmake_hash_table, QCtest, Qequal,
 			      QCsize, make_fixnum (311));
+  clear_shape_cache ();
   /* Fixme: We call Fclear_face_cache to force complete re-building of
      display glyphs.  But, it may be better to call this function from
      Fclear_face_cache instead.  */
   return Fclear_face_cache (Qt);
 }
 
+DEFUN ("composition-cache-statistics", Fcomposition_cache_statistics,
+       Scomposition_cache_statistics, 0, 1, 0,
+       doc: /* Return an alist of counters kept by automatic composition.
+Each element has the form (NAME . VALUE).  The counters are:
+
+  `lookups'      lookups of text runs in the cache of shaping results
+  `hits'         lookups that found the result of shaping the run
+  `evictions'    results removed from the cache to make room for others
+  `shaped'       text runs shaped by calling a composition function
+  `fast-shaped'  text runs among them shaped by `font-shape-gstring'
+                 without calling `auto-composition-function'
+
+If RESET is non-nil, reset all counters to zero after returning their
+values.  */)
+  (Lisp_Object reset)
+{
+  static short const counter_symbols[SC_MAX] =
+    {
+      SYMBOL_INDEX (Qlookups), SYMBOL_INDEX (Qhits),
+      SYMBOL_INDEX (Qevictions), SYMBOL_INDEX (Qshaped),
+      SYMBOL_INDEX (Qfast_shaped)
+    };
+  Lisp_Object val = statistics_alist (SC_MAX, counter_symbols,
+				      shape_cache_counters, 0, NULL, NULL);
+
+  if (!NILP (reset))
+    memset (shape_cache_counters, 0, sizeof shape_cache_counters);
+
+  return val;
+}
+
 bool
 composition_gstring_p (Lisp_Object gstring)
 {
@@ -935,13 +1092,51 @@ autocmp_chars (Lisp_Object rule, ptrdiff_t charpos, ptrdiff_t bytepos,
 				       string);
   if (NILP (LGSTRING_ID (lgstring)))
     {
-      /* Save point as marker before calling out to lisp.  */
-      if (NILP (string))
-	record_unwind_protect (restore_point_unwind,
-			       build_marker (current_buffer, pt, pt_byte));
-      lgstring = safe_call (7, Vauto_composition_function, AREF (rule, 2),
-			    pos, make_fixnum (to), font_object, string,
-			    direction);
+      Lisp_Object func = AREF (rule, 2);
+      Lisp_Object header = LGSTRING_HEADER (lgstring);
+      /* The results of the default function depend only on FUNC, the
+	 glyph-string and DIRECTION, so they can be cached.  */
+      bool cache_p = EQ (Vauto_composition_function, Qauto_compose_chars);
+      EMACS_UINT hash = 0;
+
+      if (cache_p)
+	{
+	  hash = shape_cache_hash (func, direction, header);
+	  ptrdiff_t slot = shape_cache_lookup (hash, func, direction, header);
+	  if (slot >= 0)
+	    return unbind_to (count, AREF (shape_cache, 2 * slot + 1));
+	  /* The Lisp code called below can reuse HEADER.  */
+	  header = Fcopy_sequence (header);
+	}
+
+      shape_cache_counters[SC_SHAPED]++;
+      if (cache_p && FONT_OBJECT_P (font_object)
+	  && EQ (func, Qfont_shape_gstring))
+	{
+	  /* This is what auto-compose-chars would do, without the
+	     overhead of calling Lisp.  */
+	  shape_cache_counters[SC_FAST_SHAPED]++;
+	  lgstring = Ffont_shape_gstring (lgstring, direction);
+	}
+      else
+	{
+	  /* Save point as marker before calling out to lisp.  */
+	  if (NILP (string))
+	    record_unwind_protect (restore_point_unwind,
+				   build_marker (current_buffer, pt, pt_byte));
+	  lgstring = safe_call (7, Vauto_composition_function, func,
+				pos, make_fixnum (to), font_object, string,
+				direction);
+	}
+
+      if (cache_p)
+	{
+	  if (! composition_gstring_p (lgstring))
+	    lgstring = Qnil;
+	  else if (NILP (LGSTRING_ID (lgstring)))
+	    lgstring = composition_gstring_put_cache (lgstring, -1);
+	  shape_cache_put (hash, func, direction, header, lgstring);
+	}
     }
   return unbind_to (count, lgstring);
 }
@@ -2126,6 +2321,9 @@ syms_of_composite (void)
   gstring_hash_table = CALLMANY (Fmake_hash_table, args);
   staticpro (&gstring_hash_table);
 
+  shape_cache = make_nil_vector (2 * SHAPE_CACHE_SIZE);
+  staticpro (&shape_cache);
+
   staticpro (&gstring_work_headers);
   gstring_work_headers = make_nil_vector (8);
   for (i = 0; i < 8; i++)
@@ -2152,6 +2350,15 @@ syms_of_composite (void)
   Vcompose_chars_after_function = intern_c_string ("compose-chars-after");
 
   DEFSYM (Qauto_composed, "auto-composed");
+  DEFSYM (Qauto_compose_chars, "auto-compose-chars");
+  DEFSYM (Qfont_shape_gstring, "font-shape-gstring");
+
+  /* Names of the elements of `composition-cache-statistics'.  */
+  DEFSYM (Qlookups, "lookups");
+  DEFSYM (Qhits, "hits");
+  DEFSYM (Qevictions, "evictions");
+  DEFSYM (Qshaped, "shaped");
+  DEFSYM (Qfast_shaped, "fast-shaped");
 
   DEFVAR_LISP ("auto-composition-mode", Vauto_composition_mode,
 	       doc: /* Non-nil if Auto-Composition mode is enabled.
@@ -2235,5 +2442,6 @@ syms_of_composite (void)
   defsubr (&Sfind_composition_internal);
   defsubr (&Scomposition_get_gstring);
   defsubr (&Sclear_composition_cache);
+  defsubr (&Scomposition_cache_statistics);
   defsubr (&Scomposition_sort_rules);
 }
@@ -263,6 +263,8 @@ DEFUN ("type-of", Ftype_of, Stype_of, 1, 1, 0,
           return Qxwidget_view;
         case PVEC_SQLITE:
           return Qsqlite;
+        case PVEC_COMPLETION_INDEX:
+          return Qcompletion_index;
         /* "Impossible" cases.  */
 	case PVEC_MISC_PTR:
         case PVEC_OTHER:
@@ -1789,6 +1789,10 @@ #define FONT_TOO_HIGH(ft)						\
   /* If non-zero, use overstrike (to simulate bold-face).  */
   bool_bf overstrike : 1;
 
+  /* True means the face was realized or looked up since its face cache
+     was last refreshed (see refresh_realized_faces).  */
+  bool_bf used_since_refresh_p : 1;
+
 /* NOTE: this is not used yet, but eventually this impl should be done
          similarly to overstrike */
 #ifdef HAVE_NS
@@ -1869,6 +1873,24 @@ #define FACE_UNIBYTE_P(FACE) ((FACE)->charset < 0)
 
 #define MAX_FACE_ID  ((1 << FACE_ID_BITS) - 1)
 
+/* Number of entries in the memo of merged faces of a face cache.  */
+
+#define FACE_MERGE_MEMO_SIZE 127
+
+/* An entry in the memo of merged faces of a face cache.  It records
+   that merging the face references in REFS, in this order, into the
+   face with ID BASE_FACE_ID, using attribute filter ATTR_FILTER,
+   gave the face with ID FACE_ID.  REFS is nil for unused entries.  */
+
+struct face_merge_entry
+{
+  Lisp_Object refs;
+  uintptr_t hash;
+  int base_face_id;
+  int face_id;
+  enum lface_attribute_index attr_filter;
+};
+
 /* A cache of realized faces.  Each frame has its own cache because
    Emacs allows different frame-local face definitions.  */
 
@@ -1890,6 +1912,14 @@ #define MAX_FACE_ID  ((1 << FACE_ID_BITS) - 1)
   /* Flag indicating that attributes of the `menu' face have been
      changed.  */
   bool_bf menu_face_changed_p : 1;
+
+  /* Flag indicating that the default face has been realized again
+     while other faces realized for the former one were kept.  */
+  bool_bf default_face_changed_p : 1;
+
+  /* Memo of faces merged from stacks of face references at buffer
+     positions, or null if not yet needed.  */
+  struct face_merge_entry *merge_memo;
 };
 
 #define FACE_EXTENSIBLE_P(F)			\
@@ -2719,6 +2749,15 @@ #define OVERLAY_STRING_CHUNK_SIZE 16
      incremented/reset by display_line, move_it_to etc.  */
   int continuation_lines_width;
 
+  /* If nonzero, the start of the line being iterated, which
+     continuation_lines_width is relative to; move_it_to can then
+     record display checkpoints of that line.  Zero means unknown.  */
+  ptrdiff_t checkpoint_line_beg;
+
+  /* The position after which move_it_to can record the next display
+     checkpoint.  */
+  ptrdiff_t next_checkpoint_charpos;
+
   /* Buffer position that ends the buffer text line being iterated.
      This is normally the position after the newline at EOL.  If this
      is the last line of the buffer and it doesn't have a newline,
@@ -3189,6 +3228,19 @@ #define CENTERED_IMAGE_ASCENT -1
   /* True means that loading the image failed.  Don't try again.  */
   bool load_failed_p;
 
+  /* True means that loading the image was deferred because redisplay
+     had spent image-load-time-limit loading images.  load_failed_p is
+     also set, so the image is displayed as an empty rectangle.  */
+  bool load_deferred_p;
+
+  /* Number of bytes of image data counted for this image in the size
+     of its image cache.  */
+  size_t bytes;
+
+  /* True if the image is shown in a current glyph matrix.  Only
+     valid while limit_image_caches runs.  */
+  bool displayed_p;
+
   /* A place for image types to store additional data.  It is marked
      during GC.  */
   Lisp_Object lisp_data;
@@ -3234,6 +3286,9 @@ #define CENTERED_IMAGE_ASCENT -1
 
   /* Reference count (number of frames sharing this cache).  */
   ptrdiff_t refcount;
+
+  /* Number of bytes of image data in the cache.  */
+  size_t bytes;
 };
 
 /* Size of bucket vector of image caches.  Should be prime.  */
@@ -3395,6 +3450,39 @@ #define TTY_CAP_STRIKE_THROUGH	0x20
 extern void *bidi_shelve_cache (void);
 extern void bidi_unshelve_cache (void *, bool);
 extern ptrdiff_t bidi_find_first_overridden (struct bidi_it *);
+extern bool bidi_restartable_p (struct bidi_it *);
+
+/* Events counted by redisplay, reported by `redisplay-statistics'.  */
+
+enum redisplay_counter
+  {
+    RC_REDISPLAYS,		/* redisplay_internal got past its checks.  */
+    RC_WINDOWS,			/* Calls to redisplay_window.  */
+    RC_OPTIMIZATION_1,		/* Only the line containing point changed.  */
+    RC_OPTIMIZATION_3,		/* Point moved within the same line.  */
+    RC_CURSOR_MOVEMENT,		/* try_cursor_movement succeeded.  */
+    RC_TRY_WINDOW_ID,		/* Calls to try_window_id.  */
+    RC_TRY_WINDOW_ID_HITS,	/* Times it updated the window.  */
+    RC_REUSE_MATRIX,		/* Calls to try_window_reusing_current_matrix.  */
+    RC_REUSE_MATRIX_HITS,	/* Times it succeeded.  */
+    RC_TRY_WINDOW,		/* Calls to try_window.  */
+    RC_SCROLLING,		/* try_scrolling succeeded.  */
+    RC_RECENTER,		/* A new window start had to be chosen.  */
+    RC_ROWS_DISPLAYED,		/* Glyph rows produced by display_line.  */
+    RC_FRAME_UPDATES,		/* Calls to update_frame.  */
+    RC_ROWS_UPDATED,		/* Rows written to a window or frame.  */
+    RC_ROWS_MOVED,		/* Rows moved on the display by scrolling.  */
+    RC_MAX
+  };
+
+/* Phases of redisplay whose running time is accumulated.  */
+
+enum redisplay_phase
+  {
+    RP_REDISPLAY,		/* All of redisplay_internal.  */
+    RP_UPDATE,			/* update_frame.  */
+    RP_MAX
+  };
 
 /* Defined in xdisp.c */
 
@@ -3444,6 +3532,8 @@ #define TTY_CAP_STRIKE_THROUGH	0x20
 bool in_display_vector_p (struct it *);
 int frame_mode_line_height (struct frame *);
 extern bool redisplaying_p;
+extern intmax_t redisplay_counters[RC_MAX];
+extern double redisplay_phase_seconds[RP_MAX];
 extern bool display_working_on_window_p;
 extern void unwind_display_working_on_window (void);
 extern bool help_echo_showing_p;
@@ -3587,6 +3677,8 @@ #define TRY_WINDOW_IGNORE_FONTS_CHANGE	(1 << 1)
 void image_prune_animation_caches (bool);
 bool valid_image_p (Lisp_Object);
 void prepare_image_for_display (struct frame *, struct image *);
+void reset_image_load_time (void);
+void limit_image_caches (void);
 ptrdiff_t lookup_image (struct frame *, Lisp_Object, int);
 
 #if defined HAVE_X_WINDOWS || defined USE_CAIRO || defined HAVE_MACGUI || defined HAVE_NS \
@@ -3658,6 +3750,7 @@ #define RGB_PIXEL_COLOR COLORREF
 int merge_faces (struct window *, Lisp_Object, int, int);
 int compute_char_face (struct frame *, int, Lisp_Object);
 void free_all_realized_faces (Lisp_Object);
+void refresh_realized_faces (struct frame *);
 extern char unspecified_fg[], unspecified_bg[];
 
 /* Defined in xfns.c.  */
@@ -1283,22 +1283,12 @@ row_equal_p (struct glyph_row *a, struct glyph_row *b,
       if (mouse_face_p && a->mouse_face_p != b->mouse_face_p)
         return 0;
 
-      /* Compare glyphs.  */
+      /* Compare the number of glyphs and the other properties of the
+         rows before looking at the glyphs, which is expensive for
+         long rows.  */
       for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
-        {
-          if (a->used[area] != b->used[area])
-            return 0;
-
-          a_glyph = a->glyphs[area];
-          a_end = a_glyph + a->used[area];
-          b_glyph = b->glyphs[area];
-
-          while (a_glyph < a_end && GLYPH_EQUAL_P (a_glyph, b_glyph))
-            ++a_glyph, ++b_glyph;
-
-          if (a_glyph != a_end)
-            return 0;
-        }
+        if (a->used[area] != b->used[area])
+          return 0;
 
       if (a->fill_line_p != b->fill_line_p
           || a->cursor_in_fringe_p != b->cursor_in_fringe_p
@@ -1325,6 +1315,20 @@ row_equal_p (struct glyph_row *a, struct glyph_row *b,
           || a->phys_height != b->phys_height
           || a->visible_height != b->visible_height)
         return 0;
+
+      /* Compare glyphs.  */
+      for (area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+        {
+          a_glyph = a->glyphs[area];
+          a_end = a_glyph + a->used[area];
+          b_glyph = b->glyphs[area];
+
+          while (a_glyph < a_end && GLYPH_EQUAL_P (a_glyph, b_glyph))
+            ++a_glyph, ++b_glyph;
+
+          if (a_glyph != a_end)
+            return 0;
+        }
     }
 
   return 1;
@@ -3209,6 +3213,9 @@ update_frame (struct frame *f, bool force_p, bool inhibit_hairy_id_p)
   /* True means display has been paused because of pending input.  */
   bool paused_p;
   struct window *root_window = XWINDOW (f->root_window);
+  struct timespec update_start = current_timespec ();
+
+  redisplay_counters[RC_FRAME_UPDATES]++;
 
   if (redisplay_dont_pause)
     force_p = true;
@@ -3332,6 +3339,8 @@ update_frame (struct frame *f, bool force_p, bool inhibit_hairy_id_p)
   set_window_update_flags (root_window, false);
 
   display_completed = !paused_p;
+  redisplay_phase_seconds[RP_UPDATE]
+    += timespectod (timespec_sub (current_timespec (), update_start));
   return paused_p;
 }
 
@@ -4254,6 +4263,8 @@ update_window_line (struct window *w, int vpos,
   /* partial_p is true if not all of desired_row was drawn.  */
   bool changed_p = 0, partial_p = 0, was_stipple;
 
+  redisplay_counters[RC_ROWS_UPDATED]++;
+
   /* A row can be completely invisible in case a desired matrix was
      built with a vscroll and then make_cursor_line_fully_visible
      shifts the matrix.  Make sure to make such rows current anyway,
@@ -4499,6 +4510,21 @@ add_row_entry (struct glyph_row *row)
   return entry;
 }
 
+/* Insert RUN into the vector runs, which has NRUNS elements ordered
+   by copied pixel lines.  */
+
+static void
+insert_run (struct run *run, int nruns)
+{
+  int p, q;
+
+  for (p = 0; p < nruns && runs[p]->height > run->height; ++p)
+    ;
+  for (q = nruns; q > p; --q)
+    runs[q] = runs[q - 1];
+  runs[p] = run;
+}
+
 /* Try to reuse part of the current display of W by scrolling lines.
    HEADER_LINE_P means W has a header line.
 
@@ -4519,6 +4545,11 @@ add_row_entry (struct glyph_row *row)
    4. Starting from anchor lines, extend regions to be scrolled both
    forward and backward.
 
+   5. If there are no anchors, because the changed part of the
+   display consists of lines that are repeated, find the distance by
+   which most rows have moved, and scroll the regions of equal rows
+   at that distance.
+
    Value is
 
    -1	if all rows were found to be equal.
@@ -4781,18 +4812,63 @@ scrolling_window (struct window *w, int tab_line_p)
            be copied because they are already in place.  This is done
            because we can avoid calling update_window_line in this
            case.  */
-        for (p = 0; p < nruns && runs[p]->height > run->height; ++p)
-          ;
-        for (q = nruns; q > p; --q)
-          runs[q] = runs[q - 1];
-        runs[p] = run;
-        ++nruns;
+        insert_run (run, nruns++);
 
         i += run->nrows;
       }
     else
       ++i;
 
+  /* Without anchors, find the distance at which most rows of the
+     current matrix reappear in the desired matrix.  This is quadratic
+     in the number of rows, but cheap compared to redrawing them.  */
+  if (nruns == 0)
+    {
+      int offset, best_offset = 0, best_count = 1;
+
+      for (offset = first_new - (last_old - 1);
+           offset < last_new - first_old; ++offset)
+        {
+          int count = 0;
+
+          for (i = max (first_old, first_new - offset);
+               i < last_old && i + offset < last_new; ++i)
+            if (old_lines[i] && old_lines[i] == new_lines[i + offset])
+              ++count;
+
+          if (count > best_count)
+            best_count = count, best_offset = offset;
+        }
+
+      if (best_count > 1)
+        for (i = max (first_old, first_new - best_offset);
+             i < last_old && i + best_offset < last_new;)
+          if (old_lines[i] && old_lines[i] == new_lines[i + best_offset])
+            {
+              struct run *run = run_pool + run_idx++;
+
+              run->current_vpos = i;
+              run->current_y = MATRIX_ROW (current_matrix, i)->y;
+              run->desired_vpos = i + best_offset;
+              run->desired_y
+                = MATRIX_ROW (desired_matrix, i + best_offset)->y;
+              run->nrows = 0;
+              run->height = 0;
+              while (i < last_old && i + best_offset < last_new
+                     && old_lines[i]
+                     && old_lines[i] == new_lines[i + best_offset])
+                {
+                  ++run->nrows;
+                  run->height += MATRIX_ROW (current_matrix, i)->height;
+                  ++i;
+                }
+
+              insert_run (run, nruns++);
+            }
+          else
+            ++i;
+    }
+
   /* Do the moves.  Do it in a way that we don't overwrite something
      we want to copy later on.  This is not solvable in general
      because there is only one display and we don't have a way to
@@ -4817,6 +4893,7 @@ scrolling_window (struct window *w, int tab_line_p)
           {
             rif->clear_window_mouse_face (w);
             rif->scroll_run_hook (w, r);
+            redisplay_counters[RC_ROWS_MOVED] += r->nrows;
           }
 
         /* Truncate runs that copy to where we copied to, and
@@ -5260,6 +5337,8 @@ update_frame_line (struct frame *f, int vpos, bool updating_menu_p)
   if (colored_spaces_p)
     write_spaces_p = 1;
 
+  redisplay_counters[RC_ROWS_UPDATED]++;
+
   /* Current row not enabled means it has unknown contents.  We must
      write the whole desired line in that case.  */
   must_write_whole_line_p = !current_row->enabled_p;
@@ -2840,21 +2840,26 @@ save_restriction_restore (Lisp_Object data)
       eassert (buf == end->buffer);
 
       if (buf /* Verify marker still points to a buffer.  */
-	  && (beg->charpos != BUF_BEGV (buf) || end->charpos != BUF_ZV (buf)))
+	  && (marker_charpos (beg) != BUF_BEGV (buf)
+	      || marker_charpos (end) != BUF_ZV (buf)))
 	/* The restriction has changed from the saved one, so restore
 	   the saved restriction.  */
 	{
 	  ptrdiff_t pt = BUF_PT (buf);
+	  ptrdiff_t beg_charpos = marker_charpos (beg);
+	  ptrdiff_t beg_bytepos = marker_bytepos (beg);
+	  ptrdiff_t end_charpos = marker_charpos (end);
+	  ptrdiff_t end_bytepos = marker_bytepos (end);
 
-	  SET_BUF_BEGV_BOTH (buf, beg->charpos, beg->bytepos);
-	  SET_BUF_ZV_BOTH (buf, end->charpos, end->bytepos);
+	  SET_BUF_BEGV_BOTH (buf, beg_charpos, beg_bytepos);
+	  SET_BUF_ZV_BOTH (buf, end_charpos, end_bytepos);
 
-	  if (pt < beg->charpos || pt > end->charpos)
+	  if (pt < beg_charpos || pt > end_charpos)
 	    /* The point is outside the new visible range, move it inside. */
 	    SET_BUF_PT_BOTH (buf,
-			     clip_to_bounds (beg->charpos, pt, end->charpos),
-			     clip_to_bounds (beg->bytepos, BUF_PT_BYTE (buf),
-					     end->bytepos));
+			     clip_to_bounds (beg_charpos, pt, end_charpos),
+			     clip_to_bounds (beg_bytepos, BUF_PT_BYTE (buf),
+					     end_bytepos));
 
 	  buf->clip_changed = 1; /* Remember that the narrowing changed. */
 	}
@@ -4194,18 +4199,17 @@ transpose_markers (ptrdiff_t start1, ptrdiff_t end1,
 
   for (marker = BUF_MARKERS (current_buffer); marker; marker = marker->next)
     {
-      mpos = marker->bytepos;
-      if (mpos >= start1_byte && mpos < end2_byte)
+      ptrdiff_t mpos_byte = marker_bytepos (marker);
+      if (mpos_byte >= start1_byte && mpos_byte < end2_byte)
 	{
-	  if (mpos < end1_byte)
-	    mpos += amt1_byte;
-	  else if (mpos < start2_byte)
-	    mpos += diff_byte;
+	  if (mpos_byte < end1_byte)
+	    mpos_byte += amt1_byte;
+	  else if (mpos_byte < start2_byte)
+	    mpos_byte += diff_byte;
 	  else
-	    mpos -= amt2_byte;
-	  marker->bytepos = mpos;
+	    mpos_byte -= amt2_byte;
 	}
-      mpos = marker->charpos;
+      mpos = marker_charpos (marker);
       if (mpos >= start1 && mpos < end2)
 	{
 	  if (mpos < end1)
@@ -4215,7 +4219,7 @@ transpose_markers (ptrdiff_t start1, ptrdiff_t end1,
 	  else
 	    mpos -= amt2;
 	}
-      marker->charpos = mpos;
+      reposition_marker (marker, mpos, mpos_byte);
     }
 }
 
@@ -4511,6 +4515,12 @@ DEFUN ("transpose-regions", Ftranspose_regions, Stranspose_regions, 4, 5,
       update_compositions (end2 - len1, end2, CHECK_BORDER);
     }
 
+  /* The text between START1 and END2 has been rearranged, so forget
+     the correspondences recorded inside it.  */
+  adjust_position_index (current_buffer, start1,
+			 end2 - start1, end2_byte - start1_byte,
+			 end2 - start1, end2_byte - start1_byte);
+
   /* When doing multiple transpositions, it might be nice
      to optimize this.  Perhaps the markers in any one buffer
      should be organized in some sorted data tree.  */
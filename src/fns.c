@@ -23,6 +23,7 @@ Copyright (C) 1985-1987, 1993-1995, 1997-2022 Free Software Foundation,
 #include <stdlib.h>
 #include <sys/random.h>
 #include <unistd.h>
+#include <c-ctype.h>
 #include <filevercmp.h>
 #include <intprops.h>
 #include <vla.h>
@@ -332,6 +333,363 @@ DEFUN ("string-distance", Fstring_distance, Sstring_distance, 2, 3, 0,
   return make_fixnum (column[len1]);
 }
 
+/* Flex matching, after the algorithm of the fzf program.  */
+
+enum flex_char_class
+  {
+    FLEX_NONWORD,
+    FLEX_LOWER,
+    FLEX_UPPER,
+    FLEX_LETTER,
+    FLEX_NUMBER
+  };
+
+enum
+  {
+    FLEX_SCORE_MATCH = 16,
+    FLEX_SCORE_GAP_START = -3,
+    FLEX_SCORE_GAP_EXTENSION = -1,
+    /* Matching the first character of a word.  */
+    FLEX_BONUS_BOUNDARY = FLEX_SCORE_MATCH / 2,
+    /* Matching a character that separates words.  */
+    FLEX_BONUS_NONWORD = FLEX_SCORE_MATCH / 2,
+    /* Matching an upper case letter after a lower case one, or the
+       first digit of a number.  */
+    FLEX_BONUS_CAMEL = FLEX_BONUS_BOUNDARY + FLEX_SCORE_GAP_EXTENSION,
+    /* Matching a character right after another matched one.  */
+    FLEX_BONUS_CONSECUTIVE = -(FLEX_SCORE_GAP_START
+			       + FLEX_SCORE_GAP_EXTENSION),
+    /* The bonus of the first character of the pattern counts this many
+       times.  */
+    FLEX_BONUS_FIRST_CHAR_MULTIPLIER = 2
+  };
+
+static enum flex_char_class
+flex_char_class (int c)
+{
+  if (ASCII_CHAR_P (c))
+    return (c_islower (c) ? FLEX_LOWER
+	    : c_isupper (c) ? FLEX_UPPER
+	    : c_isdigit (c) ? FLEX_NUMBER
+	    : FLEX_NONWORD);
+  return (!alphanumericp (c) ? FLEX_NONWORD
+	  : lowercasep (c) ? FLEX_LOWER
+	  : uppercasep (c) ? FLEX_UPPER
+	  : FLEX_LETTER);
+}
+
+/* Return the bonus for matching a character of class CLASS after one
+   of class PREV.  */
+
+static int
+flex_bonus (enum flex_char_class prev, enum flex_char_class class)
+{
+  if (prev == FLEX_NONWORD && class != FLEX_NONWORD)
+    return FLEX_BONUS_BOUNDARY;
+  if ((prev == FLEX_LOWER && class == FLEX_UPPER)
+      || (prev != FLEX_NUMBER && class == FLEX_NUMBER))
+    return FLEX_BONUS_CAMEL;
+  if (class == FLEX_NONWORD)
+    return FLEX_BONUS_NONWORD;
+  return 0;
+}
+
+/* Return true if the PLEN ASCII characters of PATTERN occur in order
+   in the TLEN bytes of TEXT.  If IGNORE_CASE, PATTERN is in lower case
+   and upper case letters of TEXT match too.  This is a quick check
+   with memchr, made before matching the characters of candidates.  */
+
+static bool
+flex_ascii_subsequence_p (const unsigned char *pattern, ptrdiff_t plen,
+			  const unsigned char *text, ptrdiff_t tlen,
+			  bool ignore_case)
+{
+  const unsigned char *p = text, *end = text + tlen;
+
+  for (ptrdiff_t i = 0; i < plen; i++)
+    {
+      const unsigned char *q = memchr (p, pattern[i], end - p);
+
+      if (ignore_case && c_islower (pattern[i]))
+	{
+	  const unsigned char *q1 = memchr (p, c_toupper (pattern[i]),
+					    (q ? q : end) - p);
+	  if (q1)
+	    q = q1;
+	}
+      if (!q)
+	return false;
+      p = q + 1;
+    }
+  return true;
+}
+
+/* Match PATTERN, an array of PLEN characters, against TEXT, an array
+   of TLEN characters.  If IGNORE_CASE, PATTERN is in lower case and the
+   characters of TEXT are compared in lower case.  Return -1 if the
+   characters of PATTERN don't occur in order in TEXT, and the score of
+   the match otherwise.  If POSITIONS is non-null, store the positions
+   in TEXT of the characters of PATTERN in it.  */
+
+static int
+flex_match (const int *pattern, ptrdiff_t plen,
+	    const int *text, ptrdiff_t tlen, bool ignore_case,
+	    ptrdiff_t *positions)
+{
+  ptrdiff_t pidx = 0, start = -1, end = -1, idx;
+  int score = 0, first_bonus = 0;
+  bool in_gap = false, consecutive = false;
+  enum flex_char_class prev;
+
+  if (plen == 0)
+    return 0;
+
+  /* Find where the first occurrence of PATTERN ends.  */
+  for (idx = 0; idx < tlen; idx++)
+    if ((ignore_case ? downcase (text[idx]) : text[idx]) == pattern[pidx])
+      {
+	if (start < 0)
+	  start = idx;
+	if (++pidx == plen)
+	  {
+	    end = idx + 1;
+	    break;
+	  }
+      }
+  if (end < 0)
+    return -1;
+
+  /* Scan backward for the shortest occurrence ending there.  */
+  for (idx = end - 1, pidx = plen - 1; idx >= start; idx--)
+    if ((ignore_case ? downcase (text[idx]) : text[idx]) == pattern[pidx]
+	&& --pidx < 0)
+      {
+	start = idx;
+	break;
+      }
+
+  prev = start > 0 ? flex_char_class (text[start - 1]) : FLEX_NONWORD;
+  for (idx = start, pidx = 0; idx < end && pidx < plen; idx++)
+    {
+      int c = text[idx];
+      enum flex_char_class class = flex_char_class (c);
+
+      if ((ignore_case ? downcase (c) : c) == pattern[pidx])
+	{
+	  int bonus = flex_bonus (prev, class);
+
+	  if (positions)
+	    positions[pidx] = idx;
+	  score += FLEX_SCORE_MATCH;
+	  if (!consecutive)
+	    first_bonus = bonus;
+	  else
+	    {
+	      /* A run of consecutive matches gets the bonus of its first
+		 character, unless a better word boundary starts a new
+		 run.  */
+	      if (bonus >= FLEX_BONUS_BOUNDARY && bonus > first_bonus)
+		first_bonus = bonus;
+	      bonus = max (max (bonus, first_bonus), FLEX_BONUS_CONSECUTIVE);
+	    }
+	  score += (pidx == 0 ? bonus * FLEX_BONUS_FIRST_CHAR_MULTIPLIER
+		    : bonus);
+	  in_gap = false;
+	  consecutive = true;
+	  pidx++;
+	}
+      else
+	{
+	  score += in_gap ? FLEX_SCORE_GAP_EXTENSION : FLEX_SCORE_GAP_START;
+	  in_gap = true;
+	  consecutive = false;
+	  first_bonus = 0;
+	}
+      prev = class;
+    }
+
+  return score;
+}
+
+struct flex_result
+{
+  int score;
+  ptrdiff_t index;
+};
+
+/* Return true if A is a better match than B: it has a higher score,
+   or the same score and comes first.  */
+
+static bool
+flex_better_p (struct flex_result const *a, struct flex_result const *b)
+{
+  return a->score > b->score || (a->score == b->score && a->index < b->index);
+}
+
+static int
+flex_result_cmp (const void *a, const void *b)
+{
+  return (flex_better_p (a, b) ? -1 : flex_better_p (b, a) ? 1 : 0);
+}
+
+/* Add R to HEAP, an array of *NHEAP results ordered so that the worst
+   one comes first and no result is worse than its parent.  HEAP holds
+   at most SIZE results; when it is full, drop the worst one.  */
+
+static void
+flex_heap_add (struct flex_result *heap, ptrdiff_t *nheap, ptrdiff_t size,
+	       struct flex_result r)
+{
+  ptrdiff_t i;
+
+  if (*nheap < size)
+    {
+      for (i = (*nheap)++; i > 0 && flex_better_p (&heap[(i - 1) / 2], &r);
+	   i = (i - 1) / 2)
+	heap[i] = heap[(i - 1) / 2];
+      heap[i] = r;
+    }
+  else if (flex_better_p (&r, &heap[0]))
+    {
+      for (i = 0; 2 * i + 1 < size; )
+	{
+	  ptrdiff_t child = 2 * i + 1;
+
+	  if (child + 1 < size && flex_better_p (&heap[child], &heap[child + 1]))
+	    child++;
+	  if (!flex_better_p (&r, &heap[child]))
+	    break;
+	  heap[i] = heap[child];
+	  i = child;
+	}
+      heap[i] = r;
+    }
+}
+
+/* Store the characters of STRING in TEXT, in lower case if
+   IGNORE_CASE, and return their number.  */
+
+static ptrdiff_t
+flex_string_chars (Lisp_Object string, int *text, bool ignore_case)
+{
+  ptrdiff_t i = 0, i_byte = 0, n = 0;
+
+  while (i < SCHARS (string))
+    {
+      int c = fetch_string_char_advance (string, &i, &i_byte);
+      text[n++] = ignore_case ? downcase (c) : c;
+    }
+  return n;
+}
+
+DEFUN ("string-flex-match", Fstring_flex_match, Sstring_flex_match, 2, 4, 0,
+       doc: /* Return the strings in CANDIDATES that flex-match PATTERN, best first.
+A string flex-matches PATTERN if it contains the characters of PATTERN
+in order, possibly with other characters between them.  CANDIDATES
+is a list or vector of strings.
+
+The value is a list of elements of the form (STRING SCORE POSITIONS),
+one for each string in CANDIDATES that matches.  SCORE is an integer
+that is larger for better matches, and POSITIONS is the list of the
+positions of the characters of STRING matched by those of PATTERN.
+Characters matched consecutively and at the start of words score
+higher, and the start of a word counts twice for the first character
+of PATTERN; characters skipped between matched characters count
+against the match.  The elements are sorted by decreasing score, and
+elements with the same score are in the order of CANDIDATES.
+
+If LIMIT is non-nil, it should be a natural number; return only that
+many of the best matches.  If IGNORE-CASE is non-nil, ignore
+differences in letter-case.  Text properties are ignored.  */)
+  (Lisp_Object pattern, Lisp_Object candidates, Lisp_Object limit,
+   Lisp_Object ignore_case)
+{
+  bool fold = !NILP (ignore_case), ascii = true;
+  ptrdiff_t plen, tlen = 0, n, size, nresults = 0;
+  unsigned short int quit_count = 0;
+  int *pat, *text;
+  unsigned char *pat_bytes;
+  ptrdiff_t *positions;
+  struct flex_result *results;
+  Lisp_Object val = Qnil;
+  USE_SAFE_ALLOCA;
+
+  CHECK_STRING (pattern);
+  if (!VECTORP (candidates))
+    candidates = Fvconcat (1, &candidates);
+  n = ASIZE (candidates);
+  for (ptrdiff_t i = 0; i < n; i++)
+    {
+      CHECK_STRING (AREF (candidates, i));
+      tlen = max (tlen, SCHARS (AREF (candidates, i)));
+    }
+  if (NILP (limit))
+    size = n;
+  else
+    {
+      CHECK_FIXNAT (limit);
+      size = min (XFIXNAT (limit), n);
+    }
+
+  plen = SCHARS (pattern);
+  SAFE_NALLOCA (pat, 1, plen);
+  SAFE_NALLOCA (pat_bytes, 1, plen);
+  SAFE_NALLOCA (positions, 1, plen);
+  SAFE_NALLOCA (text, 1, tlen);
+  SAFE_NALLOCA (results, 1, size);
+  flex_string_chars (pattern, pat, fold);
+  for (ptrdiff_t i = 0; i < plen; i++)
+    {
+      ascii &= ASCII_CHAR_P (pat[i]);
+      pat_bytes[i] = pat[i];
+    }
+
+  for (ptrdiff_t i = 0; i < n && size > 0; i++)
+    {
+      Lisp_Object string = AREF (candidates, i);
+      struct flex_result r;
+
+      rarely_quit (++quit_count);
+
+      /* Bytes below 0x80 stand for ASCII characters in all strings,
+	 so the bytes of candidates can be searched for an ASCII
+	 pattern.  This doesn't work when ignoring case if a non-ASCII
+	 character could have an ASCII lower case.  */
+      if (ascii && (!fold || SCHARS (string) == SBYTES (string))
+	  && !flex_ascii_subsequence_p (pat_bytes, plen, SDATA (string),
+					SBYTES (string), fold))
+	continue;
+
+      r.score = flex_match (pat, plen, text,
+			    flex_string_chars (string, text, false),
+			    fold, NULL);
+      if (r.score < 0)
+	continue;
+      r.index = i;
+      if (NILP (limit))
+	results[nresults++] = r;
+      else
+	flex_heap_add (results, &nresults, size, r);
+    }
+
+  qsort (results, nresults, sizeof *results, flex_result_cmp);
+
+  for (ptrdiff_t i = nresults - 1; i >= 0; i--)
+    {
+      Lisp_Object string = AREF (candidates, results[i].index);
+      Lisp_Object pos = Qnil;
+
+      flex_match (pat, plen, text, flex_string_chars (string, text, false),
+		  fold, positions);
+      for (ptrdiff_t j = plen - 1; j >= 0; j--)
+	pos = Fcons (make_fixnum (positions[j]), pos);
+      val = Fcons (list3 (string, make_fixnum (results[i].score), pos), val);
+    }
+
+  SAFE_FREE ();
+  return val;
+}
+
 DEFUN ("string-equal", Fstring_equal, Sstring_equal, 2, 2, 0,
        doc: /* Return t if two strings have identical contents.
 Case is significant, but text properties are ignored.
@@ -2683,7 +3041,8 @@ internal_equal (Lisp_Object o1, Lisp_Object o2, enum equal_kind equal_kind,
 	  {
 	    return (XMARKER (o1)->buffer == XMARKER (o2)->buffer
 		    && (XMARKER (o1)->buffer == 0
-			|| XMARKER (o1)->bytepos == XMARKER (o2)->bytepos));
+			|| (marker_bytepos (XMARKER (o1))
+			    == marker_bytepos (XMARKER (o2)))));
 	  }
 #ifdef HAVE_MACGUI
 	/* Font-objects, which are subject to equality testing, may
@@ -2818,6 +3177,30 @@ nconc2 (Lisp_Object s1, Lisp_Object s2)
   return CALLN (Fnconc, s1, s2);
 }
 
+/* Return an alist that pairs the NCOUNTERS symbols whose indices are
+   in COUNTER_SYMBOLS with the integers in COUNTERS, followed by one
+   that pairs the NSECONDS symbols in SECONDS_SYMBOLS with the floats
+   in SECONDS.  The functions that report statistics kept in C, such
+   as `redisplay-statistics', return such alists.  */
+
+Lisp_Object
+statistics_alist (int ncounters, short const *counter_symbols,
+		  intmax_t const *counters, int nseconds,
+		  short const *seconds_symbols, double const *seconds)
+{
+  Lisp_Object val = Qnil;
+
+  for (int i = nseconds - 1; i >= 0; i--)
+    val = Fcons (Fcons (builtin_lisp_symbol (seconds_symbols[i]),
+			make_float (seconds[i])),
+		 val);
+  for (int i = ncounters - 1; i >= 0; i--)
+    val = Fcons (Fcons (builtin_lisp_symbol (counter_symbols[i]),
+			make_int (counters[i])),
+		 val);
+  return val;
+}
+
 DEFUN ("nconc", Fnconc, Snconc, 0, MANY, 0,
        doc: /* Concatenate any number of lists by altering them.
 Only the last argument is not altered, and need not be a list.
@@ -4984,7 +5367,7 @@ sxhash_obj (Lisp_Object obj, int depth)
 	else if (pvec_type == PVEC_MARKER)
 	  {
 	    ptrdiff_t bytepos
-	      = XMARKER (obj)->buffer ? XMARKER (obj)->bytepos : 0;
+	      = XMARKER (obj)->buffer ? marker_bytepos (XMARKER (obj)) : 0;
 	    EMACS_UINT hash
 	      = sxhash_combine ((intptr_t) XMARKER (obj)->buffer, bytepos);
 	    return SXHASH_REDUCE (hash);
@@ -6147,6 +6530,7 @@ syms_of_fns (void)
   defsubr (&Sproper_list_p);
   defsubr (&Sstring_bytes);
   defsubr (&Sstring_distance);
+  defsubr (&Sstring_flex_match);
   defsubr (&Sstring_equal);
   defsubr (&Scompare_strings);
   defsubr (&Sstring_lessp);
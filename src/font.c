@@ -2675,6 +2675,12 @@ font_clear_cache (struct frame *f, Lisp_Object cache,
   Lisp_Object entity;
   ptrdiff_t i;
 
+#ifdef HAVE_WINDOW_SYSTEM
+  /* The fonts found for fontsets can be among the entities freed
+     below.  */
+  clear_font_search_cache ();
+#endif
+
   /* CACHE = (DRIVER-TYPE NUM-FRAMES FONT-CACHE-DATA ...) */
   for (tail = XCDR (XCDR (cache)); CONSP (tail); tail = XCDR (tail))
     {
@@ -533,6 +533,124 @@ fontset_get_font_group (Lisp_Object fontset, int c)
   return font_group;
 }
 
+/* Cache of the fonts found for the font specs of fontsets.  A
+   realized fontset lives only as long as the faces it was realized
+   for, and so do the fonts found in it for each character; finding
+   a font lists the fonts of the system and scores them against the
+   face, which is slow.  This cache keeps the results of those
+   searches for all fontsets and frames.
+
+   The keys are vectors [FONT-SPEC TERMINAL DRIVERS RESOLUTION FAMILY
+   FOUNDRY SWIDTH WEIGHT SLANT HEIGHT ADSTYLE] of what the search
+   depends on, and the values are conses (ENTITY . CHAR-TABLE), where
+   ENTITY is the font found for any character and CHAR-TABLE holds
+   the fonts found for each character.  In both, nil means that no
+   search was done yet, and t that no font was found.  */
+
+static Lisp_Object font_search_cache;
+static Lisp_Object font_search_cache_key;
+
+/* Copies of the values of the user options that affect the search
+   when the cache was last flushed.  They are copies so that changes
+   made to the values in place are noticed as well.  The font family
+   alternatives and the font selection order can only be changed by
+   functions that flush the cache themselves.  */
+static Lisp_Object font_search_rescale_alist;
+static Lisp_Object font_search_ignored_fonts;
+
+enum font_search_counter
+  {
+    FS_LOOKUPS,
+    FS_HITS,
+    FS_NO_FONT_HITS,
+    FS_FLUSHES,
+    FS_MAX
+  };
+
+static intmax_t font_search_counters[FS_MAX];
+
+/* Forget all fonts found for fontsets.  Called when the font caches
+   of a display are cleared, and when the font family alternatives or
+   the font selection order change.  */
+
+void
+clear_font_search_cache (void)
+{
+  Fclrhash (font_search_cache);
+  font_search_rescale_alist = (CONSP (Vface_font_rescale_alist)
+			       ? Fcopy_alist (Vface_font_rescale_alist)
+			       : Vface_font_rescale_alist);
+  font_search_ignored_fonts = (CONSP (Vface_ignored_fonts)
+			       ? Fcopy_sequence (Vface_ignored_fonts)
+			       : Vface_ignored_fonts);
+  font_search_counters[FS_FLUSHES]++;
+}
+
+/* Like font_find_for_lface, but look up the font in
+   font_search_cache first, and record it there.  */
+
+static Lisp_Object
+font_find_for_lface_cached (struct frame *f, Lisp_Object *attrs,
+			    Lisp_Object spec, int c)
+{
+  Lisp_Object key = font_search_cache_key;
+  Lisp_Object drivers = Qnil, terminal, adstyle = Qnil;
+  Lisp_Object val, entity, hash;
+  struct Lisp_Hash_Table *h = XHASH_TABLE (font_search_cache);
+  struct font_driver_list *list;
+  ptrdiff_t i;
+
+  if (NILP (Fequal (font_search_rescale_alist, Vface_font_rescale_alist))
+      || NILP (Fequal (font_search_ignored_fonts, Vface_ignored_fonts)))
+    clear_font_search_cache ();
+
+  for (list = f->font_driver_list; list; list = list->next)
+    if (list->on)
+      drivers = Fcons (list->driver->type, drivers);
+  XSETTERMINAL (terminal, FRAME_TERMINAL (f));
+  if (FONTP (attrs[LFACE_FONT_INDEX]))
+    adstyle = AREF (attrs[LFACE_FONT_INDEX], FONT_ADSTYLE_INDEX);
+
+  ASET (key, 0, spec);
+  ASET (key, 1, terminal);
+  ASET (key, 2, drivers);
+  ASET (key, 3, make_float (FRAME_RES_Y (f)));
+  ASET (key, 4, attrs[LFACE_FAMILY_INDEX]);
+  ASET (key, 5, attrs[LFACE_FOUNDRY_INDEX]);
+  ASET (key, 6, attrs[LFACE_SWIDTH_INDEX]);
+  ASET (key, 7, attrs[LFACE_WEIGHT_INDEX]);
+  ASET (key, 8, attrs[LFACE_SLANT_INDEX]);
+  ASET (key, 9, attrs[LFACE_HEIGHT_INDEX]);
+  ASET (key, 10, adstyle);
+
+  i = hash_lookup (h, key, &hash);
+  if (i >= 0)
+    val = HASH_VALUE (h, i);
+  else
+    {
+      val = Fcons (Qnil, Fmake_char_table (Qnil, Qnil));
+      hash_put (h, Fcopy_sequence (key), val, hash);
+    }
+
+  font_search_counters[FS_LOOKUPS]++;
+  entity = c < 0 ? XCAR (val) : CHAR_TABLE_REF (XCDR (val), c);
+  if (!NILP (entity))
+    {
+      font_search_counters[FS_HITS]++;
+      if (!EQ (entity, Qt))
+	return entity;
+      font_search_counters[FS_NO_FONT_HITS]++;
+      return Qnil;
+    }
+
+  entity = font_find_for_lface (f, attrs, spec, c);
+  if (c < 0)
+    XSETCAR (val, NILP (entity) ? Qt : entity);
+  else
+    CHAR_TABLE_SET (XCDR (val), c, NILP (entity) ? Qt : entity);
+  return entity;
+}
+
 /* Return RFONT-DEF (vector) in the realized fontset FONTSET for the
    character C.  If no font is found, return Qnil or 0 if there's a
    possibility that the default fontset or the fallback font groups
@@ -657,8 +775,9 @@ fontset_find_font (Lisp_Object fontset, int c, struct face *face,
 	     the support of the character C.  That checking is costly,
 	     and even without the checking, the found font supports C
 	     in high possibility.  */
-	  font_entity = font_find_for_lface (f, face->lface,
-					     FONT_DEF_SPEC (font_def), -1);
+	  font_entity = font_find_for_lface_cached (f, face->lface,
+						    FONT_DEF_SPEC (font_def),
+						    -1);
 	  if (NILP (font_entity))
 	    {
 	      /* Record that no font matches the spec.  */
@@ -702,8 +821,8 @@ fontset_find_font (Lisp_Object fontset, int c, struct face *face,
 	}
 
       /* Find a font-entity with the current spec and supporting C.  */
-      font_entity = font_find_for_lface (f, face->lface,
-					 FONT_DEF_SPEC (font_def), c);
+      font_entity = font_find_for_lface_cached (f, face->lface,
+						FONT_DEF_SPEC (font_def), c);
       if (! NILP (font_entity))
 	{
 	  /* We found a font.  Open it and insert a new element for
@@ -2047,6 +2166,41 @@ DEFUN ("fontset-font", Ffontset_font, Sfontset_font, 2, 3, 0,
   return (Fnreverse (list));
 }
 
+DEFUN ("fontset-font-cache-statistics", Ffontset_font_cache_statistics,
+       Sfontset_font_cache_statistics, 0, 1, 0,
+       doc: /* Return an alist of counters kept by the cache of fonts of fontsets.
+The cache remembers the fonts found for the font specifications of
+fontsets, and for the characters displayed with them, across frames
+and faces.  Each element has the form (NAME . VALUE).  The counters
+are:
+
+  `lookups'       lookups of fonts for a font specification
+  `hits'          lookups that found the result of an earlier search
+  `no-font-hits'  hits that found that no font is available
+  `flushes'       times the cache was emptied, because the font caches
+                  of a display were cleared or because the value of
+                  `face-font-rescale-alist', `face-ignored-fonts',
+                  `face-font-family-alternatives' or
+                  `face-font-selection-order' changed
+
+If RESET is non-nil, reset all counters to zero after returning their
+values.  */)
+  (Lisp_Object reset)
+{
+  static short const counter_symbols[FS_MAX] =
+    {
+      SYMBOL_INDEX (Qlookups), SYMBOL_INDEX (Qhits),
+      SYMBOL_INDEX (Qno_font_hits), SYMBOL_INDEX (Qflushes)
+    };
+  Lisp_Object val = statistics_alist (FS_MAX, counter_symbols,
+				      font_search_counters, 0, NULL, NULL);
+
+  if (!NILP (reset))
+    memset (font_search_counters, 0, sizeof font_search_counters);
+
+  return val;
+}
+
 DEFUN ("fontset-list", Ffontset_list, Sfontset_list, 0, 0, 0,
        doc: /* Return a list of all defined fontset names.  */)
   (void)
@@ -2129,6 +2283,12 @@ syms_of_fontset (void)
   DEFSYM (Qappend, "append");
   DEFSYM (Qlatin, "latin");
 
+  /* Names of the elements of `fontset-font-cache-statistics'.  */
+  DEFSYM (Qlookups, "lookups");
+  DEFSYM (Qhits, "hits");
+  DEFSYM (Qno_font_hits, "no-font-hits");
+  DEFSYM (Qflushes, "flushes");
+
   Vcached_fontset_data = Qnil;
   staticpro (&Vcached_fontset_data);
 
@@ -2148,6 +2308,13 @@ syms_of_fontset (void)
   auto_fontset_alist = Qnil;
   staticpro (&auto_fontset_alist);
 
+  font_search_cache = CALLN (Fmake_hash_table, QCtest, Qequal);
+  staticpro (&font_search_cache);
+  font_search_cache_key = make_nil_vector (11);
+  staticpro (&font_search_cache_key);
+  staticpro (&font_search_rescale_alist);
+  staticpro (&font_search_ignored_fonts);
+
   DEFVAR_LISP ("font-encoding-charset-alist", Vfont_encoding_charset_alist,
 	       doc: /*
 Alist of charsets vs the charsets to determine the preferred font encoding.
@@ -2217,6 +2384,7 @@ syms_of_fontset (void)
   defsubr (&Sfontset_info);
   defsubr (&Sfontset_font);
   defsubr (&Sfontset_list);
+  defsubr (&Sfontset_font_cache_statistics);
 #ifdef ENABLE_CHECKING
   defsubr (&Sfontset_list_all);
 #endif
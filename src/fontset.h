@@ -44,5 +44,6 @@ #define EMACS_FONTSET_H
 extern Lisp_Object fontset_ascii (int);
 
 extern int face_for_font (struct frame *, Lisp_Object, struct face *);
+extern void clear_font_search_cache (void);
 
 #endif /* EMACS_FONTSET_H */
@@ -206,6 +206,26 @@ #define BLUE16_FROM_ULONG(color)	(BLUE_FROM_ULONG (color) * 0x101)
 static void anim_prune_animation_cache (Lisp_Object);
 #endif
 
+/* Number of bytes of image data in all image caches.  */
+static size_t image_cache_bytes;
+
+/* When the current or last redisplay started.  */
+static struct timespec image_redisplay_start;
+
+/* Statistics reported by `image-cache-statistics'.  */
+enum image_cache_counter
+  {
+    IC_LOOKUPS,
+    IC_HITS,
+    IC_EVICTIONS,
+    IC_EVICTED_BYTES,
+    IC_MAX
+  };
+
+static intmax_t image_cache_counters[IC_MAX];
+
+static void image_cache_account (struct image_cache *, struct image *);
+
 #if defined USE_CAIRO || defined HAVE_MACGUI
 
 #ifdef USE_CAIRO
@@ -1746,6 +1766,8 @@ free_image (struct frame *f, struct image *img)
 	img->next->prev = img->prev;
 
       c->images[img->id] = NULL;
+      c->bytes -= img->bytes;
+      image_cache_bytes -= img->bytes;
 
 #if !defined USE_CAIRO && defined HAVE_XRENDER
       if (img->picture)
@@ -1846,6 +1868,8 @@ prepare_image_for_display (struct frame *f, struct image *img)
 	}
     }
 #endif
+
+  image_cache_account (FRAME_IMAGE_CACHE (f), img);
 }
 
 
@@ -2169,6 +2193,7 @@ make_image_cache (void)
 
   c->size = 50;
   c->used = c->refcount = 0;
+  c->bytes = 0;
   c->images = xmalloc (c->size * sizeof *c->images);
   c->buckets = xzalloc (IMAGE_CACHE_BUCKETS_SIZE * sizeof *c->buckets);
   return c;
@@ -2496,20 +2521,202 @@ image_size_in_bytes (struct image *img)
   return size;
 }
 
-static size_t
-image_frame_cache_size (struct frame *f)
+/* Update the number of bytes counted for image IMG in the size of
+   the image cache C, and in the total size of all image caches.  */
+
+static void
+image_cache_account (struct image_cache *c, struct image *img)
 {
-  struct image_cache *c = FRAME_IMAGE_CACHE (f);
-  if (!c)
-    return 0;
+  size_t bytes = image_size_in_bytes (img);
 
-  size_t total = 0;
-  for (ptrdiff_t i = 0; i < c->used; ++i)
+  c->bytes += bytes - img->bytes;
+  image_cache_bytes += bytes - img->bytes;
+  img->bytes = bytes;
+}
+
+/* Return true if F is the first frame using its image cache.  */
+
+static bool
+first_frame_of_image_cache_p (struct frame *f)
+{
+  Lisp_Object tail, frame;
+
+  FOR_EACH_FRAME (tail, frame)
     {
-      struct image *img = c->images[i];
-      total += img ? image_size_in_bytes (img) : 0;
+      struct frame *f1 = XFRAME (frame);
+
+      if (FRAME_WINDOW_P (f1)
+	  && FRAME_IMAGE_CACHE (f1) == FRAME_IMAGE_CACHE (f))
+	return f1 == f;
+    }
+  return false;
+}
+
+struct cached_image
+{
+  struct frame *f;
+  struct image *img;
+};
+
+static int
+compare_cached_images_by_timestamp (const void *p1, const void *p2)
+{
+  const struct cached_image *c1 = p1, *c2 = p2;
+
+  return timespec_cmp (c1->img->timestamp, c2->img->timestamp);
+}
+
+/* Set the displayed_p flag of the images of frame F shown in glyph
+   matrix MATRIX to DISPLAYED_P.  */
+
+static void
+mark_images_in_matrix (struct frame *f, struct glyph_matrix *matrix,
+		       bool displayed_p)
+{
+  if (!matrix)
+    return;
+
+  for (int i = 0; i < matrix->nrows; i++)
+    {
+      struct glyph_row *row = MATRIX_ROW (matrix, i);
+
+      if (row->enabled_p)
+	for (int area = LEFT_MARGIN_AREA; area < LAST_AREA; area++)
+	  {
+	    struct glyph *glyph = row->glyphs[area];
+	    struct glyph *end = glyph + row->used[area];
+
+	    for (; glyph < end; glyph++)
+	      if (glyph->type == IMAGE_GLYPH)
+		{
+		  struct image *img = IMAGE_OPT_FROM_ID (f, glyph->u.img_id);
+
+		  if (img)
+		    img->displayed_p = displayed_p;
+		}
+	  }
+    }
+}
+
+/* Set the displayed_p flag of the images of frame F shown in the
+   current matrices of window W, its siblings and their children to
+   DISPLAYED_P.  */
+
+static void
+mark_images_in_windows (struct frame *f, struct window *w,
+			bool displayed_p)
+{
+  while (w)
+    {
+      if (WINDOWP (w->contents))
+	mark_images_in_windows (f, XWINDOW (w->contents), displayed_p);
+      else
+	mark_images_in_matrix (f, w->current_matrix, displayed_p);
+      w = NILP (w->next) ? NULL : XWINDOW (w->next);
     }
-  return total;
+}
+
+/* Set the displayed_p flag of all images shown in the current
+   matrices of window-system frames to DISPLAYED_P.  */
+
+static void
+mark_displayed_images (bool displayed_p)
+{
+  Lisp_Object tail, frame;
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+
+      if (FRAME_WINDOW_P (f) && FRAME_IMAGE_CACHE (f))
+	{
+	  mark_images_in_windows (f, XWINDOW (FRAME_ROOT_WINDOW (f)),
+				  displayed_p);
+	  if (WINDOWP (f->tab_bar_window))
+	    mark_images_in_matrix (f,
+				   XWINDOW (f->tab_bar_window)->current_matrix,
+				   displayed_p);
+#ifndef HAVE_EXT_TOOL_BAR
+	  if (WINDOWP (f->tool_bar_window))
+	    mark_images_in_matrix (f,
+				   XWINDOW (f->tool_bar_window)->current_matrix,
+				   displayed_p);
+#endif
+	}
+    }
+}
+
+/* Free the images that were displayed least recently, until the image
+   caches of all frames hold no more than image-cache-size-limit bytes
+   of image data.  Images displayed since the start of the last
+   redisplay are kept, and so are the images still shown in a current
+   glyph matrix, so that freeing images never forces the display to
+   be redrawn.  Called at the end of redisplay.  */
+
+void
+limit_image_caches (void)
+{
+  Lisp_Object tail, frame;
+  ptrdiff_t nimages = 0, i;
+  struct cached_image *images;
+  USE_SAFE_ALLOCA;
+
+  if (!FIXNATP (Vimage_cache_size_limit)
+      || image_cache_bytes <= XFIXNAT (Vimage_cache_size_limit))
+    return;
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+
+      if (FRAME_WINDOW_P (f) && FRAME_IMAGE_CACHE (f)
+	  && !f->inhibit_clear_image_cache
+	  && first_frame_of_image_cache_p (f))
+	nimages += FRAME_IMAGE_CACHE (f)->used;
+    }
+
+  SAFE_NALLOCA (images, 1, nimages);
+  nimages = 0;
+  mark_displayed_images (true);
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+
+      if (FRAME_WINDOW_P (f) && FRAME_IMAGE_CACHE (f)
+	  && !f->inhibit_clear_image_cache
+	  && first_frame_of_image_cache_p (f))
+	{
+	  struct image_cache *c = FRAME_IMAGE_CACHE (f);
+
+	  for (i = 0; i < c->used; i++)
+	    if (c->images[i] && c->images[i]->bytes > 0
+		&& !c->images[i]->displayed_p
+		&& timespec_cmp (c->images[i]->timestamp,
+				 image_redisplay_start) < 0)
+	      {
+		images[nimages].f = f;
+		images[nimages].img = c->images[i];
+		nimages++;
+	      }
+	}
+    }
+  mark_displayed_images (false);
+
+  qsort (images, nimages, sizeof *images,
+	 compare_cached_images_by_timestamp);
+
+  block_input ();
+  for (i = 0;
+       i < nimages && image_cache_bytes > XFIXNAT (Vimage_cache_size_limit);
+       i++)
+    {
+      image_cache_counters[IC_EVICTIONS]++;
+      image_cache_counters[IC_EVICTED_BYTES] += images[i].img->bytes;
+      free_image (images[i].f, images[i].img);
+    }
+  unblock_input ();
+
+  SAFE_FREE ();
 }
 
 DEFUN ("image-flush", Fimage_flush, Simage_flush,
@@ -3170,6 +3377,139 @@ image_set_transform (struct frame *f, struct image *img)
 
 #endif /* HAVE_IMAGEMAGICK || HAVE_NATIVE_TRANSFORMS */
 
+/* Seconds spent loading images during the current redisplay.  */
+static double image_load_seconds;
+
+/* True if redisplay deferred loading an image since the last call to
+   Fimage_display_deferred.  */
+static bool image_loads_deferred;
+
+/* Called at the start of each redisplay.  */
+
+void
+reset_image_load_time (void)
+{
+  image_load_seconds = 0;
+  image_redisplay_start = current_timespec ();
+}
+
+/* Return true if loading images should be deferred, because the
+   current redisplay spent image-load-time-limit loading images.  */
+
+static bool
+defer_image_load_p (void)
+{
+  return (redisplaying_p
+	  && NUMBERP (Vimage_load_time_limit)
+	  && image_load_seconds >= XFLOATINT (Vimage_load_time_limit));
+}
+
+/* Load image IMG for display on frame F, and handle the image type
+   independent image attributes.  BACKGROUND is the background color
+   of the face IMG is displayed with.  If loading images is being
+   deferred, only prepare IMG to be displayed as an empty rectangle,
+   and arrange for it to be loaded when Emacs is idle.  */
+
+static void
+lookup_image_load (struct frame *f, struct image *img,
+		   unsigned long background)
+{
+  Lisp_Object spec = img->spec;
+
+  img->load_deferred_p = defer_image_load_p ();
+  if (img->load_deferred_p)
+    {
+      img->load_failed_p = true;
+      if (!image_loads_deferred)
+	{
+	  image_loads_deferred = true;
+	  pending_funcalls = Fcons (list1 (Qimage__display_deferred),
+				    pending_funcalls);
+	}
+    }
+  else
+    {
+      struct timespec start = current_timespec ();
+
+      img->load_failed_p = ! img->type->load_img (f, img);
+      if (redisplaying_p)
+	image_load_seconds
+	  += timespectod (timespec_sub (current_timespec (), start));
+    }
+
+  /* If we can't load the image, and we don't have a width and
+     height, use some arbitrary width and height so that we can draw
+     a rectangle for it.  */
+  if (img->load_failed_p)
+    {
+      Lisp_Object value;
+
+      value = image_spec_value (spec, QCwidth, NULL);
+      img->width = (FIXNUMP (value)
+		    ? XFIXNAT (value) : DEFAULT_IMAGE_WIDTH);
+      value = image_spec_value (spec, QCheight, NULL);
+      img->height = (FIXNUMP (value)
+		     ? XFIXNAT (value) : DEFAULT_IMAGE_HEIGHT);
+    }
+  else
+    {
+      /* Handle image type independent image attributes
+	 `:ascent ASCENT', `:margin MARGIN', `:relief RELIEF',
+	 `:background COLOR'.  */
+      Lisp_Object ascent, margin, relief, bg;
+      int relief_bound;
+
+      ascent = image_spec_value (spec, QCascent, NULL);
+      if (FIXNUMP (ascent))
+	img->ascent = XFIXNUM (ascent);
+      else if (EQ (ascent, Qcenter))
+	img->ascent = CENTERED_IMAGE_ASCENT;
+
+      margin = image_spec_value (spec, QCmargin, NULL);
+      if (FIXNUMP (margin))
+	img->vmargin = img->hmargin = XFIXNUM (margin);
+      else if (CONSP (margin))
+	{
+	  img->hmargin = XFIXNUM (XCAR (margin));
+	  img->vmargin = XFIXNUM (XCDR (margin));
+	}
+
+      relief = image_spec_value (spec, QCrelief, NULL);
+      relief_bound = INT_MAX - max (img->hmargin, img->vmargin);
+      if (RANGED_FIXNUMP (- relief_bound, relief, relief_bound))
+	{
+	  img->relief = XFIXNUM (relief);
+	  img->hmargin += eabs (img->relief);
+	  img->vmargin += eabs (img->relief);
+	}
+
+      if (! img->background_valid)
+	{
+	  bg = image_spec_value (img->spec, QCbackground, NULL);
+	  if (!NILP (bg))
+	    {
+	      img->background
+		= image_alloc_image_color (f, img, bg, background);
+	      img->background_valid = 1;
+	    }
+	}
+
+      /* Do image transformations and compute masks, unless we
+	 don't have the image yet.  */
+      if (!EQ (builtin_lisp_symbol (img->type->type), Qpostscript))
+	postprocess_image (f, img);
+
+      /* postprocess_image above may modify the image or the mask,
+	 relying on the image's real width and height, so
+	 image_set_transform must be called after it.  */
+#ifdef HAVE_NATIVE_TRANSFORMS
+      image_set_transform (f, img);
+#endif
+    }
+
+  image_cache_account (FRAME_IMAGE_CACHE (f), img);
+}
+
 /* Return the id of image with Lisp specification SPEC on frame F.
    SPEC must be a valid Lisp image specification (see valid_image_p).  */
 
@@ -3201,7 +3541,21 @@ lookup_image (struct frame *f, Lisp_Object spec, int face_id)
   hash = sxhash (filter_image_spec (spec));
   img = search_image_cache (f, spec, hash, foreground, background,
 			    font_size, font_family, false);
-  if (img && img->load_failed_p)
+  image_cache_counters[IC_LOOKUPS]++;
+  if (img && !img->load_failed_p)
+    image_cache_counters[IC_HITS]++;
+  if (img && img->load_deferred_p)
+    {
+      /* Load an image whose loading was deferred, if there's time
+	 for that now.  */
+      if (!defer_image_load_p ())
+	{
+	  block_input ();
+	  lookup_image_load (f, img, background);
+	  unblock_input ();
+	}
+    }
+  else if (img && img->load_failed_p)
     {
       free_image (f, img);
       img = NULL;
@@ -3218,78 +3572,7 @@ lookup_image (struct frame *f, Lisp_Object spec, int face_id)
       img->face_font_size = font_size;
       img->face_font_family = xmalloc (strlen (font_family) + 1);
       strcpy (img->face_font_family, font_family);
-      img->load_failed_p = ! img->type->load_img (f, img);
-
-      /* If we can't load the image, and we don't have a width and
-	 height, use some arbitrary width and height so that we can
-	 draw a rectangle for it.  */
-      if (img->load_failed_p)
-	{
-	  Lisp_Object value;
-
-	  value = image_spec_value (spec, QCwidth, NULL);
-	  img->width = (FIXNUMP (value)
-			? XFIXNAT (value) : DEFAULT_IMAGE_WIDTH);
-	  value = image_spec_value (spec, QCheight, NULL);
-	  img->height = (FIXNUMP (value)
-			 ? XFIXNAT (value) : DEFAULT_IMAGE_HEIGHT);
-	}
-      else
-	{
-	  /* Handle image type independent image attributes
-	     `:ascent ASCENT', `:margin MARGIN', `:relief RELIEF',
-	     `:background COLOR'.  */
-	  Lisp_Object ascent, margin, relief, bg;
-	  int relief_bound;
-
-	  ascent = image_spec_value (spec, QCascent, NULL);
-	  if (FIXNUMP (ascent))
-	    img->ascent = XFIXNUM (ascent);
-	  else if (EQ (ascent, Qcenter))
-	    img->ascent = CENTERED_IMAGE_ASCENT;
-
-	  margin = image_spec_value (spec, QCmargin, NULL);
-	  if (FIXNUMP (margin))
-	    img->vmargin = img->hmargin = XFIXNUM (margin);
-	  else if (CONSP (margin))
-	    {
-	      img->hmargin = XFIXNUM (XCAR (margin));
-	      img->vmargin = XFIXNUM (XCDR (margin));
-	    }
-
-	  relief = image_spec_value (spec, QCrelief, NULL);
-	  relief_bound = INT_MAX - max (img->hmargin, img->vmargin);
-	  if (RANGED_FIXNUMP (- relief_bound, relief, relief_bound))
-	    {
-	      img->relief = XFIXNUM (relief);
-	      img->hmargin += eabs (img->relief);
-	      img->vmargin += eabs (img->relief);
-	    }
-
-	  if (! img->background_valid)
-	    {
-	      bg = image_spec_value (img->spec, QCbackground, NULL);
-	      if (!NILP (bg))
-		{
-		  img->background
-		    = image_alloc_image_color (f, img, bg, background);
-		  img->background_valid = 1;
-		}
-	    }
-
-	  /* Do image transformations and compute masks, unless we
-	     don't have the image yet.  */
-	  if (!EQ (builtin_lisp_symbol (img->type->type), Qpostscript))
-	    postprocess_image (f, img);
-
-          /* postprocess_image above may modify the image or the mask,
-             relying on the image's real width and height, so
-             image_set_transform must be called after it.  */
-#ifdef HAVE_NATIVE_TRANSFORMS
-          image_set_transform (f, img);
-#endif
-	}
-
+      lookup_image_load (f, img, background);
       unblock_input ();
     }
 
@@ -3300,6 +3583,41 @@ lookup_image (struct frame *f, Lisp_Object spec, int face_id)
   return img->id;
 }
 
+DEFUN ("image-display-deferred", Fimage_display_deferred,
+       Simage_display_deferred, 0, 0, 0,
+       doc: /* Arrange for images whose loading was deferred to be displayed.
+Redisplay defers loading images, and displays empty rectangles in
+their place, once it has spent `image-load-time-limit' seconds loading
+images.  If it did so since the last call of this function, mark the
+frames that display such images for redisplay, which loads them as
+time permits, and return non-nil.  Otherwise, return nil.  */)
+  (void)
+{
+  Lisp_Object tail, frame;
+
+  if (!image_loads_deferred)
+    return Qnil;
+  image_loads_deferred = false;
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+      struct image_cache *c = FRAME_IMAGE_CACHE (f);
+
+      if (FRAME_WINDOW_P (f) && c)
+	for (ptrdiff_t i = 0; i < c->used; i++)
+	  if (c->images[i] && c->images[i]->load_deferred_p)
+	    {
+	      /* The glyphs of the loaded images can be equal to those
+		 of the empty rectangles, so redraw everything.  */
+	      SET_FRAME_GARBAGED (f);
+	      break;
+	    }
+    }
+
+  return Qt;
+}
+
 
 /* Cache image IMG in the image cache of frame F.  */
 
@@ -13622,12 +13940,7 @@ DEFUN ("image-cache-size", Fimage_cache_size, Simage_cache_size, 0, 0, 0,
        doc: /* Return the size of the image cache.  */)
   (void)
 {
-  Lisp_Object tail, frame;
-  size_t total = 0;
-
-  FOR_EACH_FRAME (tail, frame)
-    if (FRAME_WINDOW_P (XFRAME (frame)))
-      total += image_frame_cache_size (XFRAME (frame));
+  size_t total = image_cache_bytes;
 
 #if defined (HAVE_WEBP) || defined (HAVE_GIF)
   struct anim_cache *pcache = anim_cache;
@@ -13641,6 +13954,58 @@ DEFUN ("image-cache-size", Fimage_cache_size, Simage_cache_size, 0, 0, 0,
   return make_int (total);
 }
 
+DEFUN ("image-cache-statistics", Fimage_cache_statistics,
+       Simage_cache_statistics, 0, 1, 0,
+       doc: /* Return an alist of statistics about the image caches.
+The alist has these elements:
+
+  `bytes'          Bytes of image data currently cached.
+  `images'         Number of images currently cached.
+  `lookups'        Number of times an image was looked up in a cache.
+  `hits'           Number of lookups that found a loaded image.
+  `evictions'      Number of images freed to stay within
+                   `image-cache-size-limit'.
+  `evicted-bytes'  Bytes of image data freed by those evictions.
+
+If RESET is non-nil, reset the counters to zero after returning them.
+`bytes' and `images' describe the current contents of the caches and
+are not affected by RESET.  */)
+  (Lisp_Object reset)
+{
+  static short const counter_symbols[IC_MAX] =
+    {
+      SYMBOL_INDEX (Qlookups), SYMBOL_INDEX (Qhits),
+      SYMBOL_INDEX (Qevictions), SYMBOL_INDEX (Qevicted_bytes)
+    };
+  Lisp_Object tail, frame, val;
+  intmax_t images = 0;
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+
+      if (FRAME_WINDOW_P (f) && FRAME_IMAGE_CACHE (f)
+	  && first_frame_of_image_cache_p (f))
+	{
+	  struct image_cache *c = FRAME_IMAGE_CACHE (f);
+
+	  for (ptrdiff_t i = 0; i < c->used; i++)
+	    if (c->images[i])
+	      images++;
+	}
+    }
+
+  val = statistics_alist (IC_MAX, counter_symbols, image_cache_counters,
+			  0, NULL, NULL);
+  val = Fcons (Fcons (Qimages, make_int (images)), val);
+  val = Fcons (Fcons (Qbytes, make_uint (image_cache_bytes)), val);
+
+  if (!NILP (reset))
+    memset (image_cache_counters, 0, sizeof image_cache_counters);
+
+  return val;
+}
+
 
 DEFUN ("init-image-library", Finit_image_library, Sinit_image_library, 1, 1, 0,
        doc: /* Initialize image library implementing image type TYPE.
@@ -13834,6 +14199,14 @@ syms_of_image (void)
 
   DEFSYM (Qem, "em");
 
+  /* Names of the elements of `image-cache-statistics'.  */
+  DEFSYM (Qbytes, "bytes");
+  DEFSYM (Qimages, "images");
+  DEFSYM (Qlookups, "lookups");
+  DEFSYM (Qhits, "hits");
+  DEFSYM (Qevictions, "evictions");
+  DEFSYM (Qevicted_bytes, "evicted-bytes");
+
 #ifdef HAVE_NATIVE_TRANSFORMS
   DEFSYM (Qscale, "scale");
   DEFSYM (Qrotate, "rotate");
@@ -13973,11 +14346,13 @@ syms_of_image (void)
   defsubr (&Simage_io_types);
 #endif
   defsubr (&Sclear_image_cache);
+  defsubr (&Simage_display_deferred);
   defsubr (&Simage_flush);
   defsubr (&Simage_size);
   defsubr (&Simage_mask_p);
   defsubr (&Simage_metadata);
   defsubr (&Simage_cache_size);
+  defsubr (&Simage_cache_statistics);
   defsubr (&Simagep);
 
 #ifdef GLYPH_DEBUG
@@ -14010,6 +14385,28 @@ syms_of_image (void)
 
 The function `clear-image-cache' disregards this variable.  */);
   Vimage_cache_eviction_delay = make_fixnum (300);
+
+  DEFVAR_LISP ("image-load-time-limit", Vimage_load_time_limit,
+    doc: /* Seconds that a redisplay may spend loading images, or nil.
+If non-nil, once a redisplay has spent this much time loading images,
+it displays the images that it would load after that as empty
+rectangles.  Those images are loaded by later redisplays when Emacs is
+idle, in turns of at most this many seconds, so that user input is
+handled between them.  If nil, redisplay loads all images it displays
+at once.  */);
+  Vimage_load_time_limit = Qnil;
+  DEFSYM (Qimage__display_deferred, "image--display-deferred");
+
+  DEFVAR_LISP ("image-cache-size-limit", Vimage_cache_size_limit,
+    doc: /* Maximum number of bytes of image data to keep in image caches.
+If non-nil, this should be a natural number.  At the end of each
+redisplay, when the decoded images in the image caches of all frames
+use more memory than this, the images that were displayed least
+recently are freed until they fit, except for images displayed by
+that redisplay.  Freed images are loaded again when they are next
+displayed.  If nil, images are only freed after they have not been
+displayed for `image-cache-eviction-delay' seconds.  */);
+  Vimage_cache_size_limit = Qnil;
 #ifdef HAVE_IMAGEMAGICK
   DEFVAR_INT ("imagemagick-render-type", imagemagick_render_type,
     doc: /* Integer indicating which ImageMagick rendering method to use.
@@ -30,6 +30,7 @@
 #include "disptab.h"
 #include "intervals.h"
 #include "dispextern.h"
+#include "termhooks.h"
 #include "region-cache.h"
 
 #define CR 015
@@ -189,6 +190,517 @@ width_run_cache_on_off (void)
     }
 }
 
+
+/* Column checkpoints.
+
+   Within long lines, scan_for_column records every so often the
+   column it has reached, so that later scans of the same line can
+   start from the nearest such checkpoint instead of the beginning of
+   the line.  A checkpoint is only recorded where the scan could be
+   restarted from scratch: not within invisible text, a display
+   property, or a composition.
+
+   Likewise, compute_motion records where it is on the screen every so
+   often as it lays out a long line from its beginning, so that
+   vertical-motion can find the screen lines near point without laying
+   out the whole line before them each time.  The display engine
+   records display checkpoints for the same purpose; see
+   record_display_checkpoint in xdisp.c.
+
+   The checkpoints live in the base buffer, like width_run_cache, and
+   are valid for the buffer, window and display settings recorded in
+   the cache; if any of those changes, they are all discarded.  The
+   char-tables among those settings can also change in place, so the
+   checkpoints are discarded as well whenever char_table_modiff says
+   that one of them has changed.  A display table entry, which is a
+   vector of glyphs, can still be modified without that being noticed.
+   Changes to the text, to overlays, and to text properties that affect
+   display discard those at or after the change.  */
+
+struct column_checkpoint
+{
+  /* The beginning of the line, and the checkpoint's position.  */
+  ptrdiff_t line_beg, charpos, bytepos;
+
+  /* The column at CHARPOS.  */
+  ptrdiff_t col;
+};
+
+struct motion_checkpoint
+{
+  /* Where compute_motion started, at the beginning of a line, and the
+     checkpoint's position.  */
+  ptrdiff_t from, charpos, bytepos;
+
+  /* The screen position at CHARPOS, relative to FROM, and the tab
+     offset there.  */
+  EMACS_INT vpos, hpos;
+  int tab_offset;
+};
+
+struct column_cache
+{
+  /* The buffer the columns are for, which differs from the one holding
+     the cache if it is indirect, and the settings that affect them.  */
+  Lisp_Object buffer, window, display_table, standard_display_table;
+  Lisp_Object invisibility_spec, selective_display, char_width_table;
+  Lisp_Object composition_function_table, auto_composition_mode;
+  EMACS_UINT char_table_modiff;
+  int tab_width;
+  bool ctl_arrow;
+
+  /* The checkpoints, sorted by position.  */
+  ptrdiff_t count, size;
+  struct column_checkpoint *checkpoints;
+
+  /* The width of the screen lines the motion checkpoints are for, the
+     settings that affect them besides those above, and the motion
+     checkpoints sorted by position.  */
+  EMACS_INT motion_width;
+  Lisp_Object window_display_table, truncate_lines;
+  Lisp_Object truncate_partial_width_windows;
+  EMACS_UINT window_display_table_modiff;
+  ptrdiff_t motion_count, motion_size;
+  struct motion_checkpoint *motion_checkpoints;
+
+  /* Likewise for the display checkpoints: the settings besides those
+     above that affect them, and the display checkpoints sorted by
+     position.  */
+  Lisp_Object display_window_display_table, glyphless_char_display;
+  Lisp_Object nobreak_char_display, terminal, terminal_charset_list;
+  Lisp_Object terminal_glyph_code_table, line_prefix, wrap_prefix;
+  Lisp_Object bidi_paragraph_start_re, bidi_paragraph_separate_re;
+  EMACS_UINT display_modiff;
+  int first_visible_x, last_visible_x;
+  enum line_wrap_method line_wrap;
+  bidi_dir_t paragraph_embedding;
+  bool bidi_p, inhibit_bpa;
+  ptrdiff_t display_count, display_size;
+  struct display_checkpoint *display_checkpoints;
+};
+
+/* Return the larger of MODIFF and the modification count of TABLE,
+   if it is a char-table.  */
+
+static EMACS_UINT
+max_char_table_modiff (EMACS_UINT modiff, Lisp_Object table)
+{
+  return (CHAR_TABLE_P (table)
+	  ? max (modiff, char_table_modiff (table))
+	  : modiff);
+}
+
+/* Return the column cache of the current buffer, for columns as
+   displayed in WINDOW, emptying it if it was for something else.
+   Return NULL if the buffer does not cache long scans.  */
+
+static struct column_cache *
+column_cache_for (Lisp_Object window)
+{
+  struct buffer *b = current_buffer;
+  struct buffer *cache_buffer = b->base_buffer ? b->base_buffer : b;
+  struct column_cache *cache = cache_buffer->column_cache;
+  Lisp_Object buffer;
+
+  XSETBUFFER (buffer, b);
+
+  if (NILP (BVAR (b, cache_long_scans)))
+    return NULL;
+
+  EMACS_UINT modiff = 0;
+  modiff = max_char_table_modiff (modiff, BVAR (b, display_table));
+  modiff = max_char_table_modiff (modiff, Vstandard_display_table);
+  modiff = max_char_table_modiff (modiff, Vchar_width_table);
+  modiff = max_char_table_modiff (modiff, Vcomposition_function_table);
+
+  if (!cache)
+    {
+      cache = xzalloc (sizeof *cache);
+      cache_buffer->column_cache = cache;
+    }
+  else if (EQ (cache->buffer, buffer)
+	   && EQ (cache->window, window)
+	   && EQ (cache->display_table, BVAR (b, display_table))
+	   && EQ (cache->standard_display_table, Vstandard_display_table)
+	   && !NILP (Fequal (cache->invisibility_spec,
+			     BVAR (b, invisibility_spec)))
+	   && EQ (cache->selective_display, BVAR (b, selective_display))
+	   && EQ (cache->char_width_table, Vchar_width_table)
+	   && EQ (cache->composition_function_table,
+		  Vcomposition_function_table)
+	   && EQ (cache->auto_composition_mode, Vauto_composition_mode)
+	   && cache->char_table_modiff == modiff
+	   && cache->tab_width == SANE_TAB_WIDTH (b)
+	   && cache->ctl_arrow == !NILP (BVAR (b, ctl_arrow)))
+    return cache;
+
+  cache->buffer = buffer;
+  cache->window = window;
+  cache->display_table = BVAR (b, display_table);
+  cache->standard_display_table = Vstandard_display_table;
+  /* remove-from-invisibility-spec changes the list in place.  */
+  cache->invisibility_spec = (CONSP (BVAR (b, invisibility_spec))
+			      ? Fcopy_sequence (BVAR (b, invisibility_spec))
+			      : BVAR (b, invisibility_spec));
+  cache->selective_display = BVAR (b, selective_display);
+  cache->char_width_table = Vchar_width_table;
+  cache->composition_function_table = Vcomposition_function_table;
+  cache->auto_composition_mode = Vauto_composition_mode;
+  cache->char_table_modiff = modiff;
+  cache->tab_width = SANE_TAB_WIDTH (b);
+  cache->ctl_arrow = !NILP (BVAR (b, ctl_arrow));
+  cache->count = 0;
+  cache->motion_count = 0;
+  cache->display_count = 0;
+  return cache;
+}
+
+/* Return the index of the first checkpoint in CACHE at or after
+   CHARPOS.  */
+
+static ptrdiff_t
+column_checkpoint_index (struct column_cache *cache, ptrdiff_t charpos)
+{
+  ptrdiff_t lo = 0, hi = cache->count;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      if (cache->checkpoints[mid].charpos < charpos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Return the last checkpoint in CACHE of the line starting at
+   LINE_BEG that is before END and whose column is less than GOAL, or
+   NULL if there is none.  */
+
+static struct column_checkpoint *
+find_column_checkpoint (struct column_cache *cache, ptrdiff_t line_beg,
+			ptrdiff_t end, EMACS_INT goal)
+{
+  ptrdiff_t i = column_checkpoint_index (cache, end);
+
+  while (0 < i && cache->checkpoints[i - 1].line_beg == line_beg)
+    {
+      struct column_checkpoint *cp = &cache->checkpoints[--i];
+      if (cp->col < goal)
+	return cp;
+    }
+  return NULL;
+}
+
+/* Record in CACHE that the column at CHARPOS, BYTEPOS, in the line
+   starting at LINE_BEG, is COL.  */
+
+static void
+add_column_checkpoint (struct column_cache *cache, ptrdiff_t line_beg,
+		       ptrdiff_t charpos, ptrdiff_t bytepos, ptrdiff_t col)
+{
+  ptrdiff_t i = column_checkpoint_index (cache, charpos);
+
+  if (i < cache->count && cache->checkpoints[i].charpos == charpos)
+    return;
+  if (cache->count == cache->size)
+    cache->checkpoints = xpalloc (cache->checkpoints, &cache->size, 1, -1,
+				  sizeof *cache->checkpoints);
+  memmove (&cache->checkpoints[i + 1], &cache->checkpoints[i],
+	   (cache->count - i) * sizeof *cache->checkpoints);
+  cache->checkpoints[i] = (struct column_checkpoint)
+    { .line_beg = line_beg, .charpos = charpos, .bytepos = bytepos,
+      .col = col };
+  cache->count++;
+}
+
+/* Return the column cache of the current buffer if it can hold motion
+   checkpoints for screen lines WIDTH columns wide in window W, emptying
+   the motion checkpoints if they were for something else.  */
+
+static struct column_cache *
+motion_cache_for (struct window *w, EMACS_INT width)
+{
+  Lisp_Object window;
+  XSETWINDOW (window, w);
+  struct column_cache *cache = column_cache_for (window);
+  EMACS_UINT modiff = max_char_table_modiff (0, w->display_table);
+
+  if (cache
+      && ! (cache->motion_width == width
+	    && EQ (cache->window_display_table, w->display_table)
+	    && cache->window_display_table_modiff == modiff
+	    && EQ (cache->truncate_lines, BVAR (current_buffer, truncate_lines))
+	    && EQ (cache->truncate_partial_width_windows,
+		   Vtruncate_partial_width_windows)))
+    {
+      cache->motion_width = width;
+      cache->window_display_table = w->display_table;
+      cache->window_display_table_modiff = modiff;
+      cache->truncate_lines = BVAR (current_buffer, truncate_lines);
+      cache->truncate_partial_width_windows = Vtruncate_partial_width_windows;
+      cache->motion_count = 0;
+    }
+  return cache;
+}
+
+/* Return the index of the first motion checkpoint in CACHE at or after
+   CHARPOS.  */
+
+static ptrdiff_t
+motion_checkpoint_index (struct column_cache *cache, ptrdiff_t charpos)
+{
+  ptrdiff_t lo = 0, hi = cache->motion_count;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      if (cache->motion_checkpoints[mid].charpos < charpos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Return the last motion checkpoint in CACHE of a layout starting at
+   FROM that is at or before TO and above or to the left of the screen
+   position TOVPOS, TOHPOS relative to FROM, or NULL if there is
+   none.  */
+
+static struct motion_checkpoint *
+find_motion_checkpoint (struct column_cache *cache, ptrdiff_t from,
+			ptrdiff_t to, EMACS_INT tovpos, EMACS_INT tohpos)
+{
+  ptrdiff_t i = motion_checkpoint_index (cache, to + 1);
+
+  while (0 < i && from <= cache->motion_checkpoints[i - 1].charpos)
+    {
+      struct motion_checkpoint *cp = &cache->motion_checkpoints[--i];
+      if (cp->from == from
+	  && (cp->vpos < tovpos || (cp->vpos == tovpos && cp->hpos < tohpos)))
+	return cp;
+    }
+  return NULL;
+}
+
+/* Record in CACHE the motion checkpoint CP.  */
+
+static void
+add_motion_checkpoint (struct column_cache *cache,
+		       struct motion_checkpoint cp)
+{
+  ptrdiff_t i = motion_checkpoint_index (cache, cp.charpos);
+
+  for (ptrdiff_t j = i;
+       j < cache->motion_count
+	 && cache->motion_checkpoints[j].charpos == cp.charpos;
+       j++)
+    if (cache->motion_checkpoints[j].from == cp.from)
+      return;
+  if (cache->motion_count == cache->motion_size)
+    cache->motion_checkpoints
+      = xpalloc (cache->motion_checkpoints, &cache->motion_size, 1, -1,
+		 sizeof *cache->motion_checkpoints);
+  memmove (&cache->motion_checkpoints[i + 1], &cache->motion_checkpoints[i],
+	   (cache->motion_count - i) * sizeof *cache->motion_checkpoints);
+  cache->motion_checkpoints[i] = cp;
+  cache->motion_count++;
+}
+
+/* Return the column cache of the current buffer if it can hold display
+   checkpoints for iterator IT, emptying the display checkpoints if
+   they were for something else.  */
+
+static struct column_cache *
+display_cache_for (struct it *it)
+{
+  struct buffer *b = current_buffer;
+  struct column_cache *cache = column_cache_for (it->window);
+  struct terminal *t = FRAME_TERMINAL (it->f);
+  Lisp_Object terminal;
+  XSETTERMINAL (terminal, t);
+  EMACS_UINT modiff = max_char_table_modiff (0, it->w->display_table);
+  modiff = max_char_table_modiff (modiff, Vglyphless_char_display);
+
+  if (cache
+      && ! (EQ (cache->display_window_display_table, it->w->display_table)
+	    && EQ (cache->glyphless_char_display, Vglyphless_char_display)
+	    && cache->display_modiff == modiff
+	    && EQ (cache->nobreak_char_display, Vnobreak_char_display)
+	    && EQ (cache->terminal, terminal)
+	    && EQ (cache->terminal_charset_list, t->charset_list)
+	    && EQ (cache->terminal_glyph_code_table, t->glyph_code_table)
+	    && EQ (cache->line_prefix, Vline_prefix)
+	    && EQ (cache->wrap_prefix, Vwrap_prefix)
+	    && EQ (cache->bidi_paragraph_start_re,
+		   BVAR (b, bidi_paragraph_start_re))
+	    && EQ (cache->bidi_paragraph_separate_re,
+		   BVAR (b, bidi_paragraph_separate_re))
+	    && cache->first_visible_x == it->first_visible_x
+	    && cache->last_visible_x == it->last_visible_x
+	    && cache->line_wrap == it->line_wrap
+	    && cache->paragraph_embedding == it->paragraph_embedding
+	    && cache->bidi_p == it->bidi_p
+	    && cache->inhibit_bpa == bidi_inhibit_bpa))
+    {
+      cache->display_window_display_table = it->w->display_table;
+      cache->glyphless_char_display = Vglyphless_char_display;
+      cache->display_modiff = modiff;
+      cache->nobreak_char_display = Vnobreak_char_display;
+      cache->terminal = terminal;
+      cache->terminal_charset_list = t->charset_list;
+      cache->terminal_glyph_code_table = t->glyph_code_table;
+      cache->line_prefix = Vline_prefix;
+      cache->wrap_prefix = Vwrap_prefix;
+      cache->bidi_paragraph_start_re = BVAR (b, bidi_paragraph_start_re);
+      cache->bidi_paragraph_separate_re
+	= BVAR (b, bidi_paragraph_separate_re);
+      cache->first_visible_x = it->first_visible_x;
+      cache->last_visible_x = it->last_visible_x;
+      cache->line_wrap = it->line_wrap;
+      cache->paragraph_embedding = it->paragraph_embedding;
+      cache->bidi_p = it->bidi_p;
+      cache->inhibit_bpa = bidi_inhibit_bpa;
+      cache->display_count = 0;
+    }
+  return cache;
+}
+
+/* Return the index of the first display checkpoint in CACHE at or
+   after CHARPOS.  */
+
+static ptrdiff_t
+display_checkpoint_index (struct column_cache *cache, ptrdiff_t charpos)
+{
+  ptrdiff_t lo = 0, hi = cache->display_count;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      if (cache->display_checkpoints[mid].charpos < charpos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Find the last display checkpoint for iterator IT of the line
+   starting at LINE_BEG that is at or before CHARPOS.  If there is
+   one, store it in *CP and return true.  */
+
+bool
+find_display_checkpoint (struct it *it, ptrdiff_t line_beg,
+			 ptrdiff_t charpos, struct display_checkpoint *cp)
+{
+  struct column_cache *cache = display_cache_for (it);
+
+  if (cache)
+    for (ptrdiff_t i = display_checkpoint_index (cache, charpos + 1);
+	 0 < i && line_beg < cache->display_checkpoints[i - 1].charpos;
+	 i--)
+      if (cache->display_checkpoints[i - 1].line_beg == line_beg)
+	{
+	  *cp = cache->display_checkpoints[i - 1];
+	  return true;
+	}
+  return false;
+}
+
+/* Record the display checkpoint CP for iterator IT.  */
+
+void
+add_display_checkpoint (struct it *it, struct display_checkpoint cp)
+{
+  struct column_cache *cache = display_cache_for (it);
+
+  if (!cache)
+    return;
+
+  ptrdiff_t i = display_checkpoint_index (cache, cp.charpos);
+
+  if (i < cache->display_count
+      && cache->display_checkpoints[i].charpos == cp.charpos)
+    return;
+  if (cache->display_count == cache->display_size)
+    cache->display_checkpoints
+      = xpalloc (cache->display_checkpoints, &cache->display_size, 1, -1,
+		 sizeof *cache->display_checkpoints);
+  memmove (&cache->display_checkpoints[i + 1],
+	   &cache->display_checkpoints[i],
+	   (cache->display_count - i) * sizeof *cache->display_checkpoints);
+  cache->display_checkpoints[i] = cp;
+  cache->display_count++;
+}
+
+/* Discard the column, motion and display checkpoints of BUF that a
+   change at START can affect.  A composition that ends before START
+   can extend past it, and a screen line that starts before START can
+   end where a word after START overflows it, so also discard those a
+   little before START.  */
+
+void
+flush_column_cache (struct buffer *buf, ptrdiff_t start)
+{
+  if (buf->base_buffer)
+    buf = buf->base_buffer;
+  struct column_cache *cache = buf->column_cache;
+  if (cache)
+    {
+      start -= COLUMN_CHECKPOINT_INTERVAL;
+      cache->count = column_checkpoint_index (cache, start);
+      cache->motion_count = motion_checkpoint_index (cache, start);
+      cache->display_count = display_checkpoint_index (cache, start);
+    }
+}
+
+void
+free_column_cache (struct buffer *buf)
+{
+  if (buf->column_cache)
+    {
+      xfree (buf->column_cache->checkpoints);
+      xfree (buf->column_cache->motion_checkpoints);
+      xfree (buf->column_cache->display_checkpoints);
+      xfree (buf->column_cache);
+      buf->column_cache = NULL;
+    }
+}
+
+void
+mark_column_cache (struct buffer *buf)
+{
+  struct column_cache *cache = buf->column_cache;
+
+  if (cache)
+    {
+      mark_object (cache->buffer);
+      mark_object (cache->window);
+      mark_object (cache->display_table);
+      mark_object (cache->standard_display_table);
+      mark_object (cache->invisibility_spec);
+      mark_object (cache->selective_display);
+      mark_object (cache->char_width_table);
+      mark_object (cache->composition_function_table);
+      mark_object (cache->auto_composition_mode);
+      mark_object (cache->window_display_table);
+      mark_object (cache->truncate_lines);
+      mark_object (cache->truncate_partial_width_windows);
+      mark_object (cache->display_window_display_table);
+      mark_object (cache->glyphless_char_display);
+      mark_object (cache->nobreak_char_display);
+      mark_object (cache->terminal);
+      mark_object (cache->terminal_charset_list);
+      mark_object (cache->terminal_glyph_code_table);
+      mark_object (cache->line_prefix);
+      mark_object (cache->wrap_prefix);
+      mark_object (cache->bidi_paragraph_start_re);
+      mark_object (cache->bidi_paragraph_separate_re);
+    }
+}
+
 
 /* Skip some invisible characters starting from POS.
    This includes characters invisible because of text properties
@@ -353,10 +865,15 @@ current_column (void)
       && PT - line_beg > XFIXNUM (Vlong_line_threshold))
     return PT - line_beg;	/* this is an approximation! */
   /* If the buffer has overlays, text properties,
-     or multibyte characters, use a more general algorithm.  */
+     or multibyte characters, use a more general algorithm.
+     Also use it in long lines, where it can use column checkpoints,
+     unless ^M ends lines, which it does not handle.  */
   if (buffer_intervals (current_buffer)
       || buffer_has_overlays ()
-      || Z != Z_BYTE)
+      || Z != Z_BYTE
+      || (PT - line_beg > COLUMN_CHECKPOINT_INTERVAL
+	  && !NILP (BVAR (current_buffer, cache_long_scans))
+	  && !EQ (BVAR (current_buffer, selective_display), Qt)))
     return current_column_1 ();
 
   /* Scan backwards from point to the previous newline,
@@ -613,6 +1130,24 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
 	  col = 0;
 	}
     }
+
+  /* In a long line, start from the last checkpoint before END.  */
+  ptrdiff_t line_beg = scan, next_checkpoint = PTRDIFF_MAX;
+  struct column_cache *cache = NULL;
+  if (end - scan > COLUMN_CHECKPOINT_INTERVAL
+      && (cache = column_cache_for (window)))
+    {
+      struct column_checkpoint *cp
+	= find_column_checkpoint (cache, line_beg, end, goal);
+      if (cp)
+	{
+	  scan = cp->charpos;
+	  scan_byte = cp->bytepos;
+	  col = cp->col;
+	}
+      next_checkpoint = scan + COLUMN_CHECKPOINT_INTERVAL;
+    }
+
   next_boundary = scan;
   prev_pos = scan;
   prev_bpos = scan_byte;
@@ -648,6 +1183,12 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
       prev_pos = scan;
       prev_bpos = scan_byte;
 
+      if (scan >= next_checkpoint && cmp_it.id < 0)
+	{
+	  add_column_checkpoint (cache, line_beg, scan, scan_byte, col);
+	  next_checkpoint = scan + COLUMN_CHECKPOINT_INTERVAL;
+	}
+
       { /* Check display property.  */
 	ptrdiff_t endp;
 	int width = check_display_width (scan, col, &endp);
@@ -1284,6 +1825,32 @@ compute_motion (ptrdiff_t from, ptrdiff_t frombyte, EMACS_INT fromvpos,
   pos_byte = prev_pos_byte = frombyte;
   contin_hpos = 0;
   prev_tab_offset = tab_offset;
+
+  /* When laying out a long line from its beginning, start from the
+     last motion checkpoint before the target.  */
+  struct column_cache *cache = NULL;
+  ptrdiff_t next_checkpoint = PTRDIFF_MAX;
+  if (fromhpos == 0 && tab_offset == 0 && hscroll == 0 && !did_motion
+      && to - from > COLUMN_CHECKPOINT_INTERVAL
+      && (from == BEGV || FETCH_BYTE (frombyte - 1) == '\n')
+      && (cache = motion_cache_for (win, width)))
+    {
+      struct motion_checkpoint *cp
+	= find_motion_checkpoint (cache, from, to, tovpos - fromvpos, tohpos);
+      if (cp)
+	{
+	  pos = prev_pos = next_boundary = cp->charpos;
+	  pos_byte = prev_pos_byte = cp->bytepos;
+	  vpos = prev_vpos = fromvpos + cp->vpos;
+	  hpos = prev_hpos = cp->hpos;
+	  tab_offset = prev_tab_offset = cp->tab_offset;
+	  width_run_start = width_run_end = next_width_run = pos;
+	  /* Any overlay strings at POS have been accounted for.  */
+	  did_motion = true;
+	}
+      next_checkpoint = pos + COLUMN_CHECKPOINT_INTERVAL;
+    }
+
   memset (&cmp_it, 0, sizeof cmp_it);
   cmp_it.id = -1;
   composition_compute_stop_pos (&cmp_it, pos, pos_byte, to, Qnil);
@@ -1522,6 +2089,20 @@ compute_motion (ptrdiff_t from, ptrdiff_t frombyte, EMACS_INT fromvpos,
       prev_pos_byte = pos_byte;
       wide_column_end_hpos = 0;
 
+      /* Record a motion checkpoint where restarting needs no more
+	 state than it holds: not in a composition, and not at the
+	 start of a screen line, where CONTIN_HPOS matters.  */
+      if (pos >= next_checkpoint && cmp_it.id < 0
+	  && 0 < hpos && hpos <= width)
+	{
+	  add_motion_checkpoint (cache, (struct motion_checkpoint)
+				 { .from = from, .charpos = pos,
+				   .bytepos = pos_byte,
+				   .vpos = vpos - fromvpos, .hpos = hpos,
+				   .tab_offset = tab_offset });
+	  next_checkpoint = pos + COLUMN_CHECKPOINT_INTERVAL;
+	}
+
       /* Consult the width run cache to see if we can avoid inspecting
          the text character-by-character.  */
       if (width_cache && pos >= next_width_run)
@@ -45,6 +45,26 @@ #define EMACS_INDENT_H
 /* Value of point when current_column was called */
 extern ptrdiff_t last_known_column_point;
 
+/* How far apart the checkpoints within long lines are recorded, and
+   how far before a change flush_column_cache discards them.  */
+enum { COLUMN_CHECKPOINT_INTERVAL = 4096 };
+
+/* A position within a long line where a screen line starts, from
+   which the display engine can lay out the rest of the line.  */
+struct display_checkpoint
+{
+  /* The beginning of the line, and the checkpoint's position.  */
+  ptrdiff_t line_beg, charpos, bytepos;
+
+  /* The total width of the screen lines before CHARPOS.  */
+  int continuation_lines_width;
+};
+
+struct it;
+bool find_display_checkpoint (struct it *, ptrdiff_t, ptrdiff_t,
+			      struct display_checkpoint *);
+void add_display_checkpoint (struct it *, struct display_checkpoint);
+
 /* Functions for dealing with the column cache.  */
 
 /* Return true if the display table DISPTAB specifies the same widths
@@ -68,11 +68,11 @@ check_markers (void)
     {
       if (tail->buffer->text != current_buffer->text)
 	emacs_abort ();
-      if (tail->charpos > Z)
+      if (marker_charpos (tail) > Z)
 	emacs_abort ();
-      if (tail->bytepos > Z_BYTE)
+      if (marker_bytepos (tail) > Z_BYTE)
 	emacs_abort ();
-      if (multibyte && ! CHAR_HEAD_P (FETCH_BYTE (tail->bytepos)))
+      if (multibyte && ! CHAR_HEAD_P (FETCH_BYTE (marker_bytepos (tail))))
 	emacs_abort ();
     }
 }
@@ -97,6 +97,14 @@ move_gap_both (ptrdiff_t charpos, ptrdiff_t bytepos)
     gap_right (charpos, bytepos);
 }
 
+/* The number of bytes gap_left and gap_right move between checks for
+   a quit.  Moving the gap across a large buffer is bound by memory
+   bandwidth, and copying in big pieces lets memmove use its fastest
+   strategies while a quit is still noticed within a millisecond or
+   so.  */
+
+enum { GAP_MOVE_CHUNK = 1024 * 1024 };
+
 /* Move the gap to a position less than the current GPT.
    BYTEPOS describes the new position as a byte position,
    and CHARPOS is the corresponding char position.
@@ -138,14 +146,10 @@ gap_left (ptrdiff_t charpos, ptrdiff_t bytepos, bool newgap)
 	  charpos = BYTE_TO_CHAR (bytepos);
 	  break;
 	}
-      /* Move at most 32000 chars before checking again for a quit.  */
-      /* FIXME: This 32KB chunk size dates back to before 1991.
-         Maybe we should bump it to reflect the >1000x increase
-         in memory size and bandwidth since that time.
-         Is it even worthwhile checking `quit` within this loop?
-         Especially since make_gap_smaller/larger binds inhibit-quit anyway!  */
-      if (i > 32000)
-	i = 32000;
+      /* Move at most GAP_MOVE_CHUNK bytes before checking again
+	 for a quit.  */
+      if (i > GAP_MOVE_CHUNK)
+	i = GAP_MOVE_CHUNK;
       new_s1 -= i;
       from -= i, to -= i;
       memmove (to, from, i);
@@ -200,9 +204,10 @@ gap_right (ptrdiff_t charpos, ptrdiff_t bytepos)
 	  charpos = BYTE_TO_CHAR (bytepos);
 	  break;
 	}
-      /* Move at most 32000 chars before checking again for a quit.  */
-      if (i > 32000)
-	i = 32000;
+      /* Move at most GAP_MOVE_CHUNK bytes before checking again
+	 for a quit.  */
+      if (i > GAP_MOVE_CHUNK)
+	i = GAP_MOVE_CHUNK;
       new_s1 += i;
       memmove (to, from, i);
       from += i, to += i;
@@ -227,8 +232,8 @@ adjust_suspend_auto_hscroll (ptrdiff_t from, ptrdiff_t to)
 
       if (BUFFERP (w->contents)
 	  && XBUFFER (w->contents) == current_buffer
-	  && XMARKER (w->old_pointm)->charpos >= from
-	  && XMARKER (w->old_pointm)->charpos <= to)
+	  && marker_charpos (XMARKER (w->old_pointm)) >= from
+	  && marker_charpos (XMARKER (w->old_pointm)) <= to)
 	w->suspend_auto_hscroll = 0;
     }
 }
@@ -245,29 +250,14 @@ adjust_suspend_auto_hscroll (ptrdiff_t from, ptrdiff_t to)
 adjust_markers_for_delete (ptrdiff_t from, ptrdiff_t from_byte,
 			   ptrdiff_t to, ptrdiff_t to_byte)
 {
-  struct Lisp_Marker *m;
-  ptrdiff_t charpos;
-
   adjust_suspend_auto_hscroll (from, to);
-  for (m = BUF_MARKERS (current_buffer); m; m = m->next)
-    {
-      charpos = m->charpos;
-      eassert (charpos <= Z);
 
-      /* If the marker is after the deletion,
-	 relocate by number of chars / bytes deleted.  */
-      if (charpos > to)
-	{
-	  m->charpos -= to - from;
-	  m->bytepos -= to_byte - from_byte;
-	}
-      /* Here's the case where a marker is inside text being deleted.  */
-      else if (charpos > from)
-	{
-	  m->charpos = from;
-	  m->bytepos = from_byte;
-	}
-    }
+  /* Markers after the deletion are relocated by the number of chars
+     / bytes deleted, and markers inside it are moved to FROM.  */
+  marker_index_adjust_for_delete (current_buffer, from, from_byte,
+				  to, to_byte);
+  adjust_position_index (current_buffer, from, to - from, to_byte - from_byte,
+			 0, 0);
 }
 
 
@@ -283,33 +273,13 @@ adjust_markers_for_delete (ptrdiff_t from, ptrdiff_t from_byte,
 adjust_markers_for_insert (ptrdiff_t from, ptrdiff_t from_byte,
 			   ptrdiff_t to, ptrdiff_t to_byte, bool before_markers)
 {
-  struct Lisp_Marker *m;
-  bool adjusted = 0;
-  ptrdiff_t nchars = to - from;
-  ptrdiff_t nbytes = to_byte - from_byte;
+  bool adjusted;
 
   adjust_suspend_auto_hscroll (from, to);
-  for (m = BUF_MARKERS (current_buffer); m; m = m->next)
-    {
-      eassert (m->bytepos >= m->charpos
-	       && m->bytepos - m->charpos <= Z_BYTE - Z);
-
-      if (m->bytepos == from_byte)
-	{
-	  if (m->insertion_type || before_markers)
-	    {
-	      m->bytepos = to_byte;
-	      m->charpos = to;
-	      if (m->insertion_type)
-		adjusted = 1;
-	    }
-	}
-      else if (m->bytepos > from_byte)
-	{
-	  m->bytepos += nbytes;
-	  m->charpos += nchars;
-	}
-    }
+  adjusted = marker_index_adjust_for_insert (current_buffer, from, from_byte,
+					     to, to_byte, before_markers);
+  adjust_position_index (current_buffer, from, 0, 0,
+			 to - from, to_byte - from_byte);
 
   /* Adjusting only markers whose insertion-type is t may result in
      - disordered start and end in overlays, and
@@ -349,25 +319,11 @@ adjust_markers_for_replace (ptrdiff_t from, ptrdiff_t from_byte,
 			    ptrdiff_t old_chars, ptrdiff_t old_bytes,
 			    ptrdiff_t new_chars, ptrdiff_t new_bytes)
 {
-  register struct Lisp_Marker *m;
-  ptrdiff_t prev_to_byte = from_byte + old_bytes;
-  ptrdiff_t diff_chars = new_chars - old_chars;
-  ptrdiff_t diff_bytes = new_bytes - old_bytes;
-
   adjust_suspend_auto_hscroll (from, from + old_chars);
-  for (m = BUF_MARKERS (current_buffer); m; m = m->next)
-    {
-      if (m->bytepos >= prev_to_byte)
-	{
-	  m->charpos += diff_chars;
-	  m->bytepos += diff_bytes;
-	}
-      else if (m->bytepos > from_byte)
-	{
-	  m->charpos = from;
-	  m->bytepos = from_byte;
-	}
-    }
+  marker_index_adjust_for_replace (current_buffer, from, from_byte,
+				   old_chars, old_bytes, new_chars, new_bytes);
+  adjust_position_index (current_buffer, from, old_chars, old_bytes,
+			 new_chars, new_bytes);
 
   check_markers ();
 }
@@ -414,28 +370,33 @@ adjust_markers_bytepos (ptrdiff_t from, ptrdiff_t from_byte,
 	 its charpos.  */
       for (m = BUF_MARKERS (current_buffer); m; m = m->next)
 	{
-	  if (m->bytepos > from_byte
-	      && (to_z || m->bytepos <= to_byte))
-	    m->bytepos = m->charpos;
+	  ptrdiff_t bytepos = marker_bytepos (m);
+	  if (bytepos > from_byte
+	      && (to_z || bytepos <= to_byte))
+	    reposition_marker (m, marker_charpos (m), marker_charpos (m));
 	}
     }
   else
     {
       for (m = BUF_MARKERS (current_buffer); m; m = m->next)
 	{
+	  ptrdiff_t charpos = marker_charpos (m);
+	  ptrdiff_t bytepos = marker_bytepos (m);
+
 	  /* Recompute each affected marker's bytepos.  */
-	  if (m->bytepos > from_byte
-	      && (to_z || m->bytepos <= to_byte))
+	  if (bytepos > from_byte
+	      && (to_z || bytepos <= to_byte))
 	    {
-	      if (m->charpos < beg
-		  && beg - m->charpos > m->charpos - from)
+	      if (charpos < beg
+		  && beg - charpos > charpos - from)
 		{
 		  beg = from;
 		  begbyte = from_byte;
 		}
-	      m->bytepos = count_bytes (beg, begbyte, m->charpos);
-	      beg = m->charpos;
-	      begbyte = m->bytepos;
+	      bytepos = count_bytes (beg, begbyte, charpos);
+	      reposition_marker (m, charpos, bytepos);
+	      beg = charpos;
+	      begbyte = bytepos;
 	    }
 	}
     }
@@ -467,7 +428,7 @@ make_gap_larger (ptrdiff_t nbytes_added)
 
   /* If we have to get more space, get enough to last a while;
      but do not exceed the maximum buffer size.  */
-  nbytes_added = min (nbytes_added + GAP_BYTES_DFL,
+  nbytes_added = min (nbytes_added + buf_gap_allowance (current_size),
 		      BUF_BYTES_MAX - current_size);
 
   enlarge_buffer_text (current_buffer, nbytes_added);
@@ -1438,11 +1399,24 @@ replace_range (ptrdiff_t from, ptrdiff_t to, Lisp_Object new,
     outgoing_insbytes
       = count_size_as_multibyte (SDATA (new), insbytes);
 
-  /* Make sure the gap is somewhere in or next to what we are deleting.  */
-  if (from > GPT)
-    gap_right (from, from_byte);
-  if (to < GPT)
-    gap_left (to, to_byte, 0);
+  /* If the new text is as long as the old, and the old text does not
+     straddle the gap, the new text can simply be copied over the old.
+     Then a small replacement far from the gap, like typing in
+     Overwrite mode or 'replace-match' with a replacement as long as
+     the match, does not move the gap across all the text between.  */
+  bool in_place = (nchars_del == inschars
+		   && nbytes_del == outgoing_insbytes
+		   && (to_byte <= GPT_BYTE || GPT_BYTE <= from_byte));
+
+  /* Otherwise make sure the gap is somewhere in or next to what we
+     are deleting.  */
+  if (!in_place)
+    {
+      if (from > GPT)
+	gap_right (from, from_byte);
+      if (to < GPT)
+	gap_left (to, to_byte, 0);
+    }
 
   /* Even if we don't record for undo, we must keep the original text
      because we may have to recover it because of inappropriate byte
@@ -1450,41 +1424,55 @@ replace_range (ptrdiff_t from, ptrdiff_t to, Lisp_Object new,
   if (! EQ (BVAR (current_buffer, undo_list), Qt))
     deletion = make_buffer_string_both (from, from_byte, to, to_byte, 1);
 
-  GAP_SIZE += nbytes_del;
-  ZV -= nchars_del;
-  Z -= nchars_del;
-  ZV_BYTE -= nbytes_del;
-  Z_BYTE -= nbytes_del;
-  GPT = from;
-  GPT_BYTE = from_byte;
-  if (GAP_SIZE > 0) *(GPT_ADDR) = 0; /* Put an anchor.  */
-
-  eassert (GPT <= GPT_BYTE);
-
-  if (GPT - BEG < BEG_UNCHANGED)
-    BEG_UNCHANGED = GPT - BEG;
-  if (Z - GPT < END_UNCHANGED)
-    END_UNCHANGED = Z - GPT;
-
-  if (GAP_SIZE < outgoing_insbytes)
-    make_gap (outgoing_insbytes - GAP_SIZE);
+  if (in_place)
+    {
+      BUF_COMPUTE_UNCHANGED (current_buffer, from, to);
 
-  /* Copy the string text into the buffer, perhaps converting
-     between single-byte and multibyte.  */
-  copy_text (SDATA (new), GPT_ADDR, insbytes,
-	     STRING_MULTIBYTE (new),
-	     ! NILP (BVAR (current_buffer, enable_multibyte_characters)));
+      /* Copy the string text over the old text, perhaps converting
+	 between single-byte and multibyte.  */
+      copy_text (SDATA (new), BYTE_POS_ADDR (from_byte), insbytes,
+		 STRING_MULTIBYTE (new),
+		 ! NILP (BVAR (current_buffer, enable_multibyte_characters)));
+    }
+  else
+    {
+      GAP_SIZE += nbytes_del;
+      ZV -= nchars_del;
+      Z -= nchars_del;
+      ZV_BYTE -= nbytes_del;
+      Z_BYTE -= nbytes_del;
+      GPT = from;
+      GPT_BYTE = from_byte;
+      if (GAP_SIZE > 0) *(GPT_ADDR) = 0; /* Put an anchor.  */
+
+      eassert (GPT <= GPT_BYTE);
+
+      if (GPT - BEG < BEG_UNCHANGED)
+	BEG_UNCHANGED = GPT - BEG;
+      if (Z - GPT < END_UNCHANGED)
+	END_UNCHANGED = Z - GPT;
+
+      if (GAP_SIZE < outgoing_insbytes)
+	make_gap (outgoing_insbytes - GAP_SIZE);
+
+      /* Copy the string text into the buffer, perhaps converting
+	 between single-byte and multibyte.  */
+      copy_text (SDATA (new), GPT_ADDR, insbytes,
+		 STRING_MULTIBYTE (new),
+		 ! NILP (BVAR (current_buffer, enable_multibyte_characters)));
 
 #ifdef BYTE_COMBINING_DEBUG
-  /* We have copied text into the gap, but we have not marked
-     it as part of the buffer.  So we can use the old FROM and FROM_BYTE
-     here, for both the previous text and the following text.
-     Meanwhile, GPT_ADDR does point to
-     the text that has been stored by copy_text.  */
-  if (count_combining_before (GPT_ADDR, outgoing_insbytes, from, from_byte)
-      || count_combining_after (GPT_ADDR, outgoing_insbytes, from, from_byte))
-    emacs_abort ();
+      /* We have copied text into the gap, but we have not marked
+	 it as part of the buffer.  So we can use the old FROM and FROM_BYTE
+	 here, for both the previous text and the following text.
+	 Meanwhile, GPT_ADDR does point to
+	 the text that has been stored by copy_text.  */
+      if (count_combining_before (GPT_ADDR, outgoing_insbytes, from, from_byte)
+	  || count_combining_after (GPT_ADDR, outgoing_insbytes,
+				    from, from_byte))
+	emacs_abort ();
 #endif
+    }
 
   /* Record the insertion first, so that when we undo,
      the deletion will be undone first.  Thus, undo
@@ -1496,16 +1484,19 @@ replace_range (ptrdiff_t from, ptrdiff_t to, Lisp_Object new,
       record_delete (from, deletion, false);
     }
 
-  GAP_SIZE -= outgoing_insbytes;
-  GPT += inschars;
-  ZV += inschars;
-  Z += inschars;
-  GPT_BYTE += outgoing_insbytes;
-  ZV_BYTE += outgoing_insbytes;
-  Z_BYTE += outgoing_insbytes;
-  if (GAP_SIZE > 0) *(GPT_ADDR) = 0; /* Put an anchor.  */
-
-  eassert (GPT <= GPT_BYTE);
+  if (!in_place)
+    {
+      GAP_SIZE -= outgoing_insbytes;
+      GPT += inschars;
+      ZV += inschars;
+      Z += inschars;
+      GPT_BYTE += outgoing_insbytes;
+      ZV_BYTE += outgoing_insbytes;
+      Z_BYTE += outgoing_insbytes;
+      if (GAP_SIZE > 0) *(GPT_ADDR) = 0; /* Put an anchor.  */
+
+      eassert (GPT <= GPT_BYTE);
+    }
 
   /* Adjust markers for the deletion and the insertion.  */
   if (markers)
@@ -1518,6 +1509,8 @@ replace_range (ptrdiff_t from, ptrdiff_t to, Lisp_Object new,
 	 deleted and the inserted text might have multibyte sequences
 	 which make the original byte positions of the markers
 	 invalid.  */
+      adjust_position_index (current_buffer, from, nchars_del, nbytes_del,
+			     inschars, outgoing_insbytes);
       adjust_markers_bytepos (from, from_byte, from + inschars,
 			      from_byte + outgoing_insbytes, 1);
     }
@@ -1555,8 +1548,8 @@ replace_range (ptrdiff_t from, ptrdiff_t to, Lisp_Object new,
 
   if (!inhibit_mod_hooks)
     {
-      signal_after_change (from, nchars_del, GPT - from);
-      update_compositions (from, GPT, CHECK_BORDER);
+      signal_after_change (from, nchars_del, inschars);
+      update_compositions (from, from + inschars, CHECK_BORDER);
     }
 }
 
@@ -1651,6 +1644,8 @@ replace_range_2 (ptrdiff_t from, ptrdiff_t from_byte,
 	     deleted and the inserted text might have multibyte
 	     sequences which make the original byte positions of the
 	     markers invalid.  */
+	  adjust_position_index (current_buffer, from, nchars_del, nbytes_del,
+				 inschars, insbytes);
 	  adjust_markers_bytepos (from, from_byte, from + inschars,
 				  from_byte + insbytes, 1);
 	}
@@ -2074,6 +2069,9 @@ invalidate_buffer_caches (struct buffer *buf, ptrdiff_t start, ptrdiff_t end)
     invalidate_region_cache (buf,
                              buf->width_run_cache,
                              start - BUF_BEG (buf), BUF_Z (buf) - end);
+  flush_parse_state_cache (buf, start);
+  flush_column_cache (buf, start);
+  flush_bidi_dir_cache (buf, start);
 }
 
 /* These macros work with an argument named `preserve_ptr'
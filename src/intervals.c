@@ -64,12 +64,16 @@ #define TMEM(sym, set) (CONSP (set) ? ! NILP (Fmemq (sym, set)) : ! NILP (set))
 set_interval_left (INTERVAL i, INTERVAL left)
 {
   i->left = left;
+  if (left)
+    note_interval_props (i, left->props_summary);
 }
 
 static void
 set_interval_right (INTERVAL i, INTERVAL right)
 {
   i->right = right;
+  if (right)
+    note_interval_props (i, right->props_summary);
 }
 
 /* Make the parent of D be whatever the parent of S is, regardless
@@ -82,6 +86,47 @@ copy_interval_parent (INTERVAL d, INTERVAL s)
   d->up_obj = s->up_obj;
 }
 
+/* Return the `props_summary' bits for the property names in PLIST.  */
+
+unsigned int
+plist_props_summary (Lisp_Object plist)
+{
+  unsigned int bits = 0;
+
+  for (; CONSP (plist); plist = XCDR (plist))
+    {
+      bits |= interval_prop_bit (XCAR (plist));
+      plist = XCDR (plist);
+      if (!CONSP (plist))
+	break;
+    }
+  return bits;
+}
+
+/* Record that the subtree at I now contains the property names in
+   BITS, updating I and its ancestors as needed.  */
+
+void
+note_interval_props (INTERVAL i, unsigned int bits)
+{
+  for (; i && (bits & ~i->props_summary); i = INTERVAL_PARENT_OR_NULL (i))
+    i->props_summary |= bits;
+}
+
+/* Recompute the `props_summary' of I from its plist and children.
+   This drops bits left over from properties or children that are
+   gone.  */
+
+static void
+refresh_interval_props (INTERVAL i)
+{
+  i->props_summary = plist_props_summary (i->plist);
+  if (i->left)
+    i->props_summary |= i->left->props_summary;
+  if (i->right)
+    i->props_summary |= i->right->props_summary;
+}
+
 /* Create the root interval of some object, a buffer or string.  */
 
 INTERVAL
@@ -316,6 +361,11 @@ rotate_right (INTERVAL A)
   B->total_length = old_total;
   eassert (LENGTH (B) > 0);
 
+  /* Both subtrees changed shape; the summaries of the ancestors are
+     still valid since B's subtree covers the same intervals.  */
+  refresh_interval_props (A);
+  refresh_interval_props (B);
+
   return B;
 }
 
@@ -367,6 +417,11 @@ rotate_left (INTERVAL A)
   B->total_length = old_total;
   eassert (LENGTH (B) > 0);
 
+  /* Both subtrees changed shape; the summaries of the ancestors are
+     still valid since B's subtree covers the same intervals.  */
+  refresh_interval_props (A);
+  refresh_interval_props (B);
+
   return B;
 }
 
@@ -685,6 +740,149 @@ next_interval (register INTERVAL interval)
   return NULL;
 }
 
+/* Return the `props_summary' bits that must be absent from an
+   interval's plist for `textget' of PROP to fall back to its default.
+   Besides PROP itself, this covers `category' and the aliases of PROP
+   in `char-property-alias-alist'.  */
+
+unsigned int
+interval_props_mask (Lisp_Object prop)
+{
+  unsigned int mask = interval_prop_bit (prop) | interval_prop_bit (Qcategory);
+  Lisp_Object tail = Fassq (prop, Vchar_property_alias_alist);
+
+  if (CONSP (tail))
+    for (tail = XCDR (tail); CONSP (tail); tail = XCDR (tail))
+      mask |= interval_prop_bit (XCAR (tail));
+  return mask;
+}
+
+/* Return the first interval in TREE, whose text starts at POS, whose
+   plist may have one of the properties in MASK, or NULL if there is
+   none.  Set the `position' field of the interval found.  */
+
+static INTERVAL
+first_interval_with_props (INTERVAL tree, ptrdiff_t pos, unsigned int mask)
+{
+  while (tree && (tree->props_summary & mask))
+    {
+      INTERVAL found = first_interval_with_props (tree->left, pos, mask);
+      if (found)
+	return found;
+      pos += LEFT_TOTAL_LENGTH (tree);
+      if (plist_props_summary (tree->plist) & mask)
+	{
+	  tree->position = pos;
+	  return tree;
+	}
+      pos += LENGTH (tree);
+      tree = tree->right;
+    }
+  return NULL;
+}
+
+/* Likewise, but return the last such interval of TREE, whose text
+   ends at END.  */
+
+static INTERVAL
+last_interval_with_props (INTERVAL tree, ptrdiff_t end, unsigned int mask)
+{
+  while (tree && (tree->props_summary & mask))
+    {
+      INTERVAL found = last_interval_with_props (tree->right, end, mask);
+      if (found)
+	return found;
+      end -= RIGHT_TOTAL_LENGTH (tree) + LENGTH (tree);
+      if (plist_props_summary (tree->plist) & mask)
+	{
+	  tree->position = end;
+	  return tree;
+	}
+      tree = tree->left;
+    }
+  return NULL;
+}
+
+/* Like next_interval, but skip over intervals whose plist has none of
+   the properties in MASK, as computed by interval_props_mask.  Whole
+   subtrees are skipped using their `props_summary'.  The intervals
+   skipped have the default value of the property, so callers
+   searching for a change away from that value can use this instead
+   of stepping through every interval.  */
+
+INTERVAL
+next_interval_with_props (INTERVAL interval, unsigned int mask)
+{
+  INTERVAL i = interval;
+  ptrdiff_t pos;
+
+  if (!i)
+    return NULL;
+  pos = i->position + LENGTH (i);
+
+  while (true)
+    {
+      if (i->right)
+	{
+	  INTERVAL found = first_interval_with_props (i->right, pos, mask);
+	  if (found)
+	    return found;
+	  pos += TOTAL_LENGTH (i->right);
+	}
+
+      while (AM_RIGHT_CHILD (i))
+	i = INTERVAL_PARENT (i);
+      if (NULL_PARENT (i))
+	return NULL;
+      i = INTERVAL_PARENT (i);
+
+      if (plist_props_summary (i->plist) & mask)
+	{
+	  i->position = pos;
+	  return i;
+	}
+      pos += LENGTH (i);
+    }
+}
+
+/* Like previous_interval, but skip over intervals the way
+   next_interval_with_props does.  */
+
+INTERVAL
+previous_interval_with_props (INTERVAL interval, unsigned int mask)
+{
+  INTERVAL i = interval;
+  ptrdiff_t pos;
+
+  if (!i)
+    return NULL;
+  pos = i->position;
+
+  while (true)
+    {
+      if (i->left)
+	{
+	  INTERVAL found = last_interval_with_props (i->left, pos, mask);
+	  if (found)
+	    return found;
+	  pos -= TOTAL_LENGTH (i->left);
+	}
+
+      while (AM_LEFT_CHILD (i))
+	i = INTERVAL_PARENT (i);
+      if (NULL_PARENT (i))
+	return NULL;
+      i = INTERVAL_PARENT (i);
+
+      pos -= LENGTH (i);
+      if (plist_props_summary (i->plist) & mask)
+	{
+	  i->position = pos;
+	  return i;
+	}
+    }
+}
+
 /* Find the preceding interval (lexicographically) to INTERVAL.
    Sets the `position' field based on that of INTERVAL (see
    find_interval).  */
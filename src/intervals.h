@@ -43,6 +43,13 @@ #define EMACS_INTERVALS_H
   struct interval *left;	/* Intervals which precede me.  */
   struct interval *right;	/* Intervals which succeed me.  */
 
+  /* Summary of the property names that occur in the plists of this
+     interval and its children, one bit per hashed name (see
+     interval_prop_bit).  It may have extra bits set, but never lacks
+     one, so a subtree whose summary doesn't mention a property can be
+     skipped when searching for it.  */
+  unsigned int props_summary;
+
   /* Parent in the tree, or the Lisp_Object containing this interval tree.  */
   union
   {
@@ -158,10 +165,26 @@ set_interval_parent (INTERVAL i, INTERVAL parent)
   i->up.interval = parent;
 }
 
+extern void note_interval_props (INTERVAL, unsigned int);
+extern unsigned int plist_props_summary (Lisp_Object);
+
 INLINE void
 set_interval_plist (INTERVAL i, Lisp_Object plist)
 {
   i->plist = plist;
+  note_interval_props (i, plist_props_summary (plist));
+}
+
+/* Return the bit that stands for property name PROP in the
+   `props_summary' of an interval.  The bit depends on the address of
+   PROP, so it is only valid within one session; see
+   dump_interval_tree.  */
+
+INLINE unsigned int
+interval_prop_bit (Lisp_Object prop)
+{
+  uint_least64_t h = (uint_least64_t) XHASH (prop) * 0x9e3779b97f4a7c15u;
+  return 1u << ((h >> 59) & 31);
 }
 
 /* Get the parent interval, if any, otherwise a null pointer.  Useful
@@ -175,6 +198,7 @@ #define RESET_INTERVAL(i)		      \
  do {					      \
   (i)->total_length = (i)->position = 0;      \
   (i)->left = (i)->right = NULL;	      \
+  (i)->props_summary = 0;		      \
   set_interval_parent (i, NULL);	      \
   (i)->write_protect = false;		      \
   (i)->visible = false;			      \
@@ -255,6 +279,9 @@ #define TEXT_PROP_MEANS_INVISIBLE(prop)					\
 extern INTERVAL find_interval (INTERVAL, ptrdiff_t);
 extern INTERVAL next_interval (INTERVAL);
 extern INTERVAL previous_interval (INTERVAL);
+extern unsigned int interval_props_mask (Lisp_Object);
+extern INTERVAL next_interval_with_props (INTERVAL, unsigned int);
+extern INTERVAL previous_interval_with_props (INTERVAL, unsigned int);
 extern INTERVAL merge_interval_left (INTERVAL);
 extern void offset_intervals (struct buffer *, ptrdiff_t, ptrdiff_t);
 extern void graft_intervals_into_buffer (INTERVAL, ptrdiff_t, ptrdiff_t,
@@ -9673,13 +9673,19 @@ #define PUSH_C_STR(str, listvar) \
 static Lisp_Object
 follow_key (Lisp_Object keymap, Lisp_Object key)
 {
-  return access_keymap (get_keymap (keymap, 0, 1),
-			key, 1, 0, 1);
+  struct timespec start = current_timespec ();
+  Lisp_Object binding = access_keymap (get_keymap (keymap, 0, 1),
+				       key, 1, 0, 1);
+
+  record_key_lookup (start);
+  return binding;
 }
 
 static Lisp_Object
 active_maps (Lisp_Object first_event, Lisp_Object second_event)
 {
+  struct timespec start = current_timespec ();
+  Lisp_Object maps;
   Lisp_Object position
     = EVENT_HAS_PARAMETERS (first_event) ? EVENT_START (first_event) : Qnil;
   /* The position of a click can be in the second event if the first event
@@ -9691,7 +9697,9 @@ active_maps (Lisp_Object first_event, Lisp_Object second_event)
       eassert (NILP (position));
       position = EVENT_START (second_event);
     }
-  return Fcons (Qkeymap, Fcurrent_active_maps (Qt, position));
+  maps = Fcons (Qkeymap, Fcurrent_active_maps (Qt, position));
+  record_active_maps (start);
+  return maps;
 }
 
 /* Structure used to keep track of partial application of key remapping
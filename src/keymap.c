@@ -310,26 +310,31 @@ DEFUN ("set-keymap-parent", Fset_keymap_parent, Sset_keymap_parent, 2, 2, 0,
 }
 
 
-/* Look up IDX in MAP.  IDX may be any sort of event.
-   Note that this does only one level of lookup; IDX must be a single
-   event, not a sequence.
-
-   MAP must be a keymap or a list of keymaps.
+/* Counters and timings reported by `keymap-lookup-statistics'.  */
 
-   If T_OK, bindings for Qt are treated as default
-   bindings; any key left unmentioned by other tables and bindings is
-   given the binding of Qt.
+enum keymap_lookup_counter
+  {
+    KL_KEYS,
+    KL_ACCESSES,
+    KL_ACTIVE_MAPS,
+    KL_MAX
+  };
 
-   If not T_OK, bindings for Qt are not treated specially.
+enum keymap_lookup_timing
+  {
+    KL_KEY_SECONDS,
+    KL_MAX_KEY_SECONDS,
+    KL_ACTIVE_MAPS_SECONDS,
+    KL_SECONDS_MAX
+  };
 
-   If NOINHERIT, don't accept a subkeymap found in an inherited keymap.
+static intmax_t keymap_lookup_counters[KL_MAX];
+static double keymap_lookup_seconds[KL_SECONDS_MAX];
 
-   Return Qunbound if no binding was found (and return Qnil if a nil
-   binding was found).  */
+/* Return the index under which event IDX is bound in keymaps.  */
 
 static Lisp_Object
-access_keymap_1 (Lisp_Object map, Lisp_Object idx,
-		 bool t_ok, bool noinherit, bool autoload)
+keymap_event_index (Lisp_Object idx)
 {
   /* If idx is a list (some sort of mouse click, perhaps?),
      the index we want to use is the car of the list, which
@@ -345,6 +350,36 @@ access_keymap_1 (Lisp_Object map, Lisp_Object idx,
        with more than 24 bits of integer.  */
     XSETFASTINT (idx, XFIXNUM (idx) & (CHAR_META | (CHAR_META - 1)));
 
+  return idx;
+}
+
+/* Look up IDX in MAP.  IDX may be any sort of event.
+   Note that this does only one level of lookup; IDX must be a single
+   event, not a sequence.
+
+   MAP must be a keymap or a list of keymaps.
+
+   If T_OK, bindings for Qt are treated as default
+   bindings; any key left unmentioned by other tables and bindings is
+   given the binding of Qt.
+
+   If not T_OK, bindings for Qt are not treated specially.
+
+   If NOINHERIT, don't accept a subkeymap found in an inherited keymap.
+
+   Return Qunbound if no binding was found (and return Qnil if a nil
+   binding was found).
+
+   IDX must have been returned by keymap_event_index.  Submaps of MAP
+   are looked up with the same IDX, so that it is computed only once
+   per lookup.  */
+
+static Lisp_Object
+access_keymap_1 (Lisp_Object map, Lisp_Object idx,
+		 bool t_ok, bool noinherit, bool autoload)
+{
+  keymap_lookup_counters[KL_ACCESSES]++;
+
   /* Handle the special meta -> esc mapping.  */
   if (FIXNUMP (idx) && XFIXNAT (idx) & meta_modifier)
     {
@@ -355,8 +390,9 @@ access_keymap_1 (Lisp_Object map, Lisp_Object idx,
 	 infinite recursion.  Protect against that.  */
       if (XFIXNUM (meta_prefix_char) & CHAR_META)
 	meta_prefix_char = make_fixnum (27);
-      event_meta_binding = access_keymap_1 (map, meta_prefix_char, t_ok,
-					    noinherit, autoload);
+      event_meta_binding
+	= access_keymap_1 (map, keymap_event_index (meta_prefix_char),
+			   t_ok, noinherit, autoload);
       event_meta_map = get_keymap (event_meta_binding, 0, autoload);
       if (CONSP (event_meta_map))
 	{
@@ -388,7 +424,10 @@ access_keymap_1 (Lisp_Object map, Lisp_Object idx,
 	/* Qunbound in VAL means we have found no binding.  */
 	Lisp_Object val = Qunbound;
 	Lisp_Object binding = XCAR (tail);
-	Lisp_Object submap = get_keymap (binding, 0, autoload);
+	/* A binding (EVENT . DEFINITION) is not a keymap, which is
+	   worth checking first, since most elements are bindings.  */
+	Lisp_Object submap = ((CONSP (binding) && !EQ (XCAR (binding), Qkeymap))
+			      ? Qnil : get_keymap (binding, 0, autoload));
 
 	if (EQ (binding, Qkeymap))
 	  {
@@ -496,10 +535,78 @@ access_keymap_1 (Lisp_Object map, Lisp_Object idx,
 access_keymap (Lisp_Object map, Lisp_Object idx,
 	       bool t_ok, bool noinherit, bool autoload)
 {
-  Lisp_Object val = access_keymap_1 (map, idx, t_ok, noinherit, autoload);
+  Lisp_Object val = access_keymap_1 (map, keymap_event_index (idx),
+				     t_ok, noinherit, autoload);
   return BASE_EQ (val, Qunbound) ? Qnil : val;
 }
 
+/* Record that looking up a key in the active keymaps, which started at
+   START, is done.  */
+
+void
+record_key_lookup (struct timespec start)
+{
+  double seconds = timespectod (timespec_sub (current_timespec (), start));
+
+  keymap_lookup_counters[KL_KEYS]++;
+  keymap_lookup_seconds[KL_KEY_SECONDS] += seconds;
+  if (seconds > keymap_lookup_seconds[KL_MAX_KEY_SECONDS])
+    keymap_lookup_seconds[KL_MAX_KEY_SECONDS] = seconds;
+}
+
+/* Record that computing the active keymaps, which started at START,
+   is done.  */
+
+void
+record_active_maps (struct timespec start)
+{
+  keymap_lookup_counters[KL_ACTIVE_MAPS]++;
+  keymap_lookup_seconds[KL_ACTIVE_MAPS_SECONDS]
+    += timespectod (timespec_sub (current_timespec (), start));
+}
+
+DEFUN ("keymap-lookup-statistics", Fkeymap_lookup_statistics,
+       Skeymap_lookup_statistics, 0, 1, 0,
+       doc: /* Return an alist of counters and timings of key lookups.
+Each element has the form (NAME . VALUE).  The elements are:
+
+  `keys'                keys looked up in the active keymaps while
+                        reading key sequences
+  `accesses'            keymaps and submaps searched for a key, by
+                        key sequence reading and by other lookups
+  `active-maps'         times the active keymaps were computed while
+                        reading key sequences
+  `key-time'            seconds spent looking up those keys
+  `max-key-time'        the longest time spent looking up one key
+  `active-maps-time'    seconds spent computing the active keymaps
+
+If RESET is non-nil, reset all counters and timings to zero after
+returning their values.  */)
+  (Lisp_Object reset)
+{
+  static short const counter_symbols[KL_MAX] =
+    {
+      SYMBOL_INDEX (Qkeys), SYMBOL_INDEX (Qaccesses),
+      SYMBOL_INDEX (Qactive_maps)
+    };
+  static short const seconds_symbols[KL_SECONDS_MAX] =
+    {
+      SYMBOL_INDEX (Qkey_time), SYMBOL_INDEX (Qmax_key_time),
+      SYMBOL_INDEX (Qactive_maps_time)
+    };
+  Lisp_Object val = statistics_alist (KL_MAX, counter_symbols,
+				      keymap_lookup_counters,
+				      KL_SECONDS_MAX, seconds_symbols,
+				      keymap_lookup_seconds);
+
+  if (!NILP (reset))
+    {
+      memset (keymap_lookup_counters, 0, sizeof keymap_lookup_counters);
+      memset (keymap_lookup_seconds, 0, sizeof keymap_lookup_seconds);
+    }
+  return val;
+}
+
 static void
 map_keymap_item (map_keymap_function_t fun, Lisp_Object args, Lisp_Object key, Lisp_Object val, void *data)
 {
@@ -3335,6 +3442,14 @@ syms_of_keymap (void)
 
   DEFSYM (Qkeymap_canonicalize, "keymap-canonicalize");
 
+  /* Names of the elements of `keymap-lookup-statistics'.  */
+  DEFSYM (Qkeys, "keys");
+  DEFSYM (Qaccesses, "accesses");
+  DEFSYM (Qactive_maps, "active-maps");
+  DEFSYM (Qkey_time, "key-time");
+  DEFSYM (Qmax_key_time, "max-key-time");
+  DEFSYM (Qactive_maps_time, "active-maps-time");
+
   /* Now we are ready to set up this property, so we can
      create char tables.  */
   Fput (Qkeymap, Qchar_table_extra_slots, make_fixnum (0));
@@ -3463,6 +3578,7 @@ syms_of_keymap (void)
   defsubr (&Scurrent_global_map);
   defsubr (&Scurrent_minor_mode_maps);
   defsubr (&Scurrent_active_maps);
+  defsubr (&Skeymap_lookup_statistics);
   defsubr (&Saccessible_keymaps);
   defsubr (&Skey_description);
   defsubr (&Skeymap__get_keyelt);
@@ -622,7 +622,11 @@ #define ENUM_BF(TYPE) enum TYPE
 extern uintmax_t check_uinteger_max (Lisp_Object, uintmax_t);
 
 /* Defined in chartab.c.  */
-extern Lisp_Object char_table_ref (Lisp_Object, int) ATTRIBUTE_PURE;
+extern EMACS_UINT char_table_modiff (Lisp_Object);
+extern void char_table_modified (Lisp_Object);
+extern void sweep_char_table_modiffs (void);
+extern void clear_char_table_cache (void);
+extern Lisp_Object char_table_ref (Lisp_Object, int);
 extern void char_table_set (Lisp_Object, int, Lisp_Object);
 
 /* Defined in data.c.  */
@@ -1063,6 +1067,7 @@ DEFINE_GDB_SYMBOL_END (PSEUDOVECTOR_FLAG)
   PVEC_MODULE_FUNCTION,
   PVEC_NATIVE_COMP_UNIT,
   PVEC_SQLITE,
+  PVEC_COMPLETION_INDEX,
 
   /* These should be last, for internal_equal and sxhash_obj.  */
   PVEC_COMPILED,
@@ -2135,7 +2140,10 @@ CHAR_TABLE_REF (Lisp_Object ct, int idx)
 CHAR_TABLE_SET (Lisp_Object ct, int idx, Lisp_Object val)
 {
   if (ASCII_CHAR_P (idx) && SUB_CHAR_TABLE_P (XCHAR_TABLE (ct)->ascii))
-    set_sub_char_table_contents (XCHAR_TABLE (ct)->ascii, idx, val);
+    {
+      char_table_modified (ct);
+      set_sub_char_table_contents (XCHAR_TABLE (ct)->ascii, idx, val);
+    }
   else
     char_table_set (ct, idx, val);
 }
@@ -2575,18 +2583,92 @@ SXHASH_REDUCE (EMACS_UINT x)
      this is used to chain of all the markers in a given buffer.
      The chain does not preserve markers from garbage collection;
      instead, markers are removed from the chain when freed by GC.  */
-  /* We could remove it and use an array in buffer_text instead.
-     That would also allow us to preserve it ordered.  */
+  /* The order of the chain is unspecified; the chunks of the text's
+     marker index, below, keep the markers sorted by position.  */
   struct Lisp_Marker *next;
-  /* This is the char position where the marker points.  */
+  /* The chunk of the marker index that holds this marker, or NULL if
+     the buffer text has no index.  See marker.c.  */
+  struct marker_chunk *chunk;
+  /* The index of this marker within CHUNK's markers.  */
+  int slot;
+  /* This is the char position where the marker points, relative to
+     CHUNK's displacement if CHUNK is non-NULL.  Use marker_charpos to
+     read it.  */
   ptrdiff_t charpos;
-  /* This is the byte position.
+  /* This is the byte position, likewise relative to CHUNK.
      It's mostly used as a charpos<->bytepos cache (i.e. it's not directly
      used to implement the functionality of markers, but rather to (ab)use
      markers as a cache for char<->byte mappings).  */
   ptrdiff_t bytepos;
 } GCALIGNED_STRUCT;
 
+/* The markers of a buffer text, sorted by position, are kept in an
+   array of chunks of at most MARKER_CHUNK_SIZE markers each.  The
+   positions stored in the markers of a chunk are relative to the
+   chunk's displacement, so that an insertion or deletion only has to
+   touch the markers near the change; the markers after it are moved
+   by adjusting the displacement of whole chunks.  */
+
+enum { MARKER_CHUNK_SIZE = 128 };
+
+struct marker_index
+{
+  /* The chunks, in buffer order.  */
+  struct marker_chunk **chunks;
+  ptrdiff_t nchunks, size;
+
+  /* Chunks whose index is GAP or more are displaced by GAP_CHARS and
+     GAP_BYTES in addition to their own displacement.  A change to the
+     text moves GAP to just after the change and adds the size of the
+     change to GAP_CHARS and GAP_BYTES, so a sequence of changes at
+     nearby places does not need to visit the chunks after them.  */
+  ptrdiff_t gap, gap_chars, gap_bytes;
+};
+
+struct marker_chunk
+{
+  struct marker_index *index;
+  /* The position of this chunk in INDEX->chunks.  */
+  ptrdiff_t idx;
+  /* The displacement of the positions of the markers in this chunk.  */
+  ptrdiff_t charpos_delta, bytepos_delta;
+  int count;
+  struct Lisp_Marker *markers[MARKER_CHUNK_SIZE];
+};
+
+INLINE ptrdiff_t
+marker_chunk_charpos_delta (struct marker_chunk const *c)
+{
+  return (c->charpos_delta
+	  + (c->idx < c->index->gap ? 0 : c->index->gap_chars));
+}
+
+INLINE ptrdiff_t
+marker_chunk_bytepos_delta (struct marker_chunk const *c)
+{
+  return (c->bytepos_delta
+	  + (c->idx < c->index->gap ? 0 : c->index->gap_bytes));
+}
+
+/* Return the character position of marker M, which must point
+   somewhere.  */
+INLINE ptrdiff_t
+marker_charpos (struct Lisp_Marker const *m)
+{
+  return (m->chunk
+	  ? m->charpos + marker_chunk_charpos_delta (m->chunk)
+	  : m->charpos);
+}
+
+/* Return the byte position of marker M, which must point somewhere.  */
+INLINE ptrdiff_t
+marker_bytepos (struct Lisp_Marker const *m)
+{
+  return (m->chunk
+	  ? m->bytepos + marker_chunk_bytepos_delta (m->chunk)
+	  : m->bytepos);
+}
+
 /* START and END are markers in the overlay's buffer, and
    PLIST is the overlay's property list.  */
 struct Lisp_Overlay
@@ -2665,6 +2747,29 @@ xmint_pointer (Lisp_Object a)
   bool is_statement;
 } GCALIGNED_STRUCT;
 
+/* A completion index, see make-completion-index in minibuf.c.  */
+struct Lisp_Completion_Index
+{
+  union vectorlike_header header;
+
+  /* Vector of the strings in the index.  Unused slots hold the index
+     of the next unused slot, or -1.  */
+  Lisp_Object keys;
+
+  /* The rest is not traced by the GC.  */
+
+  /* Nodes of the trie.  Node 0 is the root.  */
+  struct completion_index_node *nodes;
+  ptrdiff_t nodes_size, nodes_used;
+
+  /* Index of the first unused node, or -1.  */
+  ptrdiff_t free_node;
+
+  /* Number of slots of KEYS used so far, and the first unused slot
+     before that, or -1.  */
+  ptrdiff_t keys_used, free_key;
+} GCALIGNED_STRUCT;
+
 struct Lisp_User_Ptr
 {
   union vectorlike_header header;
@@ -2783,6 +2888,19 @@ XSQLITE (Lisp_Object a)
   return XUNTAG (a, Lisp_Vectorlike, struct Lisp_Sqlite);
 }
 
+INLINE bool
+COMPLETION_INDEX_P (Lisp_Object x)
+{
+  return PSEUDOVECTORP (x, PVEC_COMPLETION_INDEX);
+}
+
+INLINE struct Lisp_Completion_Index *
+XCOMPLETION_INDEX (Lisp_Object a)
+{
+  eassert (COMPLETION_INDEX_P (a));
+  return XUNTAG (a, Lisp_Vectorlike, struct Lisp_Completion_Index);
+}
+
 INLINE bool
 BIGNUMP (Lisp_Object x)
 {
@@ -3836,6 +3954,8 @@ set_string_intervals (Lisp_Object s, INTERVAL i)
 INLINE void
 set_char_table_defalt (Lisp_Object table, Lisp_Object val)
 {
+  if (!BASE_EQ (XCHAR_TABLE (table)->defalt, val))
+    char_table_modified (table);
   XCHAR_TABLE (table)->defalt = val;
 }
 INLINE void
@@ -3850,6 +3970,8 @@ set_char_table_purpose (Lisp_Object table, Lisp_Object val)
 set_char_table_extras (Lisp_Object table, ptrdiff_t idx, Lisp_Object val)
 {
   eassert (0 <= idx && idx < CHAR_TABLE_EXTRA_SLOTS (XCHAR_TABLE (table)));
+  if (!BASE_EQ (XCHAR_TABLE (table)->extras[idx], val))
+    char_table_modified (table);
   XCHAR_TABLE (table)->extras[idx] = val;
 }
 
@@ -3857,9 +3979,14 @@ set_char_table_extras (Lisp_Object table, ptrdiff_t idx, Lisp_Object val)
 set_char_table_contents (Lisp_Object table, ptrdiff_t idx, Lisp_Object val)
 {
   eassert (0 <= idx && idx < (1 << CHARTAB_SIZE_BITS_0));
+  if (!BASE_EQ (XCHAR_TABLE (table)->contents[idx], val))
+    char_table_modified (table);
   XCHAR_TABLE (table)->contents[idx] = val;
 }
 
+/* The caller must call char_table_modified on the char-table TABLE
+   belongs to if this changes its values.  */
+
 INLINE void
 set_sub_char_table_contents (Lisp_Object table, ptrdiff_t idx, Lisp_Object val)
 {
@@ -4005,6 +4132,9 @@ #define CONS_TO_INTEGER(cons, type, var)				\
 struct charset;
 
 /* Defined in syntax.c.  */
+extern void flush_parse_state_cache (struct buffer *, ptrdiff_t);
+extern void free_parse_state_cache (struct buffer *);
+extern void mark_parse_state_cache (struct buffer *);
 extern void init_syntax_once (void);
 extern void syms_of_syntax (void);
 
@@ -4037,6 +4167,8 @@ #define CONS_TO_INTEGER(cons, type, var)				\
 extern Lisp_Object concat3 (Lisp_Object, Lisp_Object, Lisp_Object);
 extern bool equal_no_quit (Lisp_Object, Lisp_Object);
 extern Lisp_Object nconc2 (Lisp_Object, Lisp_Object);
+extern Lisp_Object statistics_alist (int, short const *, intmax_t const *,
+				     int, short const *, double const *);
 extern Lisp_Object assq_no_quit (Lisp_Object, Lisp_Object);
 extern Lisp_Object assoc_no_quit (Lisp_Object, Lisp_Object);
 extern void clear_string_char_byte_cache (void);
@@ -4715,6 +4847,23 @@ XMODULE_FUNCTION (Lisp_Object o)
 extern ptrdiff_t buf_bytepos_to_charpos (struct buffer *, ptrdiff_t);
 extern void detach_marker (Lisp_Object);
 extern void unchain_marker (struct Lisp_Marker *);
+extern void chain_marker (struct Lisp_Marker *, struct buffer *);
+extern void reposition_marker (struct Lisp_Marker *, ptrdiff_t, ptrdiff_t);
+extern void unindex_marker (struct Lisp_Marker *);
+extern bool markers_in_range_p (struct buffer *, ptrdiff_t, ptrdiff_t);
+extern void free_marker_index (struct buffer *);
+extern bool marker_index_adjust_for_insert (struct buffer *, ptrdiff_t,
+					    ptrdiff_t, ptrdiff_t, ptrdiff_t,
+					    bool);
+extern void marker_index_adjust_for_delete (struct buffer *, ptrdiff_t,
+					    ptrdiff_t, ptrdiff_t, ptrdiff_t);
+extern void marker_index_adjust_for_replace (struct buffer *, ptrdiff_t,
+					     ptrdiff_t, ptrdiff_t, ptrdiff_t,
+					     ptrdiff_t, ptrdiff_t);
+extern void free_position_index (struct buffer *);
+extern void adjust_position_index (struct buffer *, ptrdiff_t,
+				   ptrdiff_t, ptrdiff_t,
+				   ptrdiff_t, ptrdiff_t);
 extern Lisp_Object set_marker_restricted (Lisp_Object, Lisp_Object, Lisp_Object);
 extern Lisp_Object set_marker_both (Lisp_Object, Lisp_Object, ptrdiff_t, ptrdiff_t);
 extern Lisp_Object set_marker_restricted_both (Lisp_Object, Lisp_Object,
@@ -4801,6 +4950,7 @@ fast_string_match_ignore_case (Lisp_Object regexp, Lisp_Object string)
 extern void set_initial_minibuffer_mode (void);
 extern void syms_of_minibuf (void);
 extern void barf_if_interaction_inhibited (void);
+extern ptrdiff_t completion_index_size (Lisp_Object);
 
 /* Defined in callint.c.  */
 
@@ -4853,8 +5003,16 @@ fast_string_match_ignore_case (Lisp_Object regexp, Lisp_Object string)
 extern ptrdiff_t current_column (void);
 extern void invalidate_current_column (void);
 extern bool indented_beyond_p (ptrdiff_t, ptrdiff_t, EMACS_INT);
+extern void flush_column_cache (struct buffer *, ptrdiff_t);
+extern void free_column_cache (struct buffer *);
+extern void mark_column_cache (struct buffer *);
 extern void syms_of_indent (void);
 
+/* Defined in bidi.c.  */
+extern void flush_bidi_dir_cache (struct buffer *, ptrdiff_t);
+extern void free_bidi_dir_cache (struct buffer *);
+extern void mark_bidi_dir_cache (struct buffer *);
+
 /* Defined in frame.c.  */
 extern void store_frame_param (struct frame *, Lisp_Object, Lisp_Object);
 extern void store_in_alist (Lisp_Object *, Lisp_Object, Lisp_Object);
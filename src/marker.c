@@ -20,6 +20,8 @@
 
 #include <config.h>
 
+#include <stdlib.h>
+
 #include "lisp.h"
 #include "character.h"
 #include "buffer.h"
@@ -76,6 +78,867 @@ clear_charpos_cache (struct buffer *b)
     cached_buffer = 0;
 }
 
+/* The marker index.
+
+   Besides the unordered chain BUF_MARKERS, the markers of a buffer
+   text are kept sorted by position in an array of chunks, described
+   by struct marker_index in lisp.h.  Every chunk has a displacement
+   that is added to the positions stored in its markers, and the
+   chunks after the index's gap are displaced further by the gap's
+   own displacement.  An insertion or deletion therefore only visits
+   the markers of the chunks that straddle the change, moves the gap
+   to just after them, and records the size of the change there.
+   Since the index is sorted, the markers nearest to a position are
+   found by binary search when converting between character and byte
+   positions.
+
+   The index is built lazily, the first time it is needed, from the
+   chain.  A marker that is not in an index has a null CHUNK, and its
+   CHARPOS and BYTEPOS fields are its actual position.  */
+
+/* Return the position of M, in bytes if BYTE, else in characters.  */
+
+static ptrdiff_t
+marker_pos (struct Lisp_Marker *m, bool byte)
+{
+  return byte ? marker_bytepos (m) : marker_charpos (m);
+}
+
+/* Store marker M in slot SLOT of chunk C, at CHARPOS and BYTEPOS.  */
+
+static void
+put_marker (struct marker_chunk *c, int slot, struct Lisp_Marker *m,
+	    ptrdiff_t charpos, ptrdiff_t bytepos)
+{
+  c->markers[slot] = m;
+  m->chunk = c;
+  m->slot = slot;
+  m->charpos = charpos - marker_chunk_charpos_delta (c);
+  m->bytepos = bytepos - marker_chunk_bytepos_delta (c);
+}
+
+/* Return the index of the first chunk of IX whose last marker is at
+   POS or after it, or IX->nchunks if there is none.  POS is in bytes
+   if BYTE, else in characters.  */
+
+static ptrdiff_t
+chunk_at_or_after (struct marker_index *ix, ptrdiff_t pos, bool byte)
+{
+  ptrdiff_t lo = 0, hi = ix->nchunks;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      struct marker_chunk *c = ix->chunks[mid];
+
+      if (marker_pos (c->markers[c->count - 1], byte) < pos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Return the index of the first chunk of IX whose first marker is
+   after character position CHARPOS, or IX->nchunks if there is
+   none.  */
+
+static ptrdiff_t
+chunk_after (struct marker_index *ix, ptrdiff_t charpos)
+{
+  ptrdiff_t lo = 0, hi = ix->nchunks;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+
+      if (marker_charpos (ix->chunks[mid]->markers[0]) <= charpos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Return the first slot of chunk C whose marker is at POS or after
+   it, or C->count if there is none.  */
+
+static int
+slot_at_or_after (struct marker_chunk *c, ptrdiff_t pos, bool byte)
+{
+  int lo = 0, hi = c->count;
+
+  pos -= (byte
+	  ? marker_chunk_bytepos_delta (c)
+	  : marker_chunk_charpos_delta (c));
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if ((byte ? c->markers[mid]->bytepos : c->markers[mid]->charpos) < pos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Move the gap of IX so that it is just before chunk GAP.  */
+
+static void
+move_marker_gap (struct marker_index *ix, ptrdiff_t gap)
+{
+  for (; ix->gap < gap; ix->gap++)
+    {
+      struct marker_chunk *c = ix->chunks[ix->gap];
+      c->charpos_delta += ix->gap_chars;
+      c->bytepos_delta += ix->gap_bytes;
+    }
+  for (; ix->gap > gap; ix->gap--)
+    {
+      struct marker_chunk *c = ix->chunks[ix->gap - 1];
+      c->charpos_delta -= ix->gap_chars;
+      c->bytepos_delta -= ix->gap_bytes;
+    }
+  if (ix->gap == ix->nchunks)
+    ix->gap_chars = ix->gap_bytes = 0;
+}
+
+/* Insert a new, empty chunk into IX at index K, and return it.  Its
+   displacement is such that it can hold markers with the same stored
+   positions as the chunk before it.  */
+
+static struct marker_chunk *
+insert_marker_chunk (struct marker_index *ix, ptrdiff_t k)
+{
+  struct marker_chunk *c = xmalloc (sizeof *c);
+
+  if (ix->nchunks == ix->size)
+    ix->chunks = xpalloc (ix->chunks, &ix->size, 1, -1, sizeof *ix->chunks);
+  memmove (ix->chunks + k + 1, ix->chunks + k,
+	   (ix->nchunks - k) * sizeof *ix->chunks);
+  ix->chunks[k] = c;
+  ix->nchunks++;
+  for (ptrdiff_t i = k; i < ix->nchunks; i++)
+    ix->chunks[i]->idx = i;
+  if (ix->gap >= k)
+    ix->gap++;
+
+  c->index = ix;
+  c->count = 0;
+  c->charpos_delta = k == 0 ? 0 : ix->chunks[k - 1]->charpos_delta;
+  c->bytepos_delta = k == 0 ? 0 : ix->chunks[k - 1]->bytepos_delta;
+  return c;
+}
+
+/* Remove chunk C from its index and free it.  */
+
+static void
+remove_marker_chunk (struct marker_chunk *c)
+{
+  struct marker_index *ix = c->index;
+  ptrdiff_t k = c->idx;
+
+  ix->nchunks--;
+  memmove (ix->chunks + k, ix->chunks + k + 1,
+	   (ix->nchunks - k) * sizeof *ix->chunks);
+  for (ptrdiff_t i = k; i < ix->nchunks; i++)
+    ix->chunks[i]->idx = i;
+  if (ix->gap > k)
+    ix->gap--;
+  xfree (c);
+}
+
+/* Add marker M, which is not in any index, to IX.  */
+
+static void
+index_marker (struct marker_index *ix, struct Lisp_Marker *m)
+{
+  ptrdiff_t charpos = m->charpos, bytepos = m->bytepos;
+  struct marker_chunk *c;
+  int slot;
+
+  if (ix->nchunks == 0)
+    {
+      c = insert_marker_chunk (ix, 0);
+      slot = 0;
+    }
+  else
+    {
+      ptrdiff_t k = chunk_at_or_after (ix, charpos, false);
+      c = ix->chunks[k < ix->nchunks ? k : k - 1];
+      slot = slot_at_or_after (c, charpos, false);
+
+      if (c->count == MARKER_CHUNK_SIZE)
+	{
+	  /* Split C in two.  */
+	  struct marker_chunk *d = insert_marker_chunk (ix, c->idx + 1);
+	  int half = c->count / 2;
+
+	  eassert (d->charpos_delta == c->charpos_delta);
+	  d->count = c->count - half;
+	  memcpy (d->markers, c->markers + half,
+		  d->count * sizeof *d->markers);
+	  c->count = half;
+	  for (int i = 0; i < d->count; i++)
+	    {
+	      d->markers[i]->chunk = d;
+	      d->markers[i]->slot = i;
+	    }
+	  if (slot > half)
+	    {
+	      c = d;
+	      slot -= half;
+	    }
+	}
+    }
+
+  memmove (c->markers + slot + 1, c->markers + slot,
+	   (c->count - slot) * sizeof *c->markers);
+  c->count++;
+  for (int i = slot + 1; i < c->count; i++)
+    c->markers[i]->slot = i;
+  put_marker (c, slot, m, charpos, bytepos);
+}
+
+/* Remove marker M from its index, leaving its position intact.  */
+
+void
+unindex_marker (struct Lisp_Marker *m)
+{
+  struct marker_chunk *c = m->chunk;
+  struct marker_index *ix = c->index;
+
+  m->charpos = marker_charpos (m);
+  m->bytepos = marker_bytepos (m);
+  m->chunk = NULL;
+
+  c->count--;
+  memmove (c->markers + m->slot, c->markers + m->slot + 1,
+	   (c->count - m->slot) * sizeof *c->markers);
+  for (int i = m->slot; i < c->count; i++)
+    c->markers[i]->slot = i;
+
+  if (c->count == 0)
+    remove_marker_chunk (c);
+  else if (c->count < MARKER_CHUNK_SIZE / 4 && c->idx + 1 < ix->nchunks)
+    {
+      /* Merge C with the next chunk if both are sparse.  */
+      struct marker_chunk *d = ix->chunks[c->idx + 1];
+
+      if (c->count + d->count <= MARKER_CHUNK_SIZE / 2)
+	{
+	  for (int i = 0; i < d->count; i++)
+	    {
+	      struct Lisp_Marker *dm = d->markers[i];
+	      put_marker (c, c->count + i, dm,
+			  marker_charpos (dm), marker_bytepos (dm));
+	    }
+	  c->count += d->count;
+	  remove_marker_chunk (d);
+	}
+    }
+}
+
+static int
+compare_marker_positions (void const *a, void const *b)
+{
+  ptrdiff_t pa = (*(struct Lisp_Marker *const *) a)->charpos;
+  ptrdiff_t pb = (*(struct Lisp_Marker *const *) b)->charpos;
+  return (pa > pb) - (pa < pb);
+}
+
+/* Return the marker index of buffer text T, building it from T's
+   marker chain if necessary.  Return NULL if T has no markers.  */
+
+static struct marker_index *
+get_marker_index (struct buffer_text *t)
+{
+  if (!t->marker_index && t->markers)
+    {
+      struct marker_index *ix = xzalloc (sizeof *ix);
+      struct Lisp_Marker *m, **v;
+      ptrdiff_t n = 0, i;
+
+      for (m = t->markers; m; m = m->next)
+	n++;
+      v = xnmalloc (n, sizeof *v);
+      for (m = t->markers, i = 0; m; m = m->next)
+	v[i++] = m;
+      qsort (v, n, sizeof *v, compare_marker_positions);
+
+      /* Leave room in every chunk for later additions.  */
+      for (i = 0; i < n; )
+	{
+	  struct marker_chunk *c = insert_marker_chunk (ix, ix->nchunks);
+	  for (; c->count < MARKER_CHUNK_SIZE / 2 && i < n; c->count++, i++)
+	    put_marker (c, c->count, v[i], v[i]->charpos, v[i]->bytepos);
+	}
+      xfree (v);
+      t->marker_index = ix;
+    }
+  return t->marker_index;
+}
+
+/* Free the marker index of buffer B's text, if any.  The markers keep
+   their positions; the index is rebuilt when it is next needed.  */
+
+void
+free_marker_index (struct buffer *b)
+{
+  struct marker_index *ix = b->text->marker_index;
+
+  if (ix)
+    {
+      for (ptrdiff_t k = 0; k < ix->nchunks; k++)
+	{
+	  struct marker_chunk *c = ix->chunks[k];
+	  for (int i = 0; i < c->count; i++)
+	    {
+	      struct Lisp_Marker *m = c->markers[i];
+	      m->charpos = marker_charpos (m);
+	      m->bytepos = marker_bytepos (m);
+	      m->chunk = NULL;
+	    }
+	}
+      for (ptrdiff_t k = 0; k < ix->nchunks; k++)
+	xfree (ix->chunks[k]);
+      xfree (ix->chunks);
+      xfree (ix);
+      b->text->marker_index = NULL;
+    }
+}
+
+/* Make marker M, which points nowhere, point into buffer B, at the
+   position stored in it.  */
+
+void
+chain_marker (struct Lisp_Marker *m, struct buffer *b)
+{
+  eassert (!m->buffer && !m->chunk);
+  m->buffer = b;
+  m->next = BUF_MARKERS (b);
+  BUF_MARKERS (b) = m;
+  if (b->text->marker_index)
+    index_marker (b->text->marker_index, m);
+}
+
+/* Move marker M, which points somewhere, to CHARPOS and BYTEPOS in
+   its buffer.  */
+
+void
+reposition_marker (struct Lisp_Marker *m, ptrdiff_t charpos,
+		   ptrdiff_t bytepos)
+{
+  struct marker_chunk *c = m->chunk;
+
+  if (c)
+    {
+      struct marker_index *ix = c->index;
+      struct marker_chunk *pc = (m->slot > 0 || c->idx == 0
+				 ? c : ix->chunks[c->idx - 1]);
+      struct marker_chunk *nc = (m->slot + 1 < c->count
+				 || c->idx + 1 == ix->nchunks
+				 ? c : ix->chunks[c->idx + 1]);
+      struct Lisp_Marker *prev
+	= (m->slot > 0 ? c->markers[m->slot - 1]
+	   : pc != c ? pc->markers[pc->count - 1] : NULL);
+      struct Lisp_Marker *next
+	= (m->slot + 1 < c->count ? c->markers[m->slot + 1]
+	   : nc != c ? nc->markers[0] : NULL);
+
+      if ((prev && marker_charpos (prev) > charpos)
+	  || (next && marker_charpos (next) < charpos))
+	{
+	  /* M would be out of order where it is.  */
+	  unindex_marker (m);
+	  m->charpos = charpos;
+	  m->bytepos = bytepos;
+	  index_marker (ix, m);
+	}
+      else
+	{
+	  m->charpos = charpos - marker_chunk_charpos_delta (c);
+	  m->bytepos = bytepos - marker_chunk_bytepos_delta (c);
+	}
+    }
+  else
+    {
+      m->charpos = charpos;
+      m->bytepos = bytepos;
+    }
+}
+
+/* Adjust the markers of buffer B for an insertion that stretches from
+   FROM / FROM_BYTE to TO / TO_BYTE.  A marker at FROM advances if its
+   insertion type is t or BEFORE_MARKERS is true.  Return true if any
+   marker advanced because of its insertion type.  */
+
+bool
+marker_index_adjust_for_insert (struct buffer *b,
+				ptrdiff_t from, ptrdiff_t from_byte,
+				ptrdiff_t to, ptrdiff_t to_byte,
+				bool before_markers)
+{
+  struct marker_index *ix = get_marker_index (b->text);
+  ptrdiff_t nchars = to - from, nbytes = to_byte - from_byte;
+  bool adjusted = false;
+
+  if (!ix)
+    return false;
+
+  /* Chunks K0 up to K1 contain markers at FROM, and possibly markers
+     after FROM in the last of them.  Chunks from K1 on contain only
+     markers after FROM.  */
+  ptrdiff_t k0 = chunk_at_or_after (ix, from, false);
+  ptrdiff_t k1 = chunk_after (ix, from);
+  move_marker_gap (ix, k1);
+
+  if (k0 < k1)
+    {
+      int first = slot_at_or_after (ix->chunks[k0], from, false);
+      ptrdiff_t run = 0, nmovers = 0;
+      ptrdiff_t k = k0;
+      int s = first;
+
+      /* Find the markers at FROM.  */
+      for (; k < k1; k++, s = 0)
+	{
+	  struct marker_chunk *c = ix->chunks[k];
+	  for (; s < c->count; s++)
+	    {
+	      struct Lisp_Marker *m = c->markers[s];
+	      if (m->charpos + marker_chunk_charpos_delta (c) != from)
+		break;
+	      run++;
+	      if (m->insertion_type || before_markers)
+		nmovers++;
+	      if (m->insertion_type)
+		adjusted = true;
+	    }
+	  if (s < c->count)
+	    break;
+	}
+
+      /* Relocate the markers after them.  */
+      for (; k < k1; k++, s = 0)
+	{
+	  struct marker_chunk *c = ix->chunks[k];
+	  for (; s < c->count; s++)
+	    {
+	      c->markers[s]->charpos += nchars;
+	      c->markers[s]->bytepos += nbytes;
+	    }
+	}
+
+      /* Advance the markers at FROM that should advance, keeping them
+	 after the ones that stay.  */
+      if (nmovers > 0)
+	{
+	  USE_SAFE_ALLOCA;
+	  struct Lisp_Marker **v;
+	  ptrdiff_t i, nstayers = 0, imover = run - nmovers;
+
+	  SAFE_NALLOCA (v, 1, run);
+	  for (k = k0, s = first, i = 0; i < run; s++)
+	    {
+	      if (s == ix->chunks[k]->count)
+		k++, s = 0;
+	      struct Lisp_Marker *m = ix->chunks[k]->markers[s];
+	      if (m->insertion_type || before_markers)
+		v[imover++] = m;
+	      else
+		v[nstayers++] = m;
+	      i++;
+	    }
+	  for (k = k0, s = first, i = 0; i < run; s++, i++)
+	    {
+	      if (s == ix->chunks[k]->count)
+		k++, s = 0;
+	      if (i < nstayers)
+		put_marker (ix->chunks[k], s, v[i], from, from_byte);
+	      else
+		put_marker (ix->chunks[k], s, v[i], to, to_byte);
+	    }
+	  SAFE_FREE ();
+	}
+    }
+
+  ix->gap_chars += nchars;
+  ix->gap_bytes += nbytes;
+  return adjusted;
+}
+
+/* Adjust the markers of buffer B for the deletion of the text from
+   FROM / FROM_BYTE to TO / TO_BYTE.  */
+
+void
+marker_index_adjust_for_delete (struct buffer *b,
+				ptrdiff_t from, ptrdiff_t from_byte,
+				ptrdiff_t to, ptrdiff_t to_byte)
+{
+  struct marker_index *ix = get_marker_index (b->text);
+
+  if (!ix)
+    return;
+
+  ptrdiff_t k0 = chunk_at_or_after (ix, from + 1, false);
+  ptrdiff_t k1 = chunk_after (ix, to);
+  move_marker_gap (ix, k1);
+
+  for (ptrdiff_t k = k0; k < k1; k++)
+    {
+      struct marker_chunk *c = ix->chunks[k];
+      for (int s = k == k0 ? slot_at_or_after (c, from + 1, false) : 0;
+	   s < c->count; s++)
+	{
+	  struct Lisp_Marker *m = c->markers[s];
+	  if (marker_charpos (m) > to)
+	    {
+	      m->charpos -= to - from;
+	      m->bytepos -= to_byte - from_byte;
+	    }
+	  else
+	    put_marker (c, s, m, from, from_byte);
+	}
+    }
+
+  ix->gap_chars -= to - from;
+  ix->gap_bytes -= to_byte - from_byte;
+}
+
+/* Adjust the markers of buffer B for the replacement of OLD_CHARS
+   characters (OLD_BYTES bytes) at FROM / FROM_BYTE by NEW_CHARS
+   characters (NEW_BYTES bytes).  Markers inside the replaced text
+   move to FROM.  Markers at FROM stay there, unless OLD_CHARS is 0,
+   in which case they advance past the new text.  */
+
+void
+marker_index_adjust_for_replace (struct buffer *b,
+				 ptrdiff_t from, ptrdiff_t from_byte,
+				 ptrdiff_t old_chars, ptrdiff_t old_bytes,
+				 ptrdiff_t new_chars, ptrdiff_t new_bytes)
+{
+  struct marker_index *ix = get_marker_index (b->text);
+  ptrdiff_t prev_to = from + old_chars;
+
+  if (!ix)
+    return;
+
+  /* Visit the markers at FROM too, since they are at PREV_TO when
+     OLD_CHARS is 0.  */
+  ptrdiff_t k0 = chunk_at_or_after (ix, from, false);
+  ptrdiff_t k1 = chunk_after (ix, prev_to - 1);
+  move_marker_gap (ix, k1);
+
+  for (ptrdiff_t k = k0; k < k1; k++)
+    {
+      struct marker_chunk *c = ix->chunks[k];
+      for (int s = k == k0 ? slot_at_or_after (c, from, false) : 0;
+	   s < c->count; s++)
+	{
+	  struct Lisp_Marker *m = c->markers[s];
+	  if (marker_charpos (m) >= prev_to)
+	    {
+	      m->charpos += new_chars - old_chars;
+	      m->bytepos += new_bytes - old_bytes;
+	    }
+	  else
+	    put_marker (c, s, m, from, from_byte);
+	}
+    }
+
+  ix->gap_chars += new_chars - old_chars;
+  ix->gap_bytes += new_bytes - old_bytes;
+}
+
+/* Return true if buffer B has a marker at a position between FROM and
+   TO inclusive.  */
+
+bool
+markers_in_range_p (struct buffer *b, ptrdiff_t from, ptrdiff_t to)
+{
+  struct marker_index *ix = get_marker_index (b->text);
+
+  if (ix)
+    {
+      ptrdiff_t k = chunk_at_or_after (ix, from, false);
+      if (k == ix->nchunks)
+	return false;
+      struct marker_chunk *c = ix->chunks[k];
+      int s = slot_at_or_after (c, from, false);
+      return marker_charpos (c->markers[s]) <= to;
+    }
+  return false;
+}
+
+/* Return in *BELOW and *ABOVE the markers of buffer B nearest to POS,
+   before it and at or after it, or NULL if there are none.  POS is in
+   bytes if BYTE, else in characters.  */
+
+static void
+nearest_markers (struct buffer *b, ptrdiff_t pos, bool byte,
+		 struct Lisp_Marker **below, struct Lisp_Marker **above)
+{
+  struct marker_index *ix = get_marker_index (b->text);
+
+  *below = *above = NULL;
+  if (ix && ix->nchunks > 0)
+    {
+      ptrdiff_t k = chunk_at_or_after (ix, pos, byte);
+      if (k < ix->nchunks)
+	{
+	  struct marker_chunk *c = ix->chunks[k];
+	  int s = slot_at_or_after (c, pos, byte);
+	  *above = c->markers[s];
+	  if (s > 0)
+	    *below = c->markers[s - 1];
+	  else if (k > 0)
+	    *below = ix->chunks[k - 1]->markers[ix->chunks[k - 1]->count - 1];
+	}
+      else
+	{
+	  struct marker_chunk *c = ix->chunks[k - 1];
+	  *below = c->markers[c->count - 1];
+	}
+    }
+}
+
+/* The position index.
+
+   A multibyte buffer text whose character and byte positions have
+   been converted across long distances gets a sorted array of
+   checkpoints, known correspondences between character and byte
+   positions.  The array is first filled with a checkpoint every
+   CHECKPOINT_INTERVAL bytes, by a single scan of the whole text.
+   Insertions and deletions keep the checkpoints valid, and a
+   conversion that still has to scan a long way records the position
+   it found as a new checkpoint.  Like the marker index, the array has
+   a gap: the checkpoints from index GAP on are displaced by GAP_CHARS
+   and GAP_BYTES, so an edit only shifts the checkpoints between it and
+   the previous edit.  */
+
+enum { CHECKPOINT_INTERVAL = 8 * 1024 };
+
+struct position_checkpoint
+{
+  ptrdiff_t charpos, bytepos;
+};
+
+struct position_index
+{
+  struct position_checkpoint *v;
+  ptrdiff_t n, size;
+  ptrdiff_t gap, gap_chars, gap_bytes;
+
+  /* The number of conversions that consulted the index, and the total
+     number of characters or bytes they scanned.  */
+  EMACS_INT lookups, scanned;
+};
+
+static ptrdiff_t
+checkpoint_pos (struct position_index *px, ptrdiff_t i, bool byte)
+{
+  return (byte
+	  ? px->v[i].bytepos + (i < px->gap ? 0 : px->gap_bytes)
+	  : px->v[i].charpos + (i < px->gap ? 0 : px->gap_chars));
+}
+
+/* Return the index of the first checkpoint of PX at POS or after it,
+   or PX->n if there is none.  POS is in bytes if BYTE, else in
+   characters.  */
+
+static ptrdiff_t
+checkpoint_at_or_after (struct position_index *px, ptrdiff_t pos, bool byte)
+{
+  ptrdiff_t lo = 0, hi = px->n;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+
+      if (checkpoint_pos (px, mid, byte) < pos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Move the gap of PX so that it is just before checkpoint GAP.  */
+
+static void
+move_checkpoint_gap (struct position_index *px, ptrdiff_t gap)
+{
+  for (; px->gap < gap; px->gap++)
+    {
+      px->v[px->gap].charpos += px->gap_chars;
+      px->v[px->gap].bytepos += px->gap_bytes;
+    }
+  for (; px->gap > gap; px->gap--)
+    {
+      px->v[px->gap - 1].charpos -= px->gap_chars;
+      px->v[px->gap - 1].bytepos -= px->gap_bytes;
+    }
+  if (px->gap == px->n)
+    px->gap_chars = px->gap_bytes = 0;
+}
+
+/* Record in PX that CHARPOS corresponds to BYTEPOS.  */
+
+static void
+add_checkpoint (struct position_index *px, ptrdiff_t charpos,
+		ptrdiff_t bytepos)
+{
+  ptrdiff_t i = checkpoint_at_or_after (px, charpos, false);
+
+  if (i < px->n && checkpoint_pos (px, i, false) == charpos)
+    return;
+  if (px->n == px->size)
+    px->v = xpalloc (px->v, &px->size, 1, -1, sizeof *px->v);
+  memmove (px->v + i + 1, px->v + i, (px->n - i) * sizeof *px->v);
+  px->n++;
+  if (px->gap >= i)
+    px->gap++;
+  else
+    {
+      charpos -= px->gap_chars;
+      bytepos -= px->gap_bytes;
+    }
+  px->v[i].charpos = charpos;
+  px->v[i].bytepos = bytepos;
+}
+
+/* Return the number of characters in the multibyte text of buffer B
+   from FROM_BYTE to TO_BYTE, which must be character boundaries.  */
+
+static ptrdiff_t
+count_chars_between (struct buffer *b, ptrdiff_t from_byte,
+		     ptrdiff_t to_byte)
+{
+  ptrdiff_t gpt_byte = BUF_GPT_BYTE (b);
+  ptrdiff_t nchars = 0;
+
+  while (from_byte < to_byte)
+    {
+      ptrdiff_t end = (from_byte < gpt_byte && gpt_byte < to_byte
+		       ? gpt_byte : to_byte);
+      unsigned char const *p = BUF_BYTE_ADDRESS (b, from_byte);
+
+      /* Every character starts with exactly one byte that is not a
+	 continuation byte.  */
+      for (ptrdiff_t i = 0; i < end - from_byte; i++)
+	nchars += (p[i] & 0xC0) != 0x80;
+      from_byte = end;
+    }
+  return nchars;
+}
+
+/* Build the position index of buffer B by scanning its text.  */
+
+static struct position_index *
+build_position_index (struct buffer *b)
+{
+  struct position_index *px = xzalloc (sizeof *px);
+  ptrdiff_t charpos = BUF_BEG (b), bytepos = BUF_BEG_BYTE (b);
+  ptrdiff_t z_byte = BUF_Z_BYTE (b);
+
+  while (z_byte - bytepos > CHECKPOINT_INTERVAL)
+    {
+      ptrdiff_t next = bytepos + CHECKPOINT_INTERVAL;
+
+      while (next < z_byte && !CHAR_HEAD_P (BUF_FETCH_BYTE (b, next)))
+	next++;
+      charpos += count_chars_between (b, bytepos, next);
+      bytepos = next;
+
+      if (px->n == px->size)
+	px->v = xpalloc (px->v, &px->size, 1, -1, sizeof *px->v);
+      px->v[px->n].charpos = charpos;
+      px->v[px->n].bytepos = bytepos;
+      px->n++;
+    }
+  px->gap = px->n;
+  b->text->position_index = px;
+  return px;
+}
+
+/* Free the position index of buffer B's text, if any.  */
+
+void
+free_position_index (struct buffer *b)
+{
+  struct position_index *px = b->text->position_index;
+
+  if (px)
+    {
+      xfree (px->v);
+      xfree (px);
+      b->text->position_index = NULL;
+    }
+}
+
+/* Update the position index of buffer B for the replacement of
+   OLD_CHARS characters (OLD_BYTES bytes) at FROM by NEW_CHARS
+   characters (NEW_BYTES bytes).  An insertion replaces no characters
+   and a deletion inserts none.  */
+
+void
+adjust_position_index (struct buffer *b, ptrdiff_t from,
+		       ptrdiff_t old_chars, ptrdiff_t old_bytes,
+		       ptrdiff_t new_chars, ptrdiff_t new_bytes)
+{
+  struct position_index *px = b->text->position_index;
+
+  if (!px)
+    return;
+
+  /* Drop the checkpoints inside the replaced text, and shift the ones
+     after it.  */
+  ptrdiff_t i0 = checkpoint_at_or_after (px, from + 1, false);
+  ptrdiff_t i1 = max (i0, checkpoint_at_or_after (px, from + old_chars,
+						   false));
+  move_checkpoint_gap (px, i1);
+  if (i0 < i1)
+    {
+      memmove (px->v + i0, px->v + i1, (px->n - i1) * sizeof *px->v);
+      px->n -= i1 - i0;
+      px->gap = i0;
+    }
+  px->gap_chars += new_chars - old_chars;
+  px->gap_bytes += new_bytes - old_bytes;
+}
+
+DEFUN ("buffer-position-index-statistics", Fbuffer_position_index_statistics,
+       Sbuffer_position_index_statistics, 0, 1, 0,
+       doc: /* Return statistics about the position index of BUFFER.
+BUFFER defaults to the current buffer.
+
+The position index records correspondences between character and byte
+positions of a multibyte buffer, to speed up conversions between them
+in large buffers.  The value is nil if BUFFER has no index, else an
+alist with the following elements:
+
+  (checkpoints . N)   the number of correspondences in the index
+  (interval . BYTES)  the distance between them when the index was built
+  (lookups . N)       the number of conversions that used the index
+  (scanned . N)       the total distance those conversions scanned
+
+Buffers get an index the first time a conversion has to scan a long
+stretch of text.  */)
+  (Lisp_Object buffer)
+{
+  struct buffer *b = decode_buffer (buffer);
+  struct position_index *px = b->text->position_index;
+
+  if (!px)
+    return Qnil;
+  return list4 (Fcons (Qcheckpoints, make_int (px->n)),
+		Fcons (Qinterval, make_fixnum (CHECKPOINT_INTERVAL)),
+		Fcons (Qlookups, make_int (px->lookups)),
+		Fcons (Qscanned, make_int (px->scanned)));
+}
+
 /* Converting between character positions and byte positions.  */
 
 /* There are several places in the buffer where we know
@@ -133,37 +996,21 @@ CHECK_MARKER (Lisp_Object x)
   CHECK_TYPE (MARKERP (x), Qmarkerp, x);
 }
 
-/* When converting bytes from/to chars, we look through the list of
-   markers to try and find a good starting point (since markers keep
-   track of both bytepos and charpos at the same time).
-   But if there are many markers, it can take too much time to find a "good"
-   marker from which to start.  Worse yet: if it takes a long time and we end
-   up finding a nearby markers, we won't add a new marker to cache this
-   result, so next time around we'll have to go through this same long list
-   to (re)find this best marker.  So the further down the list of
-   markers we go, the less demanding we are w.r.t what is a good marker.
-
-   The previous code used INITIAL=50 and INCREMENT=0 and this lead to
-   really poor performance when there are many markers.
-   I haven't tried to tweak INITIAL, but experiments on my trusty Thinkpad
-   T61 using various artificial test cases seem to suggest that INCREMENT=50
-   might be "the best compromise": it significantly improved the
-   worst case and it was rarely slower and never by much.
-
-   The asymptotic behavior is still poor, tho, so in largish buffers with many
-   overlays (e.g. 300KB and 30K overlays), it can still be a bottleneck.  */
-#define BYTECHAR_DISTANCE_INITIAL 50
-#define BYTECHAR_DISTANCE_INCREMENT 50
+/* When converting bytes from/to chars, we use the markers of the
+   buffer as starting points, since markers keep track of both bytepos
+   and charpos at the same time.  The marker index gives us the two
+   markers nearest to the position directly, however many markers the
+   buffer has.  */
 
 /* Return the byte position corresponding to CHARPOS in B.  */
 
 ptrdiff_t
 buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
 {
-  struct Lisp_Marker *tail;
+  struct Lisp_Marker *below, *above;
+  struct position_index *px;
   ptrdiff_t best_above, best_above_byte;
   ptrdiff_t best_below, best_below_byte;
-  ptrdiff_t distance = BYTECHAR_DISTANCE_INITIAL;
 
   eassert (BUF_BEG (b) <= charpos && charpos <= BUF_Z (b));
 
@@ -196,18 +1043,28 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
   if (b == cached_buffer && BUF_MODIFF (b) == cached_modiff)
     CONSIDER (cached_charpos, cached_bytepos);
 
-  for (tail = BUF_MARKERS (b); tail; tail = tail->next)
+  nearest_markers (b, charpos, false, &below, &above);
+  if (above)
+    CONSIDER (marker_charpos (above), marker_bytepos (above));
+  if (below)
+    CONSIDER (marker_charpos (below), marker_bytepos (below));
+
+  px = b->text->position_index;
+  if (!px
+      && charpos - best_below > CHECKPOINT_INTERVAL
+      && best_above - charpos > CHECKPOINT_INTERVAL)
+    px = build_position_index (b);
+  if (px)
     {
-      CONSIDER (tail->charpos, tail->bytepos);
-
-      /* If we are down to a range of 50 chars,
-	 don't bother checking any other markers;
-	 scan the intervening chars directly now.  */
-      if (best_above - charpos < distance
-          || charpos - best_below < distance)
-	break;
-      else
-        distance += BYTECHAR_DISTANCE_INCREMENT;
+      ptrdiff_t i = checkpoint_at_or_after (px, charpos, false);
+
+      px->lookups++;
+      if (i < px->n)
+	CONSIDER (checkpoint_pos (px, i, false),
+		  checkpoint_pos (px, i, true));
+      if (i > 0)
+	CONSIDER (checkpoint_pos (px, i - 1, false),
+		  checkpoint_pos (px, i - 1, true));
     }
 
   /* We get here if we did not exactly hit one of the known places.
@@ -217,8 +1074,10 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
   eassert (best_below <= charpos && charpos <= best_above);
   if (charpos - best_below < best_above - charpos)
     {
-      bool record = charpos - best_below > 5000;
+      bool record = charpos - best_below > CHECKPOINT_INTERVAL;
 
+      if (px)
+	px->scanned += charpos - best_below;
       while (best_below < charpos)
 	{
 	  best_below++;
@@ -226,10 +1085,9 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
 	}
 
       /* If this position is quite far from the nearest known position,
-	 cache the correspondence by creating a marker here.
-	 It will last until the next GC.  */
-      if (record)
-	build_marker (b, best_below, best_below_byte);
+	 remember the correspondence in the position index.  */
+      if (record && px)
+	add_checkpoint (px, best_below, best_below_byte);
 
       byte_char_debug_check (b, best_below, best_below_byte);
 
@@ -242,8 +1100,10 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
     }
   else
     {
-      bool record = best_above - charpos > 5000;
+      bool record = best_above - charpos > CHECKPOINT_INTERVAL;
 
+      if (px)
+	px->scanned += best_above - charpos;
       while (best_above > charpos)
 	{
 	  best_above--;
@@ -251,10 +1111,9 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
 	}
 
       /* If this position is quite far from the nearest known position,
-	 cache the correspondence by creating a marker here.
-	 It will last until the next GC.  */
-      if (record)
-	build_marker (b, best_above, best_above_byte);
+	 remember the correspondence in the position index.  */
+      if (record && px)
+	add_checkpoint (px, best_above, best_above_byte);
 
       byte_char_debug_check (b, best_above, best_above_byte);
 
@@ -317,10 +1176,10 @@ #define CONSIDER(BYTEPOS, CHARPOS)					\
 ptrdiff_t
 buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
 {
-  struct Lisp_Marker *tail;
+  struct Lisp_Marker *below, *above;
+  struct position_index *px;
   ptrdiff_t best_above, best_above_byte;
   ptrdiff_t best_below, best_below_byte;
-  ptrdiff_t distance = BYTECHAR_DISTANCE_INITIAL;
 
   eassert (BUF_BEG_BYTE (b) <= bytepos && bytepos <= BUF_Z_BYTE (b));
 
@@ -348,18 +1207,28 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
   if (b == cached_buffer && BUF_MODIFF (b) == cached_modiff)
     CONSIDER (cached_bytepos, cached_charpos);
 
-  for (tail = BUF_MARKERS (b); tail; tail = tail->next)
+  nearest_markers (b, bytepos, true, &below, &above);
+  if (above)
+    CONSIDER (marker_bytepos (above), marker_charpos (above));
+  if (below)
+    CONSIDER (marker_bytepos (below), marker_charpos (below));
+
+  px = b->text->position_index;
+  if (!px
+      && bytepos - best_below_byte > CHECKPOINT_INTERVAL
+      && best_above_byte - bytepos > CHECKPOINT_INTERVAL)
+    px = build_position_index (b);
+  if (px)
     {
-      CONSIDER (tail->bytepos, tail->charpos);
-
-      /* If we are down to a range of 50 chars,
-	 don't bother checking any other markers;
-	 scan the intervening chars directly now.  */
-      if (best_above - bytepos < distance
-          || bytepos - best_below < distance)
-	break;
-      else
-        distance += BYTECHAR_DISTANCE_INCREMENT;
+      ptrdiff_t i = checkpoint_at_or_after (px, bytepos, true);
+
+      px->lookups++;
+      if (i < px->n)
+	CONSIDER (checkpoint_pos (px, i, true),
+		  checkpoint_pos (px, i, false));
+      if (i > 0)
+	CONSIDER (checkpoint_pos (px, i - 1, true),
+		  checkpoint_pos (px, i - 1, false));
     }
 
   /* We get here if we did not exactly hit one of the known places.
@@ -368,8 +1237,10 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
 
   if (bytepos - best_below_byte < best_above_byte - bytepos)
     {
-      bool record = bytepos - best_below_byte > 5000;
+      bool record = bytepos - best_below_byte > CHECKPOINT_INTERVAL;
 
+      if (px)
+	px->scanned += bytepos - best_below_byte;
       while (best_below_byte < bytepos)
 	{
 	  best_below++;
@@ -377,12 +1248,9 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
 	}
 
       /* If this position is quite far from the nearest known position,
-	 cache the correspondence by creating a marker here.
-	 It will last until the next GC.
-	 But don't do it if BUF_MARKERS is nil;
-	 that is a signal from Fset_buffer_multibyte.  */
-      if (record && BUF_MARKERS (b))
-	build_marker (b, best_below, best_below_byte);
+	 remember the correspondence in the position index.  */
+      if (record && px)
+	add_checkpoint (px, best_below, best_below_byte);
 
       byte_char_debug_check (b, best_below, best_below_byte);
 
@@ -395,8 +1263,10 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
     }
   else
     {
-      bool record = best_above_byte - bytepos > 5000;
+      bool record = best_above_byte - bytepos > CHECKPOINT_INTERVAL;
 
+      if (px)
+	px->scanned += best_above_byte - bytepos;
       while (best_above_byte > bytepos)
 	{
 	  best_above--;
@@ -404,12 +1274,9 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
 	}
 
       /* If this position is quite far from the nearest known position,
-	 cache the correspondence by creating a marker here.
-	 It will last until the next GC.
-	 But don't do it if BUF_MARKERS is nil;
-	 that is a signal from Fset_buffer_multibyte.  */
-      if (record && BUF_MARKERS (b))
-	build_marker (b, best_above, best_above_byte);
+	 remember the correspondence in the position index.  */
+      if (record && px)
+	add_checkpoint (px, best_above, best_above_byte);
 
       byte_char_debug_check (b, best_above, best_above_byte);
 
@@ -452,7 +1319,7 @@ DEFUN ("marker-position", Fmarker_position, Smarker_position, 1, 1, 0,
 {
   CHECK_MARKER (marker);
   if (XMARKER (marker)->buffer)
-    return make_fixnum (XMARKER (marker)->charpos);
+    return make_fixnum (marker_charpos (XMARKER (marker)));
 
   return Qnil;
 }
@@ -470,15 +1337,14 @@ attach_marker (struct Lisp_Marker *m, struct buffer *b,
   else
     eassert (charpos <= bytepos);
 
-  m->charpos = charpos;
-  m->bytepos = bytepos;
-
-  if (m->buffer != b)
+  if (m->buffer == b)
+    reposition_marker (m, charpos, bytepos);
+  else
     {
       unchain_marker (m);
-      m->buffer = b;
-      m->next = BUF_MARKERS (b);
-      BUF_MARKERS (b) = m;
+      m->charpos = charpos;
+      m->bytepos = bytepos;
+      chain_marker (m, b);
     }
 }
 
@@ -517,10 +1383,8 @@ set_marker_internal (Lisp_Object marker, Lisp_Object position,
      an existing marker, and MARKER is already in the same buffer.  */
   else if (MARKERP (position) && b == XMARKER (position)->buffer
 	   && b == m->buffer)
-    {
-      m->bytepos = XMARKER (position)->bytepos;
-      m->charpos = XMARKER (position)->charpos;
-    }
+    reposition_marker (m, marker_charpos (XMARKER (position)),
+		       marker_bytepos (XMARKER (position)));
 
   else
     {
@@ -544,8 +1408,8 @@ set_marker_internal (Lisp_Object marker, Lisp_Object position,
 	}
       else if (MARKERP (position))
 	{
-	  charpos = XMARKER (position)->charpos;
-	  bytepos = XMARKER (position)->bytepos;
+	  charpos = marker_charpos (XMARKER (position));
+	  bytepos = marker_bytepos (XMARKER (position));
 	}
       else
 	wrong_type_argument (Qinteger_or_marker_p, position);
@@ -657,6 +1521,8 @@ unchain_marker (register struct Lisp_Marker *marker)
       /* No dead buffers here.  */
       eassert (BUFFER_LIVE_P (b));
 
+      if (marker->chunk)
+	unindex_marker (marker);
       marker->buffer = NULL;
       prev = &BUF_MARKERS (b);
 
@@ -694,9 +1560,10 @@ marker_position (Lisp_Object marker)
   if (!buf)
     error ("Marker does not point anywhere");
 
-  eassert (BUF_BEG (buf) <= m->charpos && m->charpos <= BUF_Z (buf));
+  ptrdiff_t charpos = marker_charpos (m);
+  eassert (BUF_BEG (buf) <= charpos && charpos <= BUF_Z (buf));
 
-  return m->charpos;
+  return charpos;
 }
 
 /* Return the byte position of marker MARKER, as a C integer.  */
@@ -710,9 +1577,10 @@ marker_byte_position (Lisp_Object marker)
   if (!buf)
     error ("Marker does not point anywhere");
 
-  eassert (BUF_BEG_BYTE (buf) <= m->bytepos && m->bytepos <= BUF_Z_BYTE (buf));
+  ptrdiff_t bytepos = marker_bytepos (m);
+  eassert (BUF_BEG_BYTE (buf) <= bytepos && bytepos <= BUF_Z_BYTE (buf));
 
-  return m->bytepos;
+  return bytepos;
 }
 
 DEFUN ("copy-marker", Fcopy_marker, Scopy_marker, 0, 2, 0,
@@ -804,4 +1672,10 @@ syms_of_marker (void)
   defsubr (&Scopy_marker);
   defsubr (&Smarker_insertion_type);
   defsubr (&Sset_marker_insertion_type);
+  defsubr (&Sbuffer_position_index_statistics);
+
+  DEFSYM (Qcheckpoints, "checkpoints");
+  DEFSYM (Qinterval, "interval");
+  DEFSYM (Qlookups, "lookups");
+  DEFSYM (Qscanned, "scanned");
 }
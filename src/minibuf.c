@@ -1566,6 +1566,520 @@ match_regexps (Lisp_Object string, Lisp_Object regexps,
   return true;
 }
 
+/* Completion indexes.
+
+   A completion index stores a set of strings in a compressed trie, so
+   that the strings starting with a given prefix can be found in time
+   proportional to the length of the prefix, instead of by comparing
+   the prefix with every string.  Each edge of the trie is labeled
+   with a run of characters, which is stored as the range of character
+   positions of one of the strings in the subtree below the edge.  */
+
+struct completion_index_node
+{
+  /* Index in KEYS of a string that starts with the characters on the
+     path from the root to this node.  */
+  ptrdiff_t key;
+
+  /* Index in KEYS of the string that ends at this node, or -1.  */
+  ptrdiff_t member;
+
+  /* The label of the edge leading to this node consists of the
+     characters from START to END of KEY.  START_BYTE is the byte
+     position of START in KEY, and C is the character at START.  */
+  ptrdiff_t start, end, start_byte;
+  int c;
+
+  /* Number of strings in the subtree rooted at this node.  */
+  ptrdiff_t count;
+
+  /* First child and next sibling, or -1.  Children are sorted by C.  */
+  ptrdiff_t child, sibling;
+};
+
+static ptrdiff_t
+completion_index_new_node (struct Lisp_Completion_Index *ci)
+{
+  ptrdiff_t n;
+
+  if (ci->free_node >= 0)
+    {
+      n = ci->free_node;
+      ci->free_node = ci->nodes[n].sibling;
+    }
+  else
+    {
+      if (ci->nodes_used == ci->nodes_size)
+	ci->nodes = xpalloc (ci->nodes, &ci->nodes_size, 1, -1,
+			     sizeof *ci->nodes);
+      n = ci->nodes_used++;
+    }
+
+  ci->nodes[n] = (struct completion_index_node) {
+    .key = -1, .member = -1, .child = -1, .sibling = -1 };
+  return n;
+}
+
+static ptrdiff_t
+completion_index_new_key (struct Lisp_Completion_Index *ci,
+			  Lisp_Object string)
+{
+  ptrdiff_t k;
+
+  if (ci->free_key >= 0)
+    {
+      k = ci->free_key;
+      ci->free_key = XFIXNUM (AREF (ci->keys, k));
+    }
+  else
+    {
+      if (ci->keys_used == ASIZE (ci->keys))
+	ci->keys = larger_vector (ci->keys, 1, -1);
+      k = ci->keys_used++;
+    }
+
+  ASET (ci->keys, k, string);
+  return k;
+}
+
+/* Make node N use the string with index KEY for its label.  */
+
+static void
+completion_index_set_key (struct Lisp_Completion_Index *ci, ptrdiff_t n,
+			  ptrdiff_t key)
+{
+  struct completion_index_node *node = &ci->nodes[n];
+  Lisp_Object string = AREF (ci->keys, key);
+  ptrdiff_t pos = node->start;
+
+  node->key = key;
+  node->start_byte = string_char_to_byte (string, pos);
+  if (pos < node->end)
+    {
+      ptrdiff_t pos_byte = node->start_byte;
+      node->c = fetch_string_char_advance (string, &pos, &pos_byte);
+    }
+}
+
+/* Return the child of node N whose label starts with character C, or
+   -1 if there is none.  If PREV is non-null, set *PREV to the child
+   after which a child for C belongs, or -1 if it belongs first.  */
+
+static ptrdiff_t
+completion_index_child (struct Lisp_Completion_Index *ci, ptrdiff_t n,
+			int c, ptrdiff_t *prev)
+{
+  ptrdiff_t p = -1, child;
+
+  for (child = ci->nodes[n].child;
+       child >= 0 && ci->nodes[child].c < c;
+       child = ci->nodes[child].sibling)
+    p = child;
+  if (prev)
+    *prev = p;
+  return child >= 0 && ci->nodes[child].c == c ? child : -1;
+}
+
+/* Compare the label of node N with the characters of STRING at
+   character position *POS and byte position *POS_BYTE.  Advance them
+   past the characters that match, and return how many matched.  */
+
+static ptrdiff_t
+completion_index_match_label (struct Lisp_Completion_Index *ci,
+			      ptrdiff_t n, Lisp_Object string,
+			      ptrdiff_t *pos, ptrdiff_t *pos_byte)
+{
+  struct completion_index_node *node = &ci->nodes[n];
+  Lisp_Object key = AREF (ci->keys, node->key);
+  ptrdiff_t i = node->start, i_byte = node->start_byte;
+
+  while (i < node->end && *pos < SCHARS (string))
+    {
+      ptrdiff_t j = i, j_byte = i_byte, p = *pos, p_byte = *pos_byte;
+
+      if (fetch_string_char_advance (key, &j, &j_byte)
+	  != fetch_string_char_advance (string, &p, &p_byte))
+	break;
+      i = j, i_byte = j_byte;
+      *pos = p, *pos_byte = p_byte;
+    }
+  return i - node->start;
+}
+
+/* Return the node of CI whose subtree holds the strings that start
+   with STRING, or -1 if there are none.  Set *EXACT to whether STRING
+   itself is in CI.  If PATH is non-null, store the nodes from the
+   root to the node returned in it, and their number in *NPATH; PATH
+   must have room for SCHARS (STRING) + 1 nodes.  */
+
+static ptrdiff_t
+completion_index_locate (struct Lisp_Completion_Index *ci,
+			 Lisp_Object string, bool *exact,
+			 ptrdiff_t *path, ptrdiff_t *npath)
+{
+  ptrdiff_t n = 0, pos = 0, pos_byte = 0, len = SCHARS (string);
+
+  *exact = false;
+  if (path)
+    {
+      *npath = 1;
+      path[0] = n;
+    }
+
+  while (pos < len)
+    {
+      ptrdiff_t p = pos, p_byte = pos_byte;
+      int c = fetch_string_char_advance (string, &p, &p_byte);
+      ptrdiff_t child = completion_index_child (ci, n, c, NULL);
+
+      if (child < 0)
+	return -1;
+      ptrdiff_t matched = completion_index_match_label (ci, child, string,
+							 &pos, &pos_byte);
+      if (matched < ci->nodes[child].end - ci->nodes[child].start
+	  && pos < len)
+	return -1;
+      n = child;
+      if (path)
+	path[(*npath)++] = n;
+    }
+
+  if (ci->nodes[n].count == 0)
+    return -1;
+  *exact = ci->nodes[n].end == len && ci->nodes[n].member >= 0;
+  return n;
+}
+
+/* Add STRING to CI.  Return true if it was not already there.  */
+
+static bool
+completion_index_insert (struct Lisp_Completion_Index *ci,
+			 Lisp_Object string)
+{
+  ptrdiff_t n = 0, pos = 0, pos_byte = 0, key;
+  bool exact;
+
+  if (completion_index_locate (ci, string, &exact, NULL, NULL) >= 0
+      && exact)
+    return false;
+
+  /* Store a copy, so that changing STRING does not corrupt the
+     labels that refer to it.  */
+  string = Fsubstring_no_properties (string, Qnil, Qnil);
+  key = completion_index_new_key (ci, string);
+  ci->nodes[n].count++;
+
+  while (pos < SCHARS (string))
+    {
+      ptrdiff_t p = pos, p_byte = pos_byte, prev;
+      int c = fetch_string_char_advance (string, &p, &p_byte);
+      ptrdiff_t child = completion_index_child (ci, n, c, &prev);
+
+      if (child < 0)
+	{
+	  /* Add a leaf for the rest of STRING.  */
+	  ptrdiff_t leaf = completion_index_new_node (ci);
+	  ptrdiff_t *link = (prev < 0 ? &ci->nodes[n].child
+			     : &ci->nodes[prev].sibling);
+
+	  ci->nodes[leaf].key = ci->nodes[leaf].member = key;
+	  ci->nodes[leaf].start = pos;
+	  ci->nodes[leaf].start_byte = pos_byte;
+	  ci->nodes[leaf].end = SCHARS (string);
+	  ci->nodes[leaf].c = c;
+	  ci->nodes[leaf].count = 1;
+	  ci->nodes[leaf].sibling = *link;
+	  *link = leaf;
+	  return true;
+	}
+
+      ptrdiff_t matched = completion_index_match_label (ci, child, string,
+							 &pos, &pos_byte);
+      if (matched < ci->nodes[child].end - ci->nodes[child].start)
+	{
+	  /* STRING leaves the label of CHILD after MATCHED characters;
+	     split it there.  */
+	  ptrdiff_t mid = completion_index_new_node (ci);
+	  struct completion_index_node *old = &ci->nodes[child];
+	  struct completion_index_node *top = &ci->nodes[mid];
+
+	  top->key = old->key;
+	  top->start = old->start;
+	  top->start_byte = old->start_byte;
+	  top->end = old->start + matched;
+	  top->c = old->c;
+	  top->count = old->count;
+	  top->child = child;
+	  top->sibling = old->sibling;
+	  old->start = top->end;
+	  old->sibling = -1;
+	  completion_index_set_key (ci, child, old->key);
+	  if (prev < 0)
+	    ci->nodes[n].child = mid;
+	  else
+	    ci->nodes[prev].sibling = mid;
+	  child = mid;
+	}
+      n = child;
+      ci->nodes[n].count++;
+    }
+
+  ci->nodes[n].member = key;
+  return true;
+}
+
+/* Remove STRING from CI.  Return true if it was there.  */
+
+static bool
+completion_index_delete (struct Lisp_Completion_Index *ci,
+			 Lisp_Object string)
+{
+  ptrdiff_t n, npath, key, *path;
+  bool exact;
+  USE_SAFE_ALLOCA;
+
+  SAFE_NALLOCA (path, 1, SCHARS (string) + 1);
+  n = completion_index_locate (ci, string, &exact, path, &npath);
+  if (n < 0 || !exact)
+    {
+      SAFE_FREE ();
+      return false;
+    }
+
+  key = ci->nodes[n].member;
+  ci->nodes[n].member = -1;
+
+  /* Free the nodes that no longer lead to any string.  */
+  for (ptrdiff_t i = npath - 1; i >= 0; i--)
+    {
+      ptrdiff_t node = path[i];
+
+      if (--ci->nodes[node].count == 0 && i > 0)
+	{
+	  ptrdiff_t *link = &ci->nodes[path[i - 1]].child;
+
+	  while (*link != node)
+	    link = &ci->nodes[*link].sibling;
+	  *link = ci->nodes[node].sibling;
+	  ci->nodes[node].sibling = ci->free_node;
+	  ci->free_node = node;
+	}
+    }
+
+  /* Make the labels that referred to the removed string refer to
+     another string below them.  */
+  for (ptrdiff_t i = 1; i < npath; i++)
+    {
+      ptrdiff_t node = path[i];
+
+      if (ci->nodes[node].count > 0 && ci->nodes[node].key == key)
+	{
+	  ptrdiff_t below = node;
+
+	  while (ci->nodes[below].member < 0)
+	    below = ci->nodes[below].child;
+	  completion_index_set_key (ci, node, ci->nodes[below].member);
+	}
+    }
+
+  ASET (ci->keys, key, make_fixnum (ci->free_key));
+  ci->free_key = key;
+  SAFE_FREE ();
+  return true;
+}
+
+/* Return a list of copies of the strings in the subtree of CI rooted
+   at node N, in lexicographic order.  Return nil if N is negative.
+   The strings are copied, as callers may change them, and the labels
+   of the nodes refer to them.  */
+
+static Lisp_Object
+completion_index_strings (struct Lisp_Completion_Index *ci, ptrdiff_t n)
+{
+  Lisp_Object result = Qnil;
+  ptrdiff_t *stack = NULL, stack_size = 0, sp = 0;
+
+  if (n < 0)
+    return Qnil;
+
+  /* Walk the subtree in preorder, visiting the children of each node
+     in order.  */
+  stack = xpalloc (NULL, &stack_size, 16, -1, sizeof *stack);
+  stack[sp++] = n;
+  while (sp > 0)
+    {
+      ptrdiff_t node = stack[--sp], first = sp;
+
+      if (ci->nodes[node].member >= 0)
+	result = Fcons (Fcopy_sequence (AREF (ci->keys,
+					      ci->nodes[node].member)),
+			result);
+      for (ptrdiff_t child = ci->nodes[node].child; child >= 0;
+	   child = ci->nodes[child].sibling)
+	{
+	  if (sp == stack_size)
+	    stack = xpalloc (stack, &stack_size, 1, -1, sizeof *stack);
+	  stack[sp++] = child;
+	}
+      /* Pop the first child first.  */
+      for (ptrdiff_t i = first, j = sp - 1; i < j; i++, j--)
+	{
+	  ptrdiff_t tem = stack[i];
+	  stack[i] = stack[j];
+	  stack[j] = tem;
+	}
+    }
+  xfree (stack);
+
+  return Fnreverse (result);
+}
+
+/* Return the list of the strings in completion index INDEX that may
+   be completions of STRING.  */
+
+static Lisp_Object
+completion_index_candidates (Lisp_Object index, Lisp_Object string)
+{
+  struct Lisp_Completion_Index *ci = XCOMPLETION_INDEX (index);
+  bool exact;
+
+  /* Comparisons that ignore case must look at every string.  */
+  if (completion_ignore_case)
+    return completion_index_strings (ci, 0);
+  return completion_index_strings (ci, completion_index_locate (ci, string,
+								&exact,
+								NULL, NULL));
+}
+
+/* Return the value of (try-completion STRING INDEX) for a completion
+   index INDEX, when there are no regexps or predicate to apply and
+   case is significant.  */
+
+static Lisp_Object
+completion_index_try (Lisp_Object index, Lisp_Object string)
+{
+  struct Lisp_Completion_Index *ci = XCOMPLETION_INDEX (index);
+  bool exact;
+  ptrdiff_t n = completion_index_locate (ci, string, &exact, NULL, NULL);
+
+  if (n < 0)
+    return Qnil;
+  if (exact && ci->nodes[n].count == 1)
+    return Qt;
+
+  /* All completions share the labels down to the first node where
+     a string ends or the trie branches.  */
+  while (ci->nodes[n].member < 0
+	 && ci->nodes[ci->nodes[n].child].sibling < 0)
+    n = ci->nodes[n].child;
+  /* The root has no label; STRING is empty if it got here.  */
+  if (n == 0)
+    return string;
+  return Fsubstring (AREF (ci->keys, ci->nodes[n].key), make_fixnum (0),
+		     make_fixnum (ci->nodes[n].end));
+}
+
+ptrdiff_t
+completion_index_size (Lisp_Object index)
+{
+  return XCOMPLETION_INDEX (index)->nodes[0].count;
+}
+
+static void
+completion_index_add_elt (Lisp_Object elt, Lisp_Object index)
+{
+  if (SYMBOLP (elt))
+    elt = Fsymbol_name (elt);
+  if (STRINGP (elt))
+    completion_index_insert (XCOMPLETION_INDEX (index), elt);
+}
+
+DEFUN ("make-completion-index", Fmake_completion_index,
+       Smake_completion_index, 0, 1, 0,
+       doc: /* Return a completion index of the possible completions in COLLECTION.
+A completion index stores strings so that `try-completion',
+`all-completions' and `test-completion' can find the ones that begin
+with a given string without testing all of them.  Use it as the
+COLLECTION argument of those functions, to complete over large sets
+of strings.
+
+COLLECTION can be a list, an alist, a hash table or an obarray, whose
+possible completions are determined as in `try-completion'.  The index
+holds copies of those strings without their text properties.  If
+COLLECTION is nil or omitted, the index is empty.
+
+Use `completion-index-add' and `completion-index-remove' to change the
+strings in the index.  */)
+  (Lisp_Object collection)
+{
+  struct Lisp_Completion_Index *ci
+    = ALLOCATE_PSEUDOVECTOR (struct Lisp_Completion_Index, keys,
+			     PVEC_COMPLETION_INDEX);
+  Lisp_Object index;
+
+  ci->keys = make_nil_vector (16);
+  ci->nodes = NULL;
+  ci->nodes_size = ci->nodes_used = 0;
+  ci->free_node = -1;
+  ci->keys_used = 0;
+  ci->free_key = -1;
+  completion_index_new_node (ci);
+  XSETPSEUDOVECTOR (index, ci, PVEC_COMPLETION_INDEX);
+
+  if (HASH_TABLE_P (collection))
+    {
+      struct Lisp_Hash_Table *h = XHASH_TABLE (collection);
+
+      for (ptrdiff_t i = 0; i < HASH_TABLE_SIZE (h); i++)
+	if (!BASE_EQ (HASH_KEY (h, i), Qunbound))
+	  completion_index_add_elt (HASH_KEY (h, i), index);
+    }
+  else if (VECTORP (collection))
+    map_obarray (check_obarray (collection), completion_index_add_elt,
+		 index);
+  else
+    for (Lisp_Object tail = collection; CONSP (tail); tail = XCDR (tail))
+      {
+	Lisp_Object elt = XCAR (tail);
+
+	completion_index_add_elt (CONSP (elt) ? XCAR (elt) : elt, index);
+      }
+
+  return index;
+}
+
+DEFUN ("completion-index-p", Fcompletion_index_p, Scompletion_index_p,
+       1, 1, 0,
+       doc: /* Return t if OBJECT is a completion index.  */)
+  (Lisp_Object object)
+{
+  return COMPLETION_INDEX_P (object) ? Qt : Qnil;
+}
+
+DEFUN ("completion-index-add", Fcompletion_index_add, Scompletion_index_add,
+       2, 2, 0,
+       doc: /* Add STRING to the completion index INDEX.
+Return t if STRING was added, or nil if INDEX already contained it.  */)
+  (Lisp_Object index, Lisp_Object string)
+{
+  CHECK_TYPE (COMPLETION_INDEX_P (index), Qcompletion_index_p, index);
+  CHECK_STRING (string);
+  return (completion_index_insert (XCOMPLETION_INDEX (index), string)
+	  ? Qt : Qnil);
+}
+
+DEFUN ("completion-index-remove", Fcompletion_index_remove,
+       Scompletion_index_remove, 2, 2, 0,
+       doc: /* Remove STRING from the completion index INDEX.
+Return t if STRING was removed, or nil if INDEX did not contain it.  */)
+  (Lisp_Object index, Lisp_Object string)
+{
+  CHECK_TYPE (COMPLETION_INDEX_P (index), Qcompletion_index_p, index);
+  CHECK_STRING (string);
+  return (completion_index_delete (XCOMPLETION_INDEX (index), string)
+	  ? Qt : Qnil);
+}
+
 DEFUN ("try-completion", Ftry_completion, Stry_completion, 2, 3, 0,
        doc: /* Return longest common substring of all completions of STRING in COLLECTION.
 
@@ -1586,6 +2100,8 @@ DEFUN ("try-completion", Ftry_completion, Stry_completion, 2, 3, 0,
 or symbols are the possible completions.
 If COLLECTION is an obarray, the names of all symbols in the obarray
 are the possible completions.
+If COLLECTION is a completion index, see `make-completion-index', the
+strings in the index are the possible completions.
 
 COLLECTION can also be a function to do the completion itself.
 It receives three arguments: STRING, PREDICATE and nil.
@@ -1610,6 +2126,14 @@ DEFUN ("try-completion", Ftry_completion, Stry_completion, 2, 3, 0,
 or from one of the possible completions.  */)
   (Lisp_Object string, Lisp_Object collection, Lisp_Object predicate)
 {
+  if (COMPLETION_INDEX_P (collection))
+    {
+      CHECK_STRING (string);
+      if (NILP (predicate) && NILP (Vcompletion_regexp_list)
+	  && !completion_ignore_case)
+	return completion_index_try (collection, string);
+      collection = completion_index_candidates (collection, string);
+    }
 
   Lisp_Object bestmatch, tail, elt, eltstring;
   /* Size in bytes of BESTMATCH.  */
@@ -1834,6 +2358,8 @@ DEFUN ("all-completions", Fall_completions, Sall_completions, 2, 4, 0,
 are the possible completions.
 If COLLECTION is an obarray, the names of all symbols in the obarray
 are the possible completions.
+If COLLECTION is a completion index, see `make-completion-index', the
+strings in the index are the possible completions.
 
 COLLECTION can also be a function to do the completion itself.
 It receives three arguments: STRING, PREDICATE and t.
@@ -1857,6 +2383,15 @@ DEFUN ("all-completions", Fall_completions, Sall_completions, 2, 4, 0,
 with a space are ignored unless STRING itself starts with a space.  */)
   (Lisp_Object string, Lisp_Object collection, Lisp_Object predicate, Lisp_Object hide_spaces)
 {
+  if (COMPLETION_INDEX_P (collection))
+    {
+      CHECK_STRING (string);
+      collection = completion_index_candidates (collection, string);
+      if (NILP (predicate) && NILP (Vcompletion_regexp_list)
+	  && !completion_ignore_case && NILP (hide_spaces))
+	return collection;
+    }
+
   Lisp_Object tail, elt, eltstring;
   Lisp_Object allmatches;
   int type = HASH_TABLE_P (collection) ? 3
@@ -2105,6 +2640,24 @@ DEFUN ("test-completion", Ftest_completion, Stest_completion, 2, 3, 0,
       if (!SYMBOLP (tem))
 	return Qnil;
     }
+  else if (COMPLETION_INDEX_P (collection))
+    {
+      struct Lisp_Completion_Index *ci = XCOMPLETION_INDEX (collection);
+      bool exact;
+
+      if (completion_ignore_case)
+	tem = Fassoc_string (string, completion_index_strings (ci, 0), Qt);
+      else
+	{
+	  ptrdiff_t n = completion_index_locate (ci, string, &exact,
+						 NULL, NULL);
+	  tem = (exact
+		 ? Fcopy_sequence (AREF (ci->keys, ci->nodes[n].member))
+		 : Qnil);
+	}
+      if (NILP (tem))
+	return Qnil;
+    }
   else if (HASH_TABLE_P (collection))
     {
       struct Lisp_Hash_Table *h = XHASH_TABLE (collection);
@@ -2299,6 +2852,8 @@ syms_of_minibuf (void)
   DEFSYM (Qminibuffer_follows_selected_frame,
           "minibuffer-follows-selected-frame");
   DEFSYM (Qcompletion_ignore_case, "completion-ignore-case");
+  DEFSYM (Qcompletion_index, "completion-index");
+  DEFSYM (Qcompletion_index_p, "completion-index-p");
   DEFSYM (Qminibuffer_default, "minibuffer-default");
   Fset (Qminibuffer_default, Qnil);
 
@@ -2542,6 +3097,10 @@ syms_of_minibuf (void)
   defsubr (&Stry_completion);
   defsubr (&Sall_completions);
   defsubr (&Stest_completion);
+  defsubr (&Smake_completion_index);
+  defsubr (&Scompletion_index_p);
+  defsubr (&Scompletion_index_add);
+  defsubr (&Scompletion_index_remove);
   defsubr (&Sassoc_string);
   defsubr (&Scompleting_read);
 }
@@ -2023,7 +2023,7 @@ dump_interval_tree (struct dump_context *ctx,
                     INTERVAL tree,
                     dump_off parent_offset)
 {
-#if CHECK_STRUCTS && !defined (HASH_interval_1B38941C37)
+#if CHECK_STRUCTS && !defined (HASH_interval_5F0FCD9304)
 # error "interval changed. See CHECK_STRUCTS comment in config.h."
 #endif
   /* TODO: output tree breadth-first?  */
@@ -2031,6 +2031,10 @@ dump_interval_tree (struct dump_context *ctx,
   dump_object_start (ctx, &out, sizeof (out));
   DUMP_FIELD_COPY (&out, tree, total_length);
   DUMP_FIELD_COPY (&out, tree, position);
+  /* The summary bits of symbols other than the builtin ones come from
+     their addresses, which differ in the next session, so make the
+     summary of a dumped interval mention every property.  */
+  out.props_summary = UINT_MAX;
   if (tree->left)
     dump_field_fixup_later (ctx, &out, tree, &tree->left);
   if (tree->right)
@@ -2113,7 +2117,7 @@ dump_string (struct dump_context *ctx, const struct Lisp_String *string)
 static dump_off
 dump_marker (struct dump_context *ctx, const struct Lisp_Marker *marker)
 {
-#if CHECK_STRUCTS && !defined (HASH_Lisp_Marker_642DBAF866)
+#if CHECK_STRUCTS && !defined (HASH_Lisp_Marker_3CF25C80BD)
 # error "Lisp_Marker changed. See CHECK_STRUCTS comment in config.h."
 #endif
 
@@ -2127,8 +2131,10 @@ dump_marker (struct dump_context *ctx, const struct Lisp_Marker *marker)
 			    Lisp_Vectorlike, WEIGHT_NORMAL);
       dump_field_lv_rawptr (ctx, out, marker, &marker->next,
 			    Lisp_Vectorlike, WEIGHT_STRONG);
-      DUMP_FIELD_COPY (out, marker, charpos);
-      DUMP_FIELD_COPY (out, marker, bytepos);
+      /* The marker index is not dumped; it is rebuilt from the chain
+	 when it is next needed.  */
+      out->charpos = marker_charpos (marker);
+      out->bytepos = marker_bytepos (marker);
     }
   return finish_dump_pvec (ctx, &out->header);
 }
@@ -2701,7 +2707,7 @@ dump_hash_table (struct dump_context *ctx,
 static dump_off
 dump_buffer (struct dump_context *ctx, const struct buffer *in_buffer)
 {
-#if CHECK_STRUCTS && !defined HASH_buffer_AA373AEE10
+#if CHECK_STRUCTS && !defined HASH_buffer_C86F77FFD1
 # error "buffer changed. See CHECK_STRUCTS comment in config.h."
 #endif
   struct buffer munged_buffer = *in_buffer;
@@ -2807,8 +2813,13 @@ dump_buffer (struct dump_context *ctx, const struct buffer *in_buffer)
   DUMP_FIELD_COPY (out, buffer, last_window_start);
 
   /* Not worth serializing these caches.  TODO: really? */
+  out->own_text.marker_index = NULL;
+  out->own_text.position_index = NULL;
+  out->own_text.parse_state_cache = NULL;
   out->newline_cache = NULL;
   out->width_run_cache = NULL;
+  out->column_cache = NULL;
+  out->bidi_dir_cache = NULL;
   out->bidi_paragraph_cache = NULL;
 
   DUMP_FIELD_COPY (out, buffer, prevent_redisplay_optimizations_p);
@@ -2825,6 +2836,8 @@ dump_buffer (struct dump_context *ctx, const struct buffer *in_buffer)
   DUMP_FIELD_COPY (out, buffer, overlay_center);
   dump_field_lv (ctx, out, buffer, &buffer->undo_list_,
                  WEIGHT_STRONG);
+  /* Leave undo_scan_start and undo_scan_end nil, since they are not
+     references the garbage collector knows about.  */
   dump_off offset = finish_dump_pvec (ctx, &out->header);
   if (!buffer->base_buffer && buffer->own_text.intervals)
     dump_remember_fixup_ptr_raw
@@ -2954,7 +2967,7 @@ dump_vectorlike (struct dump_context *ctx,
                  Lisp_Object lv,
                  dump_off offset)
 {
-#if CHECK_STRUCTS && !defined HASH_pvec_type_AFF6FED5BD
+#if CHECK_STRUCTS && !defined HASH_pvec_type_9FFC2478E1
 # error "pvec_type changed. See CHECK_STRUCTS comment in config.h."
 #endif
   const struct Lisp_Vector *v = XVECTOR (lv);
@@ -3036,6 +3049,8 @@ dump_vectorlike (struct dump_context *ctx,
       error_unsupported_dump_object (ctx, lv, "condvar");
     case PVEC_SQLITE:
       error_unsupported_dump_object (ctx, lv, "sqlite");
+    case PVEC_COMPLETION_INDEX:
+      error_unsupported_dump_object (ctx, lv, "completion index");
     case PVEC_MODULE_FUNCTION:
       error_unsupported_dump_object (ctx, lv, "module function");
     case PVEC_SYMBOL_WITH_POS:
@@ -2025,6 +2025,14 @@ print_vectorlike (Lisp_Object obj, Lisp_Object printcharfun, bool escapeflag,
       }
       break;
 
+    case PVEC_COMPLETION_INDEX:
+      {
+	int len = sprintf (buf, "#<completion-index %"pD"d strings>",
+			   completion_index_size (obj));
+	strout (buf, len, len, printcharfun);
+      }
+      break;
+
     default:
       emacs_abort ();
     }
@@ -177,6 +177,166 @@ SYNTAX_COMEND_FIRST (int c)
 static ptrdiff_t find_start_begv;
 static modiff_count find_start_modiff;
 
+/* The parse state cache.
+
+   Each buffer text can have a sorted array of parse states, the states
+   that scan_sexps_forward reaches at intervals of PARSE_STATE_INTERVAL
+   characters when parsing from the beginning of the accessible portion
+   of the buffer.  syntax-parse-state resumes parsing from the last
+   state before the position it is asked about.
+
+   A change to the text, or to the syntax-table properties of the text,
+   drops the states after the start of the change; see
+   flush_parse_state_cache.  The states also depend on the syntax
+   table, on the start of the accessible portion and on a few
+   variables, so a change in any of those, or to the contents of the
+   syntax table or its parents, drops them all.  Changes that can't be
+   noticed cheaply, like changing the `syntax-table' property of a
+   symbol used as a `category' property, or modifying the value of
+   `char-property-alias-alist' in place, are not noticed.  */
+
+enum { PARSE_STATE_INTERVAL = 4096 };
+
+struct cached_parse_state
+{
+  ptrdiff_t charpos, bytepos;
+  struct lisp_parse_state state;
+};
+
+struct parse_state_cache
+{
+  /* What the states were computed with.  */
+  Lisp_Object syntax_table;
+  ptrdiff_t begv;
+  EMACS_UINT char_table_modiff;
+  Lisp_Object property_aliases, default_properties;
+  bool lookup_properties, comment_end_escapable;
+
+  struct cached_parse_state *states;
+  ptrdiff_t nstates, size;
+};
+
+/* Return the parse state cache of the current buffer, creating it or
+   emptying it as needed.  */
+
+static struct parse_state_cache *
+get_parse_state_cache (void)
+{
+  struct parse_state_cache *cache = current_buffer->text->parse_state_cache;
+
+  if (!cache)
+    {
+      cache = xzalloc (sizeof *cache);
+      current_buffer->text->parse_state_cache = cache;
+    }
+  else if (EQ (cache->syntax_table, BVAR (current_buffer, syntax_table))
+	   && cache->begv == BEGV
+	   && (cache->char_table_modiff
+	       == char_table_modiff (BVAR (current_buffer, syntax_table)))
+	   && EQ (cache->property_aliases, Vchar_property_alias_alist)
+	   && EQ (cache->default_properties, Vdefault_text_properties)
+	   && cache->lookup_properties == parse_sexp_lookup_properties
+	   && cache->comment_end_escapable == comment_end_can_be_escaped)
+    return cache;
+
+  cache->syntax_table = BVAR (current_buffer, syntax_table);
+  cache->begv = BEGV;
+  cache->char_table_modiff
+    = char_table_modiff (BVAR (current_buffer, syntax_table));
+  cache->property_aliases = Vchar_property_alias_alist;
+  cache->default_properties = Vdefault_text_properties;
+  cache->lookup_properties = parse_sexp_lookup_properties;
+  cache->comment_end_escapable = comment_end_can_be_escaped;
+  cache->nstates = 0;
+  return cache;
+}
+
+/* Return the index of the first state in CACHE at CHARPOS or after it,
+   or CACHE->nstates if there is none.  */
+
+static ptrdiff_t
+parse_state_at_or_after (struct parse_state_cache *cache, ptrdiff_t charpos)
+{
+  ptrdiff_t lo = 0, hi = cache->nstates;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+
+      if (cache->states[mid].charpos < charpos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Drop the states of buffer B's parse state cache at CHARPOS and after
+   it, because the text or its syntax is about to change there.  */
+
+void
+flush_parse_state_cache (struct buffer *b, ptrdiff_t charpos)
+{
+  struct parse_state_cache *cache = b->text->parse_state_cache;
+
+  if (cache)
+    cache->nstates = min (cache->nstates,
+			  parse_state_at_or_after (cache, charpos));
+}
+
+/* Free buffer B's parse state cache, if any.  */
+
+void
+free_parse_state_cache (struct buffer *b)
+{
+  struct parse_state_cache *cache = b->text->parse_state_cache;
+
+  if (cache)
+    {
+      xfree (cache->states);
+      xfree (cache);
+      b->text->parse_state_cache = NULL;
+    }
+}
+
+/* Mark the Lisp objects in buffer B's parse state cache.  */
+
+void
+mark_parse_state_cache (struct buffer *b)
+{
+  struct parse_state_cache *cache = b->text->parse_state_cache;
+
+  if (cache)
+    {
+      mark_object (cache->syntax_table);
+      mark_object (cache->property_aliases);
+      mark_object (cache->default_properties);
+      for (ptrdiff_t i = 0; i < cache->nstates; i++)
+	mark_object (cache->states[i].state.levelstarts);
+    }
+}
+
+/* Add STATE, the state at the position where it stopped, to CACHE.  */
+
+static void
+add_parse_state (struct parse_state_cache *cache,
+		 struct lisp_parse_state *state)
+{
+  ptrdiff_t i = parse_state_at_or_after (cache, state->location);
+
+  if (i < cache->nstates && cache->states[i].charpos == state->location)
+    return;
+  if (cache->nstates == cache->size)
+    cache->states = xpalloc (cache->states, &cache->size, 1, -1,
+			     sizeof *cache->states);
+  memmove (cache->states + i + 1, cache->states + i,
+	   (cache->nstates - i) * sizeof *cache->states);
+  cache->states[i].charpos = state->location;
+  cache->states[i].bytepos = state->location_byte;
+  cache->states[i].state = *state;
+  cache->nstates++;
+}
+
 
 static Lisp_Object skip_chars (bool, Lisp_Object, Lisp_Object, bool);
 static Lisp_Object skip_syntaxes (bool, Lisp_Object, Lisp_Object);
@@ -1931,6 +2091,19 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 	}
     }
 
+  /* If the set is everything but one ASCII character, as in the common
+     "^\n", skipping amounts to searching for that character, which
+     memchr does much faster than the loops below.  An ASCII byte never
+     occurs inside a multibyte sequence.  */
+  int stop_byte = -1;
+  if (NILP (iso_classes) && n_char_ranges == 0)
+    {
+      char *zero = memchr (fastmap, 0, sizeof fastmap);
+      if (zero && zero - fastmap < 0200
+	  && !memchr (zero + 1, 0, fastmap + sizeof fastmap - (zero + 1)))
+	stop_byte = zero - fastmap;
+    }
+
   {
     ptrdiff_t start_point = PT;
     ptrdiff_t pos = PT;
@@ -1954,7 +2127,49 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
        We ignore syntax-table text-properties for now, since that's
        what we've done in the past.  */
     SETUP_BUFFER_SYNTAX_TABLE ();
-    if (forwardp)
+    if (stop_byte >= 0)
+      while (true)
+	{
+	  unsigned char *q;
+
+	  if (forwardp)
+	    {
+	      if (p >= stop)
+		{
+		  if (p >= endp)
+		    break;
+		  p = GAP_END_ADDR;
+		  stop = endp;
+		}
+	      q = memchr (p, stop_byte, stop - p);
+	      if (!q)
+		q = stop;
+	      pos += multibyte ? multibyte_chars_in_text (p, q - p) : q - p;
+	      pos_byte += q - p;
+	      p = q;
+	      if (p < stop)
+		break;
+	    }
+	  else
+	    {
+	      if (p <= stop)
+		{
+		  if (p <= endp)
+		    break;
+		  p = GPT_ADDR;
+		  stop = endp;
+		}
+	      q = memrchr (stop, stop_byte, p - stop);
+	      q = q ? q + 1 : stop;
+	      pos -= multibyte ? multibyte_chars_in_text (q, p - q) : p - q;
+	      pos_byte -= p - q;
+	      p = q;
+	      if (p > stop)
+		break;
+	    }
+	  maybe_quit ();
+	}
+    else if (forwardp)
       {
 	if (multibyte)
 	  while (1)
@@ -1968,6 +2183,19 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 		  p = GAP_END_ADDR;
 		  stop = endp;
 		}
+	      if (NILP (iso_classes))
+		{
+		  /* Skip a run of ASCII characters in the set, for which
+		     FASTMAP is exact.  */
+		  unsigned char *q = p;
+		  while (q < stop && ASCII_CHAR_P (*q) && fastmap[*q])
+		    q++;
+		  pos += q - p, pos_byte += q - p, p = q;
+		  if (p >= stop)
+		    continue;
+		  if (ASCII_CHAR_P (*p))
+		    break;
+		}
 	      c = string_char_and_length (p, &nbytes);
 	      if (! NILP (iso_classes) && in_classes (c, iso_classes))
 		{
@@ -2010,6 +2238,17 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 		  stop = endp;
 		}
 
+	      if (NILP (iso_classes))
+		{
+		  unsigned char *q = p;
+		  while (q < stop && fastmap[*q])
+		    q++;
+		  pos += q - p, pos_byte += q - p, p = q;
+		  if (p >= stop)
+		    continue;
+		  break;
+		}
+
 	      if (!NILP (iso_classes) && in_classes (*p, iso_classes))
 		{
 		  if (negate)
@@ -2037,6 +2276,18 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 		  p = GPT_ADDR;
 		  stop = endp;
 		}
+	      if (NILP (iso_classes))
+		{
+		  /* See the comment in the previous similar code.  */
+		  unsigned char *q = p;
+		  while (q > stop && ASCII_CHAR_P (q[-1]) && fastmap[q[-1]])
+		    q--;
+		  pos -= p - q, pos_byte -= p - q, p = q;
+		  if (p <= stop)
+		    continue;
+		  if (ASCII_CHAR_P (p[-1]))
+		    break;
+		}
 	      unsigned char *prev_p = p;
 	      do
 		p--;
@@ -2078,6 +2329,17 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 		  stop = endp;
 		}
 
+	      if (NILP (iso_classes))
+		{
+		  unsigned char *q = p;
+		  while (q > stop && fastmap[q[-1]])
+		    q--;
+		  pos -= p - q, pos_byte -= p - q, p = q;
+		  if (p <= stop)
+		    continue;
+		  break;
+		}
+
 	      if (! NILP (iso_classes) && in_classes (p[-1], iso_classes))
 		{
 		  if (negate)
@@ -2102,6 +2364,56 @@ skip_chars (bool forwardp, Lisp_Object string, Lisp_Object lim,
 }
 
 
+/* Whether ASCII characters have one of the syntaxes skip_syntaxes is
+   skipping over, as looked up in the syntax table TABLE.  */
+
+struct ascii_syntax_memo
+{
+  Lisp_Object table;
+
+  /* 1 if the character's syntax is in the set, 0 if not, and -1 if
+     it has not been looked up yet.  */
+  signed char match[0200];
+};
+
+/* Return true if the syntax of C is one of those in FASTMAP, using the
+   syntax table that gl_state is set up for.  Remember the answers for
+   ASCII characters in MEMO.  */
+
+static bool
+syntax_in_fastmap (int c, unsigned char const *fastmap,
+		   struct ascii_syntax_memo *memo)
+{
+  if (! ASCII_CHAR_P (c) || gl_state.use_global)
+    return fastmap[SYNTAX (c)];
+  if (! EQ (memo->table, gl_state.current_syntax_table))
+    {
+      memo->table = gl_state.current_syntax_table;
+      memset (memo->match, -1, sizeof memo->match);
+    }
+  if (memo->match[c] < 0)
+    memo->match[c] = fastmap[SYNTAX (c)];
+  return memo->match[c];
+}
+
+/* Return the number of bytes in the run of ASCII characters whose
+   syntax is in FASTMAP that starts at P and extends at most N bytes
+   in direction DIR, which is 1 or -1.  */
+
+static ptrdiff_t
+ascii_syntax_run (unsigned char const *p, ptrdiff_t n, int dir,
+		  unsigned char const *fastmap,
+		  struct ascii_syntax_memo *memo)
+{
+  ptrdiff_t i;
+  if (dir < 0)
+    p--;
+  for (i = 0; i < n; i++, p += dir)
+    if (! (ASCII_CHAR_P (*p) && syntax_in_fastmap (*p, fastmap, memo)))
+      break;
+  return i;
+}
+
 static Lisp_Object
 skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 {
@@ -2167,6 +2479,7 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
     ptrdiff_t pos = PT;
     ptrdiff_t pos_byte = PT_BYTE;
     unsigned char *p, *endp, *stop;
+    struct ascii_syntax_memo memo = { .table = Qnil };
 
     SETUP_SYNTAX_TABLE (pos, forwardp ? 1 : -1);
 
@@ -2189,11 +2502,24 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		    p = GAP_END_ADDR;
 		    stop = endp;
 		  }
+		if (! gl_state.use_global)
+		  {
+		    ptrdiff_t n = stop - p;
+		    if (parse_sexp_lookup_properties)
+		      n = min (n, gl_state.e_property - pos);
+		    n = ascii_syntax_run (p, n, 1, fastmap, &memo);
+		    p += n, pos += n, pos_byte += n;
+		    if (n > 0
+			&& (p >= stop
+			    || (parse_sexp_lookup_properties
+				&& pos >= gl_state.e_property)))
+		      continue;
+		  }
 		if (multibyte)
 		  c = string_char_and_length (p, &nbytes);
 		else
 		  c = *p, nbytes = 1;
-		if (! fastmap[SYNTAX (c)])
+		if (! syntax_in_fastmap (c, fastmap, &memo))
 		  goto done;
 		p += nbytes, pos++, pos_byte += nbytes;
 		rarely_quit (pos);
@@ -2203,6 +2529,8 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 
 	    update_syntax_table_forward (pos + gl_state.offset,
 					 false, gl_state.object);
+	    /* That can run Lisp, which can change the syntax table.  */
+	    memo.table = Qnil;
 	  }
       }
     else
@@ -2222,6 +2550,18 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		    p = GPT_ADDR;
 		    stop = endp;
 		  }
+		if (! gl_state.use_global)
+		  {
+		    /* Stay within the interval the syntax table is valid
+		       for, as UPDATE_SYNTAX_TABLE_BACKWARD would.  */
+		    ptrdiff_t n = p - stop;
+		    if (parse_sexp_lookup_properties)
+		      n = min (n, pos - gl_state.b_property);
+		    n = ascii_syntax_run (p, n, -1, fastmap, &memo);
+		    p -= n, pos -= n, pos_byte -= n;
+		    if (n > 0 && p <= stop)
+		      continue;
+		  }
 		UPDATE_SYNTAX_TABLE_BACKWARD (pos - 1);
 
 		unsigned char *prev_p = p;
@@ -2230,7 +2570,7 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		while (stop <= p && ! CHAR_HEAD_P (*p));
 
 		c = STRING_CHAR (p);
-		if (! fastmap[SYNTAX (c)])
+		if (! syntax_in_fastmap (c, fastmap, &memo))
 		  break;
 		pos--, pos_byte -= prev_p - p;
 		rarely_quit (pos);
@@ -2247,8 +2587,18 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		    p = GPT_ADDR;
 		    stop = endp;
 		  }
+		if (! gl_state.use_global)
+		  {
+		    ptrdiff_t n = p - stop;
+		    if (parse_sexp_lookup_properties)
+		      n = min (n, pos - gl_state.b_property);
+		    n = ascii_syntax_run (p, n, -1, fastmap, &memo);
+		    p -= n, pos -= n, pos_byte -= n;
+		    if (n > 0 && p <= stop)
+		      continue;
+		  }
 		UPDATE_SYNTAX_TABLE_BACKWARD (pos - 1);
-		if (! fastmap[SYNTAX (p[-1])])
+		if (! syntax_in_fastmap (p[-1], fastmap, &memo))
 		  break;
 		p--, pos--, pos_byte--;
 		rarely_quit (pos);
@@ -3552,6 +3902,41 @@ internalize_parse_state (Lisp_Object external, struct lisp_parse_state *state)
     }
 }
 
+/* Convert the parse state STATE to the list that parse-partial-sexp
+   returns.  */
+static Lisp_Object
+externalize_parse_state (struct lisp_parse_state *state)
+{
+  return
+    Fcons (make_fixnum (state->depth),
+	   Fcons (state->prevlevelstart < 0
+		  ? Qnil : make_fixnum (state->prevlevelstart),
+	     Fcons (state->thislevelstart < 0
+		    ? Qnil : make_fixnum (state->thislevelstart),
+	       Fcons (state->instring >= 0
+		      ? (state->instring == ST_STRING_STYLE
+			 ? Qt : make_fixnum (state->instring)) : Qnil,
+		 Fcons (state->incomment < 0 ? Qt :
+			(state->incomment == 0 ? Qnil :
+			 make_fixnum (state->incomment)),
+		   Fcons (state->quoted ? Qt : Qnil,
+		     Fcons (make_fixnum (state->mindepth),
+		       Fcons ((state->comstyle
+			       ? (state->comstyle == ST_COMMENT_STYLE
+				  ? Qsyntax_table
+				  : make_fixnum (state->comstyle))
+			       : Qnil),
+		         Fcons (((state->incomment
+                                  || (state->instring >= 0))
+                                 ? make_fixnum (state->comstr_start)
+                                 : Qnil),
+			   Fcons (state->levelstarts,
+                             Fcons (state->prev_syntax == Smax
+                                    ? Qnil
+                                    : make_fixnum (state->prev_syntax),
+                                Qnil)))))))))));
+}
+
 DEFUN ("parse-partial-sexp", Fparse_partial_sexp, Sparse_partial_sexp, 2, 6, 0,
        doc: /* Parse Lisp syntax starting at FROM until TO; return status of parse at TO.
 Parsing stops at TO or when certain criteria are met;
@@ -3618,34 +4003,67 @@ DEFUN ("parse-partial-sexp", Fparse_partial_sexp, Sparse_partial_sexp, 2, 6, 0,
 
   SET_PT_BOTH (state.location, state.location_byte);
 
-  return
-    Fcons (make_fixnum (state.depth),
-	   Fcons (state.prevlevelstart < 0
-		  ? Qnil : make_fixnum (state.prevlevelstart),
-	     Fcons (state.thislevelstart < 0
-		    ? Qnil : make_fixnum (state.thislevelstart),
-	       Fcons (state.instring >= 0
-		      ? (state.instring == ST_STRING_STYLE
-			 ? Qt : make_fixnum (state.instring)) : Qnil,
-		 Fcons (state.incomment < 0 ? Qt :
-			(state.incomment == 0 ? Qnil :
-			 make_fixnum (state.incomment)),
-		   Fcons (state.quoted ? Qt : Qnil,
-		     Fcons (make_fixnum (state.mindepth),
-		       Fcons ((state.comstyle
-			       ? (state.comstyle == ST_COMMENT_STYLE
-				  ? Qsyntax_table
-				  : make_fixnum (state.comstyle))
-			       : Qnil),
-		         Fcons (((state.incomment
-                                  || (state.instring >= 0))
-                                 ? make_fixnum (state.comstr_start)
-                                 : Qnil),
-			   Fcons (state.levelstarts,
-                             Fcons (state.prev_syntax == Smax
-                                    ? Qnil
-                                    : make_fixnum (state.prev_syntax),
-                                Qnil)))))))))));
+  return externalize_parse_state (&state);
+}
+
+DEFUN ("syntax-parse-state", Fsyntax_parse_state, Ssyntax_parse_state, 1, 1, 0,
+       doc: /* Return the parse state at POS.
+The value is the same as that of `parse-partial-sexp' run from
+`point-min' to POS, except that the values at positions 2 and 6 in the
+returned list (counting from 0) cannot be relied upon.  Point is not
+moved.
+
+Each buffer keeps the parse states at regular intervals, so that
+asking for the state at POS only parses the text between POS and the
+last kept state before it.  Changes to the text, or to its
+`syntax-table' properties, discard the states after the change.
+Changing the `syntax-table' property of a symbol used as a `category'
+property, or modifying the value of `char-property-alias-alist' in
+place, is not noticed.  */)
+  (Lisp_Object pos)
+{
+  ptrdiff_t charpos = fix_position (pos);
+  struct lisp_parse_state state;
+  ptrdiff_t from, from_byte;
+
+  if (! (BEGV <= charpos && charpos <= ZV))
+    args_out_of_range (pos, Fcurrent_buffer ());
+
+  struct parse_state_cache *cache = get_parse_state_cache ();
+  ptrdiff_t i = parse_state_at_or_after (cache, charpos + 1);
+
+  if (i > 0)
+    {
+      state = cache->states[i - 1].state;
+      from = cache->states[i - 1].charpos;
+      from_byte = cache->states[i - 1].bytepos;
+    }
+  else
+    {
+      internalize_parse_state (Qnil, &state);
+      state.mindepth = 0;
+      state.thislevelstart = state.prevlevelstart = -1;
+      state.location = from = BEGV;
+      state.location_byte = from_byte = BEGV_BYTE;
+    }
+
+  while (from < charpos)
+    {
+      ptrdiff_t end = (charpos - from > PARSE_STATE_INTERVAL
+		       ? from + PARSE_STATE_INTERVAL : charpos);
+
+      scan_sexps_forward (&state, from, from_byte, end,
+			  TYPE_MINIMUM (EMACS_INT), false, 0);
+      from = state.location;
+      from_byte = state.location_byte;
+
+      /* Parsing can run syntax-propertize, which can change the text
+	 properties and so flush or even reset the cache.  */
+      if (from < charpos)
+	add_parse_state (get_parse_state_cache (), &state);
+    }
+
+  return externalize_parse_state (&state);
 }
 
 void
@@ -3831,4 +4249,5 @@ syms_of_syntax (void)
   defsubr (&Sscan_sexps);
   defsubr (&Sbackward_prefix_chars);
   defsubr (&Sparse_partial_sexp);
+  defsubr (&Ssyntax_parse_state);
 }
@@ -73,10 +73,52 @@ text_read_only (Lisp_Object propval)
   xsignal0 (Qtext_read_only);
 }
 
-/* Prepare to modify the text properties of BUFFER from START to END.  */
+/* What changing text properties can affect, besides the text's
+   appearance.  */
+
+enum property_effect
+  {
+    /* The syntax of the text.  */
+    AFFECTS_SYNTAX = 1,
+
+    /* The columns of the text; see indent.c.  */
+    AFFECTS_COLUMNS = 2,
+
+    AFFECTS_ALL = AFFECTS_SYNTAX | AFFECTS_COLUMNS
+  };
+
+/* Return what changing the properties PROPERTIES can affect.
+   PROPERTIES is a property list if PLIST, else a list of property
+   names.  */
+
+static int
+property_effects (Lisp_Object properties, bool plist)
+{
+  /* Any property can be an alias of one that matters.  */
+  int effects = NILP (Vchar_property_alias_alist) ? 0 : AFFECTS_ALL;
+
+  for (; CONSP (properties); properties = XCDR (properties))
+    {
+      Lisp_Object prop = XCAR (properties);
+      if (EQ (prop, Qsyntax_table))
+	effects |= AFFECTS_SYNTAX;
+      else if (EQ (prop, Qcategory))
+	effects |= AFFECTS_ALL;
+      else if (EQ (prop, Qinvisible) || EQ (prop, Qdisplay)
+	       || EQ (prop, Qcomposition))
+	effects |= AFFECTS_COLUMNS;
+      if (plist && !CONSP (properties = XCDR (properties)))
+	break;
+    }
+  return effects;
+}
+
+/* Prepare to modify the text properties of BUFFER from START to END.
+   EFFECTS says what the change can affect.  */
 
 static void
-modify_text_properties (Lisp_Object buffer, Lisp_Object start, Lisp_Object end)
+modify_text_properties (Lisp_Object buffer, Lisp_Object start,
+			Lisp_Object end, int effects)
 {
   ptrdiff_t b = XFIXNUM (start), e = XFIXNUM (end);
   struct buffer *buf = XBUFFER (buffer), *old = current_buffer;
@@ -84,6 +126,13 @@ modify_text_properties (Lisp_Object buffer, Lisp_Object start, Lisp_Object end)
   set_buffer_internal (buf);
 
   prepare_to_modify_buffer_1 (b, e, NULL);
+  if (effects & AFFECTS_SYNTAX)
+    flush_parse_state_cache (buf, b);
+  if (effects & AFFECTS_COLUMNS)
+    {
+      flush_column_cache (buf, b);
+      flush_bidi_dir_cache (buf, b);
+    }
 
   BUF_COMPUTE_UNCHANGED (buf, b - 1, e);
   if (MODIFF <= SAVE_MODIFF)
@@ -1030,6 +1079,7 @@ DEFUN ("next-single-property-change", Fnext_single_property_change,
 {
   register INTERVAL i, next;
   register Lisp_Object here_val;
+  unsigned int mask;
 
   if (NILP (object))
     XSETBUFFER (object, current_buffer);
@@ -1042,11 +1092,14 @@ DEFUN ("next-single-property-change", Fnext_single_property_change,
     return limit;
 
   here_val = textget (i->plist, prop);
-  next = next_interval (i);
+  /* If PROP has its default value here, only intervals that mention
+     PROP can change it, so skip the others.  */
+  mask = EQ (here_val, textget (Qnil, prop)) ? interval_props_mask (prop) : 0;
+  next = mask ? next_interval_with_props (i, mask) : next_interval (i);
   while (next
 	 && EQ (here_val, textget (next->plist, prop))
 	 && (NILP (limit) || next->position < XFIXNUM (limit)))
-    next = next_interval (next);
+    next = mask ? next_interval_with_props (next, mask) : next_interval (next);
 
   if (!next
       || (next->position
@@ -1127,6 +1180,7 @@ DEFUN ("previous-single-property-change", Fprevious_single_property_change,
 {
   register INTERVAL i, previous;
   register Lisp_Object here_val;
+  unsigned int mask;
 
   if (NILP (object))
     XSETBUFFER (object, current_buffer);
@@ -1144,12 +1198,15 @@ DEFUN ("previous-single-property-change", Fprevious_single_property_change,
     return limit;
 
   here_val = textget (i->plist, prop);
-  previous = previous_interval (i);
+  mask = EQ (here_val, textget (Qnil, prop)) ? interval_props_mask (prop) : 0;
+  previous = (mask ? previous_interval_with_props (i, mask)
+	      : previous_interval (i));
   while (previous
 	 && EQ (here_val, textget (previous->plist, prop))
 	 && (NILP (limit)
 	     || (previous->position + LENGTH (previous) > XFIXNUM (limit))))
-    previous = previous_interval (previous);
+    previous = (mask ? previous_interval_with_props (previous, mask)
+		: previous_interval (previous));
 
   if (!previous
       || (previous->position + LENGTH (previous)
@@ -1230,7 +1287,8 @@ add_text_properties_1 (Lisp_Object start, Lisp_Object end,
       ptrdiff_t prev_total_length = TOTAL_LENGTH (i);
       ptrdiff_t prev_pos = i->position;
 
-      modify_text_properties (object, start, end);
+      modify_text_properties (object, start, end,
+			      property_effects (properties, true));
       /* If someone called us recursively as a side effect of
 	 modify_text_properties, and changed the intervals behind our back
 	 (could happen if lock_file, called by prepare_to_modify_buffer,
@@ -1437,7 +1495,7 @@ set_text_properties (Lisp_Object start, Lisp_Object end, Lisp_Object properties,
       ptrdiff_t prev_length = LENGTH (i);
       ptrdiff_t prev_pos = i->position;
 
-      modify_text_properties (object, start, end);
+      modify_text_properties (object, start, end, AFFECTS_ALL);
       /* If someone called us recursively as a side effect of
 	 modify_text_properties, and changed the intervals behind our
 	 back, we cannot continue with I, because its data changed.
@@ -1620,7 +1678,8 @@ DEFUN ("remove-text-properties", Fremove_text_properties,
       ptrdiff_t prev_total_length = TOTAL_LENGTH (i);
       ptrdiff_t prev_pos = i->position;
 
-      modify_text_properties (object, start, end);
+      modify_text_properties (object, start, end,
+			      property_effects (properties, true));
       /* If someone called us recursively as a side effect of
 	 modify_text_properties, and changed the intervals behind our back
 	 (could happen if lock_file, called by prepare_to_modify_buffer,
@@ -1706,6 +1765,7 @@ DEFUN ("remove-list-of-text-properties", Fremove_list_of_text_properties,
   bool modified = false;
   Lisp_Object properties;
   properties = list_of_properties;
+  int effects = property_effects (properties, false);
 
   if (NILP (object))
     XSETBUFFER (object, current_buffer);
@@ -1769,7 +1829,7 @@ DEFUN ("remove-list-of-text-properties", Fremove_list_of_text_properties,
 	  else if (LENGTH (i) == len)
 	    {
 	      if (!modified && BUFFERP (object))
-		modify_text_properties (object, start, end);
+		modify_text_properties (object, start, end, effects);
 	      remove_properties (Qnil, properties, i, object);
 	      if (BUFFERP (object))
 		signal_after_change (XFIXNUM (start), XFIXNUM (end) - XFIXNUM (start),
@@ -1782,7 +1842,7 @@ DEFUN ("remove-list-of-text-properties", Fremove_list_of_text_properties,
 	      i = split_interval_left (i, len);
 	      copy_properties (unchanged, i);
 	      if (!modified && BUFFERP (object))
-		modify_text_properties (object, start, end);
+		modify_text_properties (object, start, end, effects);
 	      remove_properties (Qnil, properties, i, object);
 	      if (BUFFERP (object))
 		signal_after_change (XFIXNUM (start), XFIXNUM (end) - XFIXNUM (start),
@@ -1793,7 +1853,7 @@ DEFUN ("remove-list-of-text-properties", Fremove_list_of_text_properties,
       if (interval_has_some_properties_list (properties, i))
 	{
 	  if (!modified && BUFFERP (object))
-	    modify_text_properties (object, start, end);
+	    modify_text_properties (object, start, end, effects);
 	  remove_properties (Qnil, properties, i, object);
 	  modified = true;
 	}
@@ -1827,6 +1887,7 @@ DEFUN ("text-property-any", Ftext_property_any,
 {
   register INTERVAL i;
   register ptrdiff_t e, pos;
+  unsigned int mask;
 
   if (NILP (object))
     XSETBUFFER (object, current_buffer);
@@ -1834,6 +1895,10 @@ DEFUN ("text-property-any", Ftext_property_any,
   if (!i)
     return (!NILP (value) || EQ (start, end) ? Qnil : start);
   e = XFIXNUM (end);
+  /* Intervals that don't mention PROPERTY have its default value, so
+     they can be skipped unless that is what we are looking for.  */
+  mask = (EQ (value, textget (Qnil, property))
+	  ? 0 : interval_props_mask (property));
 
   while (i)
     {
@@ -1846,7 +1911,7 @@ DEFUN ("text-property-any", Ftext_property_any,
 	    pos = XFIXNUM (start);
 	  return make_fixnum (pos);
 	}
-      i = next_interval (i);
+      i = mask ? next_interval_with_props (i, mask) : next_interval (i);
     }
   return Qnil;
 }
@@ -1863,6 +1928,7 @@ DEFUN ("text-property-not-all", Ftext_property_not_all,
 {
   register INTERVAL i;
   register ptrdiff_t s, e;
+  unsigned int mask;
 
   if (NILP (object))
     XSETBUFFER (object, current_buffer);
@@ -1871,6 +1937,10 @@ DEFUN ("text-property-not-all", Ftext_property_not_all,
     return (NILP (value) || EQ (start, end)) ? Qnil : start;
   s = XFIXNUM (start);
   e = XFIXNUM (end);
+  /* If VALUE is the default, intervals that don't mention PROPERTY
+     can't differ from it.  */
+  mask = (EQ (value, textget (Qnil, property))
+	  ? interval_props_mask (property) : 0);
 
   while (i)
     {
@@ -1882,7 +1952,7 @@ DEFUN ("text-property-not-all", Ftext_property_not_all,
 	    s = i->position;
 	  return make_fixnum (s);
 	}
-      i = next_interval (i);
+      i = mask ? next_interval_with_props (i, mask) : next_interval (i);
     }
   return Qnil;
 }
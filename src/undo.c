@@ -128,9 +128,12 @@ record_marker_adjustments (ptrdiff_t from, ptrdiff_t to)
 {
   prepare_record ();
 
+  if (!markers_in_range_p (current_buffer, from, to))
+    return;
+
   for (struct Lisp_Marker *m = BUF_MARKERS (current_buffer); m; m = m->next)
     {
-      ptrdiff_t charpos = m->charpos;
+      ptrdiff_t charpos = marker_charpos (m);
       eassert (charpos <= Z);
 
       if (from <= charpos && charpos <= to)
@@ -281,6 +284,26 @@ DEFUN ("undo-boundary", Fundo_boundary, Sundo_boundary, 0, 0, 0,
   return Qnil;
 }
 
+/* If NEXT is where truncate_undo_list started scanning the undo
+   records of B's most recent command last time, and the records it
+   scanned still end at an undo boundary, add their size to *SIZE and
+   return the last cons of those records.  Otherwise, return nil.  */
+
+static Lisp_Object
+skip_scanned_undo_records (struct buffer *b, Lisp_Object next,
+			   intmax_t *size)
+{
+  Lisp_Object end = b->undo_scan_end;
+
+  if (EQ (next, b->undo_scan_start) && CONSP (end)
+      && (!CONSP (XCDR (end)) || NILP (XCAR (XCDR (end)))))
+    {
+      *size += b->undo_scan_size;
+      return end;
+    }
+  return Qnil;
+}
+
 /* At garbage collection time, make an undo list shorter at the end,
    returning the truncated list.  How this is done depends on the
    variables undo-limit, undo-strong-limit and undo-outer-limit.
@@ -290,8 +313,9 @@ DEFUN ("undo-boundary", Fundo_boundary, Sundo_boundary, 0, 0, 0,
 truncate_undo_list (struct buffer *b)
 {
   Lisp_Object list;
-  Lisp_Object prev, next, last_boundary;
-  intmax_t size_so_far = 0;
+  Lisp_Object prev, next, last_boundary, scan_start, end;
+  intmax_t size_so_far = 0, scan_size;
+  bool scan_markers = false;
 
   /* Make sure that calling undo-outer-limit-function
      won't cause another GC.  */
@@ -326,9 +350,24 @@ truncate_undo_list (struct buffer *b)
      Skip, skip, skip the undo, skip, skip, skip the undo,
      Skip, skip, skip the undo, skip to the undo bound'ry.  */
 
+  scan_start = next;
+  scan_size = size_so_far;
   while (CONSP (next) && ! NILP (XCAR (next)))
     {
       Lisp_Object elt;
+
+      /* Don't scan again what the previous garbage collection
+	 scanned, since a command that changes a lot of text can
+	 record millions of changes.  */
+      end = skip_scanned_undo_records (b, next, &size_so_far);
+      if (!NILP (end))
+	{
+	  scan_markers |= b->undo_scan_markers;
+	  prev = end;
+	  next = XCDR (end);
+	  break;
+	}
+
       elt = XCAR (next);
 
       /* Add in the space occupied by this element and its chain link.  */
@@ -336,6 +375,7 @@ truncate_undo_list (struct buffer *b)
       if (CONSP (elt))
 	{
 	  size_so_far += sizeof (struct Lisp_Cons);
+	  scan_markers |= MARKERP (XCAR (elt));
 	  if (STRINGP (XCAR (elt)))
 	    size_so_far += (sizeof (struct Lisp_String) - 1
 			    + SCHARS (XCAR (elt)));
@@ -346,6 +386,14 @@ truncate_undo_list (struct buffer *b)
       next = XCDR (next);
     }
 
+  if (!EQ (next, scan_start))
+    {
+      b->undo_scan_start = scan_start;
+      b->undo_scan_end = prev;
+      b->undo_scan_size = size_so_far - scan_size;
+      b->undo_scan_markers = scan_markers;
+    }
+
   /* If by the first boundary we have already passed undo_outer_limit,
      we're heading for memory full, so offer to clear out the list.  */
   intmax_t undo_outer_limit;
@@ -375,6 +423,15 @@ truncate_undo_list (struct buffer *b)
   while (CONSP (next))
     {
       Lisp_Object elt;
+
+      end = skip_scanned_undo_records (b, next, &size_so_far);
+      if (!NILP (end))
+	{
+	  prev = end;
+	  next = XCDR (end);
+	  continue;
+	}
+
       elt = XCAR (next);
 
       /* When we get to a boundary, decide whether to truncate
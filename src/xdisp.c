@@ -1030,6 +1030,13 @@ #define CLEAR_IMAGE_CACHE_COUNT	101
 
 bool redisplaying_p;
 
+/* Counts of redisplay events, indexed by enum redisplay_counter, and
+   seconds spent in each phase, indexed by enum redisplay_phase.  See
+   `redisplay-statistics'.  */
+
+intmax_t redisplay_counters[RC_MAX];
+double redisplay_phase_seconds[RP_MAX];
+
 /* True while some display-engine code is working on layout of some
    window.
 
@@ -1143,6 +1150,9 @@ #define THIN_SPACE_WIDTH 1
 static void next_overlay_string (struct it *);
 static void reseat (struct it *, struct text_pos, bool);
 static void reseat_1 (struct it *, struct text_pos, bool);
+static void start_display_checkpoints (struct it *, ptrdiff_t);
+static bool reseat_at_display_checkpoint (struct it *, ptrdiff_t, ptrdiff_t);
+static void record_display_checkpoint (struct it *);
 static bool next_element_from_display_vector (struct it *);
 static bool next_element_from_string (struct it *);
 static bool next_element_from_c_string (struct it *);
@@ -3180,8 +3190,10 @@ init_iterator (struct it *it, struct window *w,
 
   /* If face attributes have been changed since the last redisplay,
      free realized faces now because they depend on face definitions
-     that might have changed.  Don't free faces while there might be
-     desired matrices pending which reference these faces.  */
+     that might have changed.  If only named faces of this frame
+     changed, realized faces that are still in use can be kept.  Don't
+     free faces while there might be desired matrices pending which
+     reference these faces.  */
   if (!inhibit_free_realized_faces)
     {
       if (face_change)
@@ -3193,7 +3205,7 @@ init_iterator (struct it *it, struct window *w,
       else if (XFRAME (w->frame)->face_change)
 	{
 	  XFRAME (w->frame)->face_change = 0;
-	  free_all_realized_faces (w->frame);
+	  refresh_realized_faces (XFRAME (w->frame));
 	}
     }
 
@@ -3582,6 +3594,8 @@ start_display (struct it *it, struct window *w, struct text_pos pos)
 	  int new_x;
 
 	  reseat_at_previous_visible_line_start (it);
+	  reseat_at_display_checkpoint (it, it->checkpoint_line_beg,
+					CHARPOS (pos));
 	  move_it_to (it, CHARPOS (pos), -1, -1, -1, MOVE_TO_POS);
 
 	  new_x = it->current_x + it->pixel_width;
@@ -7435,11 +7449,142 @@ back_to_previous_visible_line_start (struct it *it)
 reseat_at_previous_visible_line_start (struct it *it)
 {
   back_to_previous_visible_line_start (it);
+  ptrdiff_t line_beg = IT_CHARPOS (*it);
   reseat (it, it->current.pos, true);
+  start_display_checkpoints (it, line_beg);
   CHECK_IT (it);
 }
 
 
+/***********************************************************************
+			 Display checkpoints
+ ***********************************************************************/
+
+/* When move_it_to lays out a long line from its beginning on a text
+   terminal, it records every so often where one of the screen lines
+   starts, and the total width of the screen lines before it, in the
+   buffer's column cache; see indent.c.  Later layouts of the same
+   line by start_display, move_it_vertically_backward and
+   move_it_by_lines start from the last such checkpoint before where
+   they are going instead of from the beginning of the line.  When the
+   text is reordered, get_visually_first_element likewise primes the
+   bidi iterator from the last checkpoint before a position in the
+   middle of the line, such as a window start.
+
+   A checkpoint is only recorded where laying out the line afresh
+   gives the same screen lines as continuing to lay it out: at a
+   single-column character from the buffer that no overlay starts or
+   ends at and, if the text is reordered, that is at the base level of
+   a left-to-right paragraph with nothing pending from the text before
+   it.  Under word-wrap, the screen line before the checkpoint ends
+   where the word starting there overflows it, so that word must be
+   short enough for flush_column_cache to discard the checkpoint when
+   the word changes.
+
+   On graphical frames, the widths of characters depend on fonts that
+   can change without the checkpoints being discarded, so they don't
+   use display checkpoints.  Neither do windows that show line
+   numbers, whose widths depend on the line, nor buffers whose long
+   lines the display engine lays out in narrowed parts, because
+   long_line_optimizations_p is set.  */
+
+/* Return true if IT can use display checkpoints.  */
+
+static bool
+display_checkpoints_p (struct it *it)
+{
+  return (!FRAME_WINDOW_P (it->f)
+	  && XBUFFER (it->w->contents) == current_buffer
+	  && !current_buffer->long_line_optimizations_p
+	  && NILP (Vdisplay_line_numbers)
+	  && it->selective == 0
+	  && !word_wrap_by_category
+	  && !composition_break_at_point);
+}
+
+/* Note that IT has just been reseated at LINE_BEG, the start of a
+   line, so that it can record display checkpoints of that line.  */
+
+static void
+start_display_checkpoints (struct it *it, ptrdiff_t line_beg)
+{
+  it->checkpoint_line_beg = line_beg;
+  it->next_checkpoint_charpos = line_beg + COLUMN_CHECKPOINT_INTERVAL;
+}
+
+/* If the line starting at LINE_BEG has a display checkpoint at or
+   before CHARPOS, reseat IT at the last such checkpoint, as if it had
+   laid out the line from LINE_BEG, and return true.  Otherwise,
+   return false and leave IT alone.  */
+
+static bool
+reseat_at_display_checkpoint (struct it *it, ptrdiff_t line_beg,
+			      ptrdiff_t charpos)
+{
+  struct display_checkpoint cp;
+
+  if (!display_checkpoints_p (it)
+      || !find_display_checkpoint (it, line_beg, charpos, &cp))
+    return false;
+
+  struct text_pos pos;
+  SET_TEXT_POS (pos, cp.charpos, cp.bytepos);
+  reseat (it, pos, true);
+  it->continuation_lines_width = cp.continuation_lines_width;
+  it->checkpoint_line_beg = line_beg;
+  it->next_checkpoint_charpos = cp.charpos + COLUMN_CHECKPOINT_INTERVAL;
+  return true;
+}
+
+/* Record a display checkpoint at IT's position, if IT is at the start
+   of a continuation line that it can be.  */
+
+static void
+record_display_checkpoint (struct it *it)
+{
+  ptrdiff_t charpos = IT_CHARPOS (*it), bytepos = IT_BYTEPOS (*it);
+
+  if (!(it->checkpoint_line_beg > 0
+	&& charpos >= it->next_checkpoint_charpos
+	&& it->method == GET_FROM_BUFFER
+	&& it->sp == 0
+	&& it->what == IT_CHARACTER
+	&& it->current.dpvec_index < 0
+	&& it->c > ' ' && it->c < 0177
+	&& NILP (it->min_width_property)
+	&& (!it->bidi_p || bidi_restartable_p (&it->bidi_it))
+	&& display_checkpoints_p (it)
+	&& next_overlay_change (charpos - 1) > charpos))
+    return;
+
+  /* Under word-wrap, the previous screen line can end where the word
+     starting here overflows it, before the next whitespace at the
+     latest.  Only record a checkpoint if that whitespace is close,
+     with no change of properties before it.  */
+  if (it->line_wrap == WORD_WRAP)
+    {
+      ptrdiff_t pos = charpos, pos_byte = bytepos;
+      ptrdiff_t limit = min (it->stop_charpos,
+			     charpos + TEXT_PROP_DISTANCE_LIMIT);
+
+      while (pos < limit && pos < ZV
+	     && FETCH_BYTE (pos_byte) != ' '
+	     && FETCH_BYTE (pos_byte) != '\t'
+	     && FETCH_BYTE (pos_byte) != '\n')
+	inc_both (&pos, &pos_byte);
+      if (!((pos < limit && pos < ZV) || pos == Z))
+	return;
+    }
+
+  add_display_checkpoint (it, (struct display_checkpoint)
+			  { .line_beg = it->checkpoint_line_beg,
+			    .charpos = charpos, .bytepos = bytepos,
+			    .continuation_lines_width
+			      = it->continuation_lines_width });
+  it->next_checkpoint_charpos = charpos + COLUMN_CHECKPOINT_INTERVAL;
+}
+
+
 /* Reseat iterator IT on the next visible line start in the current
    buffer.  ON_NEWLINE_P means position IT on the newline
    preceding the line start.  Skip over invisible text that is so
@@ -7638,6 +7783,7 @@ reseat_1 (struct it *it, struct text_pos pos, bool set_stop_p)
   /* This make the information stored in it->cmp_it invalidate.  */
   it->cmp_it.id = -1;
   it->min_width_property = Qnil;
+  it->checkpoint_line_beg = 0;
 }
 
 
@@ -8901,6 +9047,17 @@ get_visually_first_element (struct it *it)
 						      &it->bidi_it.bytepos),
 				it->narrowed_begv);
       bidi_paragraph_init (it->paragraph_embedding, &it->bidi_it, true);
+      /* Reordering the line from a display checkpoint before our
+	 position gets there the same way, only sooner.  */
+      struct display_checkpoint cp;
+      if (!string_p
+	  && display_checkpoints_p (it)
+	  && find_display_checkpoint (it, it->bidi_it.charpos,
+				      IT_CHARPOS (*it), &cp))
+	{
+	  it->bidi_it.charpos = cp.charpos;
+	  it->bidi_it.bytepos = cp.bytepos;
+	}
       do
 	{
 	  /* Now return to buffer/string position where we were asked
@@ -10540,6 +10697,7 @@ move_it_to (struct it *it, ptrdiff_t to_charpos, int to_x, int to_y, int to_vpos
 	    it->override_ascent = -1;
 	  set_iterator_to_next (it, true);
 	  it->continuation_lines_width = 0;
+	  it->checkpoint_line_beg = 0;
 	  break;
 
 	case MOVE_LINE_TRUNCATED:
@@ -10622,8 +10780,15 @@ move_it_to (struct it *it, ptrdiff_t to_charpos, int to_x, int to_y, int to_vpos
 	      if (IT_CHARPOS (*it) == orig_charpos
 		  && it->method == orig_method
 		  && orig_method == GET_FROM_BUFFER)
-		set_iterator_to_next (it, false);
-	      it->continuation_lines_width += it->current_x;
+		{
+		  set_iterator_to_next (it, false);
+		  it->continuation_lines_width += it->current_x;
+		}
+	      else
+		{
+		  it->continuation_lines_width += it->current_x;
+		  record_display_checkpoint (it);
+		}
 	    }
 	  break;
 
@@ -10716,21 +10881,31 @@ move_it_vertically_backward (struct it *it, int dy)
   while (nlines-- && IT_CHARPOS (*it) > pos_limit)
     back_to_previous_visible_line_start (it);
 
-  /* Move one line more back, for the (rare) situation where we have
-     bidi-reordered continued lines, and we start from the top-most
-     screen line, which is the last in logical order.  */
-  if (it->bidi_p && dy == 0)
-    back_to_previous_visible_line_start (it);
-  /* Reseat the iterator here.  When moving backward, we don't want
-     reseat to skip forward over invisible text, set up the iterator
-     to deliver from overlay strings at the new position etc.  So,
-     use reseat_1 here.  */
-  reseat_1 (it, it->current.pos, true);
+  /* In a long line, start from its last display checkpoint before
+     where we are going.  The screen lines from there on show no text
+     before the checkpoint, so we need not move one more line back for
+     bidi-reordered text, as below.  */
+  if (!reseat_at_display_checkpoint (it, IT_CHARPOS (*it),
+				     dy == 0 ? start_pos : pos_limit))
+    {
+      /* Move one line more back, for the (rare) situation where we
+	 have bidi-reordered continued lines, and we start from the
+	 top-most screen line, which is the last in logical order.  */
+      if (it->bidi_p && dy == 0)
+	back_to_previous_visible_line_start (it);
+      /* Reseat the iterator here.  When moving backward, we don't
+	 want reseat to skip forward over invisible text, set up the
+	 iterator to deliver from overlay strings at the new position
+	 etc.  So, use reseat_1 here.  */
+      reseat_1 (it, it->current.pos, true);
+      start_display_checkpoints (it, IT_CHARPOS (*it));
+
+      /* We are now surely at a line start.  */
+      it->continuation_lines_width = 0;
+    }
 
-  /* We are now surely at a line start.  */
   it->current_x = it->hpos = 0;	/* FIXME: this is incorrect when bidi
 				   reordering is in effect.  */
-  it->continuation_lines_width = 0;
 
   /* Move forward and see what y-distance we moved.  First move to the
      start of the next line so that we get its height.  We need this
@@ -10965,8 +11140,9 @@ move_it_by_lines (struct it *it, ptrdiff_t dvpos)
       ptrdiff_t start_charpos, i;
       int nchars_per_row
 	= (it->last_visible_x - it->first_visible_x) / FRAME_COLUMN_WIDTH (it->f);
-      bool hit_pos_limit = false;
+      bool hit_pos_limit = false, from_checkpoint;
       ptrdiff_t pos_limit;
+      struct text_pos line_start;
 
       /* Start at the beginning of the screen line containing IT's
 	 position.  This may actually move vertically backwards,
@@ -10988,7 +11164,16 @@ move_it_by_lines (struct it *it, ptrdiff_t dvpos)
 	back_to_previous_visible_line_start (it);
       if (i > 0 && IT_CHARPOS (*it) <= pos_limit)
 	hit_pos_limit = true;
-      reseat (it, it->current.pos, true);
+      line_start = it->current.pos;
+      from_checkpoint
+	= reseat_at_display_checkpoint (it, CHARPOS (line_start), pos_limit);
+
+    reseat_at_line_start:
+      if (!from_checkpoint)
+	{
+	  reseat (it, line_start, true);
+	  start_display_checkpoints (it, CHARPOS (line_start));
+	}
 
       /* Move further back if we end up in a string or an image.  */
       while (!IT_POS_VALID_AFTER_MOVE_P (it))
@@ -11013,6 +11198,16 @@ move_it_by_lines (struct it *it, ptrdiff_t dvpos)
       SAVE_IT (it2, *it, it2data);
       it2.vpos = it2.current_y = 0;
       move_it_to (&it2, start_charpos, -1, -1, -1, MOVE_TO_POS);
+
+      /* If the screen lines after the display checkpoint hold more
+	 characters than we assumed, we did not move far enough back;
+	 start from the beginning of the line instead.  */
+      if (from_checkpoint && it2.vpos < -dvpos)
+	{
+	  RESTORE_IT (it, it, it2data);
+	  from_checkpoint = false;
+	  goto reseat_at_line_start;
+	}
       it->vpos -= it2.vpos;
       it->current_y -= it2.current_y;
       it->current_x = it->hpos = 0;
@@ -16474,6 +16669,12 @@ redisplay_internal (void)
   /* Record this function, so it appears on the profiler's backtraces.  */
   record_in_backtrace (Qredisplay_internal_xC_functionx, 0, 0);
 
+  struct timespec redisplay_start = current_timespec ();
+  redisplay_counters[RC_REDISPLAYS]++;
+#ifdef HAVE_WINDOW_SYSTEM
+  reset_image_load_time ();
+#endif
+
   FOR_EACH_FRAME (tail, frame)
     XFRAME (frame)->already_hscrolled_p = false;
 
@@ -16788,6 +16989,7 @@ #define AINC(a,i)							\
 	      /* Update hint: No need to try to scroll in update_window.  */
 	      w->desired_matrix->no_scrolling_p = true;
 
+	      redisplay_counters[RC_OPTIMIZATION_1]++;
 #ifdef GLYPH_DEBUG
 	      *w->desired_matrix->method = 0;
 	      debug_method_add (w, "optimization 1");
@@ -16869,6 +17071,7 @@ #define AINC(a,i)							\
 	      set_cursor_from_row (w, row, w->current_matrix, 0, 0, 0, 0);
 	      if (cursor_row_fully_visible_p (w, false, true, false))
 		{
+		  redisplay_counters[RC_OPTIMIZATION_3]++;
 #ifdef GLYPH_DEBUG
 		  *w->desired_matrix->method = 0;
 		  debug_method_add (w, "optimization 3");
@@ -17242,6 +17445,7 @@ #define AINC(a,i)							\
     }
 
 #ifdef HAVE_WINDOW_SYSTEM
+  limit_image_caches ();
   if (clear_image_cache_count > CLEAR_IMAGE_CACHE_COUNT)
     {
       clear_image_caches (Qnil);
@@ -17261,6 +17465,9 @@ #define AINC(a,i)							\
   if (max_redisplay_ticks > 0)
     update_redisplay_ticks (0, NULL);
 
+  redisplay_phase_seconds[RP_REDISPLAY]
+    += timespectod (timespec_sub (current_timespec (), redisplay_start));
+
   unbind_to (count, Qnil);
   RESUME_POLLING;
 }
@@ -17326,6 +17533,64 @@ unwind_display_working_on_window (void)
   display_working_on_window_p = false;
 }
 
+DEFUN ("redisplay-statistics", Fredisplay_statistics,
+       Sredisplay_statistics, 0, 1, 0,
+       doc: /* Return an alist of counters and timings kept by redisplay.
+Each element has the form (NAME . VALUE).  The counters are:
+
+  `redisplays'          redisplay cycles that examined any window
+  `windows'             windows considered for redisplay
+  `optimization-1'      windows where only the line of point was redrawn
+  `optimization-3'      windows where only the cursor moved in its line
+  `cursor-movement'     windows updated by just moving the cursor
+  `try-window-id'       attempts to redisplay only the changed lines
+  `try-window-id-hits'  attempts of `try-window-id' that succeeded
+  `reuse-matrix'        attempts to reuse rows of the current matrix
+  `reuse-matrix-hits'   attempts of `reuse-matrix' that succeeded
+  `try-window'          windows redisplayed from a given start
+  `scrolling'           windows scrolled to bring point into view
+  `recenter'            windows for which a new start was computed
+  `rows-displayed'      glyph rows produced by the display engine
+  `frame-updates'       frames updated
+  `rows-updated'        rows written to windows or terminal frames
+  `rows-moved'          rows of windows on window-system frames that
+                        were moved on the display instead of redrawn
+
+The elements `redisplay-time' and `update-time' give the seconds spent
+in all of redisplay and in updating frames, respectively.
+
+If RESET is non-nil, reset all counters and timings to zero after
+returning their values.  */)
+  (Lisp_Object reset)
+{
+  static short const counter_symbols[RC_MAX] =
+    {
+      SYMBOL_INDEX (Qredisplays), SYMBOL_INDEX (Qwindows),
+      SYMBOL_INDEX (Qoptimization_1), SYMBOL_INDEX (Qoptimization_3),
+      SYMBOL_INDEX (Qcursor_movement), SYMBOL_INDEX (Qtry_window_id),
+      SYMBOL_INDEX (Qtry_window_id_hits), SYMBOL_INDEX (Qreuse_matrix),
+      SYMBOL_INDEX (Qreuse_matrix_hits), SYMBOL_INDEX (Qtry_window),
+      SYMBOL_INDEX (Qscrolling), SYMBOL_INDEX (Qrecenter),
+      SYMBOL_INDEX (Qrows_displayed), SYMBOL_INDEX (Qframe_updates),
+      SYMBOL_INDEX (Qrows_updated), SYMBOL_INDEX (Qrows_moved)
+    };
+  static short const phase_symbols[RP_MAX] =
+    {
+      SYMBOL_INDEX (Qredisplay_time), SYMBOL_INDEX (Qupdate_time)
+    };
+  Lisp_Object val = statistics_alist (RC_MAX, counter_symbols,
+				      redisplay_counters,
+				      RP_MAX, phase_symbols,
+				      redisplay_phase_seconds);
+
+  if (!NILP (reset))
+    {
+      memset (redisplay_counters, 0, sizeof redisplay_counters);
+      memset (redisplay_phase_seconds, 0, sizeof redisplay_phase_seconds);
+    }
+  return val;
+}
+
 /* Mark the display of leaf window W as accurate or inaccurate.
    If ACCURATE_P, mark display of W as accurate.
    If !ACCURATE_P, arrange for W to be redisplayed the next
@@ -19457,6 +19722,8 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
   if (!just_this_one_p && needs_no_redisplay (w))
     return;
 
+  redisplay_counters[RC_WINDOWS]++;
+
   /* Make sure that both W's markers are valid.  */
   eassert (XMARKER (w->start)->buffer == buffer);
   eassert (XMARKER (w->pointm)->buffer == buffer);
@@ -19896,6 +20163,7 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
       switch (rc)
 	{
 	case CURSOR_MOVEMENT_SUCCESS:
+	  redisplay_counters[RC_CURSOR_MOVEMENT]++;
 	  used_current_matrix_p = true;
 	  goto done;
 
@@ -19934,7 +20202,10 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
       if (f->fonts_changed)
 	goto need_larger_matrices;
       if (tem > 0)
-	goto done;
+	{
+	  redisplay_counters[RC_TRY_WINDOW_ID_HITS]++;
+	  goto done;
+	}
 
       /* Otherwise try_window_id has returned -1 which means that we
 	 don't want the alternative below this comment to execute.  */
@@ -20084,6 +20355,7 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
       switch (ss)
 	{
 	case SCROLLING_SUCCESS:
+	  redisplay_counters[RC_SCROLLING]++;
 	  goto done;
 
 	case SCROLLING_NEED_LARGER_MATRICES:
@@ -20102,6 +20374,7 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
 
  recenter:
 
+  redisplay_counters[RC_RECENTER]++;
 #ifdef GLYPH_DEBUG
   debug_method_add (w, "recenter");
 #endif
@@ -20616,6 +20889,8 @@ try_window (Lisp_Object window, struct text_pos pos, int flags)
   struct frame *f = XFRAME (w->frame);
   int cursor_vpos = w->cursor.vpos;
 
+  redisplay_counters[RC_TRY_WINDOW]++;
+
   /* Make POS the new window start.  */
   set_marker_both (w->start, Qnil, CHARPOS (pos), BYTEPOS (pos));
 
@@ -20733,6 +21008,8 @@ try_window_reusing_current_matrix (struct window *w)
     return false;
 #endif
 
+  redisplay_counters[RC_REUSE_MATRIX]++;
+
   if (/* This function doesn't handle terminal frames.  */
       !FRAME_WINDOW_P (f)
       /* Don't try to reuse the display if windows have been split
@@ -20960,6 +21237,7 @@ try_window_reusing_current_matrix (struct window *w)
 #ifdef GLYPH_DEBUG
       debug_method_add (w, "try_window_reusing_current_matrix 1");
 #endif
+      redisplay_counters[RC_REUSE_MATRIX_HITS]++;
       return true;
     }
   else if (CHARPOS (new_start) > CHARPOS (start))
@@ -21147,6 +21425,7 @@ try_window_reusing_current_matrix (struct window *w)
 #ifdef GLYPH_DEBUG
       debug_method_add (w, "try_window_reusing_current_matrix 2");
 #endif
+      redisplay_counters[RC_REUSE_MATRIX_HITS]++;
       return true;
     }
 
@@ -21536,6 +21815,7 @@ #define GIVE_UP(X)						\
 #define GIVE_UP(X) return 0
 #endif
 
+  redisplay_counters[RC_TRY_WINDOW_ID]++;
   SET_TEXT_POS_FROM_MARKER (start, w->start);
 
   /* Don't use this for mini-windows because these can show
@@ -21561,9 +21841,12 @@ #define GIVE_UP(X) return 0
       || current_buffer->prevent_redisplay_optimizations_p)
     GIVE_UP (3);
 
-  /* Window must either use window-based redisplay or be full width.  */
+  /* Window must either use window-based redisplay or be full width.
+     The initial frame has no terminal to ask, so give up there too;
+     this matters when redisplay-skip-initial-frame is nil.  */
   if (!FRAME_WINDOW_P (f)
-      && (!FRAME_LINE_INS_DEL_OK (f)
+      && (FRAME_INITIAL_P (f)
+	  || !FRAME_LINE_INS_DEL_OK (f)
 	  || !WINDOW_FULL_WIDTH_P (w)))
     GIVE_UP (4);
 
@@ -24610,6 +24893,7 @@ display_line (struct it *it, int cursor_vpos)
 
   /* Clear the result glyph row and enable it.  */
   prepare_desired_row (it->w, row, false);
+  redisplay_counters[RC_ROWS_DISPLAYED]++;
 
   row->y = it->current_y;
   row->start = it->start;
@@ -24619,6 +24903,9 @@ display_line (struct it *it, int cursor_vpos)
   it->starts_in_middle_of_char_p = false;
   it->stretch_adjust = 0;
   it->line_number_produced_p = false;
+  /* We don't keep checkpoint_line_beg up to date when we reach the
+     end of a line below.  */
+  it->checkpoint_line_beg = 0;
 
   /* Arrange the overlays nicely for our purposes.  Usually, we call
      display_line on only one line at a time, in which case this
@@ -36289,6 +36576,7 @@ syms_of_xdisp (void)
 #endif
   defsubr (&Sline_pixel_height);
   defsubr (&Sformat_mode_line);
+  defsubr (&Sredisplay_statistics);
   defsubr (&Sinvisible_p);
   defsubr (&Scurrent_bidi_paragraph_direction);
   defsubr (&Swindow_text_pixel_size);
@@ -36307,6 +36595,26 @@ syms_of_xdisp (void)
   DEFSYM (Qeval, "eval");
   DEFSYM (QCdata, ":data");
 
+  /* Names of the elements of `redisplay-statistics'.  */
+  DEFSYM (Qredisplays, "redisplays");
+  DEFSYM (Qwindows, "windows");
+  DEFSYM (Qoptimization_1, "optimization-1");
+  DEFSYM (Qoptimization_3, "optimization-3");
+  DEFSYM (Qcursor_movement, "cursor-movement");
+  DEFSYM (Qtry_window_id, "try-window-id");
+  DEFSYM (Qtry_window_id_hits, "try-window-id-hits");
+  DEFSYM (Qreuse_matrix, "reuse-matrix");
+  DEFSYM (Qreuse_matrix_hits, "reuse-matrix-hits");
+  DEFSYM (Qtry_window, "try-window");
+  DEFSYM (Qscrolling, "scrolling");
+  DEFSYM (Qrecenter, "recenter");
+  DEFSYM (Qrows_displayed, "rows-displayed");
+  DEFSYM (Qframe_updates, "frame-updates");
+  DEFSYM (Qrows_updated, "rows-updated");
+  DEFSYM (Qrows_moved, "rows-moved");
+  DEFSYM (Qredisplay_time, "redisplay-time");
+  DEFSYM (Qupdate_time, "update-time");
+
   /* Names of text properties relevant for redisplay.  */
   DEFSYM (Qdisplay, "display");
   DEFSYM (Qspace_width, "space-width");
@@ -37101,6 +37409,13 @@ syms_of_xdisp (void)
 non-nil, see `get-char-code-property'.  */);
   bidi_inhibit_bpa = false;
 
+  DEFVAR_BOOL ("bidi--inhibit-ascii-fast-path", bidi__inhibit_ascii_fast_path,
+    doc: /* Non-nil means resolve every character of left-to-right text.
+Normally, reordering moves over ASCII letters on the base level of a
+left-to-right paragraph without resolving their bidi types.  This is
+for testing that shortcut, which should never change the display.  */);
+  bidi__inhibit_ascii_fast_path = false;
+
 #ifdef GLYPH_DEBUG
   DEFVAR_BOOL ("inhibit-try-window-id", inhibit_try_window_id,
 	       doc: /* Inhibit try_window_id display optimization.  */);
@@ -344,6 +344,26 @@ #define CLEAR_FONT_TABLE_NFONTS	10
 
 bool face_change;
 
+/* Counts of face cache events, and seconds spent realizing faces.
+   See `face-cache-statistics'.  */
+
+enum face_cache_counter
+  {
+    FC_LOOKUPS,
+    FC_HITS,
+    FC_REALIZED,
+    FC_REALIZED_NON_ASCII,
+    FC_FREED,
+    FC_FLUSHES,
+    FC_REFRESHES,
+    FC_MERGE_LOOKUPS,
+    FC_MERGE_HITS,
+    FC_MAX
+  };
+
+static intmax_t face_cache_counters[FC_MAX];
+static double face_realization_seconds;
+
 /* True means don't display bold text if a face's foreground
    and background colors are the inverse of the default colors of the
    display.   This is a kluge to suppress `bold black' foreground text
@@ -373,11 +393,12 @@ #define CLEAR_FONT_TABLE_NFONTS	10
 				      Lisp_Object [LFACE_VECTOR_SIZE]);
 static struct face *realize_tty_face (struct face_cache *,
 				      Lisp_Object [LFACE_VECTOR_SIZE]);
-static bool realize_basic_faces (struct frame *);
+static bool realize_basic_faces (struct frame *, bool);
 static bool realize_default_face (struct frame *);
-static void realize_named_face (struct frame *, Lisp_Object, int);
+static void realize_named_face (struct frame *, Lisp_Object, int, bool);
 static struct face_cache *make_face_cache (struct frame *);
 static void free_face_cache (struct face_cache *);
+static void uncache_face (struct face_cache *, struct face *);
 static bool merge_face_ref (struct window *w,
                             struct frame *, Lisp_Object, Lisp_Object *,
                             bool, struct named_merge_point *,
@@ -658,7 +679,7 @@ init_frame_faces (struct frame *f)
 #endif /* HAVE_WINDOW_SYSTEM */
 
   /* Realize faces early (Bug#17889).  */
-  if (!realize_basic_faces (f))
+  if (!realize_basic_faces (f, false))
     emacs_abort ();
 }
 
@@ -703,7 +724,7 @@ recompute_basic_faces (struct frame *f)
   if (FRAME_FACE_CACHE (f))
     {
       clear_face_cache (false);
-      if (!realize_basic_faces (f))
+      if (!realize_basic_faces (f, false))
 	emacs_abort ();
     }
 }
@@ -762,6 +783,66 @@ DEFUN ("clear-face-cache", Fclear_face_cache, Sclear_face_cache, 0, 1, 0,
   windows_or_buffers_changed = 53;
   return Qnil;
 }
+DEFUN ("face-cache-statistics", Fface_cache_statistics,
+       Sface_cache_statistics, 0, 1, 0,
+       doc: /* Return an alist of counters kept by the face caches of all frames.
+Each element has the form (NAME . VALUE).  The element `faces' gives
+the number of faces currently realized.  The counters are:
+
+  `lookups'             lookups of faces by their merged attributes
+  `hits'                lookups that found a face already realized
+  `realized'            faces realized for ASCII characters
+  `realized-non-ascii'  faces derived from them for other fonts
+  `freed'               realized faces freed when flushing a cache
+  `flushes'             face caches of a frame flushed completely
+  `refreshes'           face definition changes handled by keeping
+                        the realized faces and redoing basic faces
+  `merge-lookups'       lookups of the faces merged at buffer positions
+                        in the memo of merged faces
+  `merge-hits'          lookups that found the merged face in the memo
+
+The element `realize-time' gives the seconds spent realizing faces.
+
+If RESET is non-nil, reset all counters to zero after returning their
+values.  */)
+  (Lisp_Object reset)
+{
+  static short const counter_symbols[FC_MAX] =
+    {
+      SYMBOL_INDEX (Qlookups), SYMBOL_INDEX (Qhits),
+      SYMBOL_INDEX (Qrealized), SYMBOL_INDEX (Qrealized_non_ascii),
+      SYMBOL_INDEX (Qfreed), SYMBOL_INDEX (Qflushes),
+      SYMBOL_INDEX (Qrefreshes), SYMBOL_INDEX (Qmerge_lookups),
+      SYMBOL_INDEX (Qmerge_hits)
+    };
+  static short const seconds_symbols[] = { SYMBOL_INDEX (Qrealize_time) };
+  Lisp_Object tail, frame;
+  intmax_t faces = 0;
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct face_cache *c = FRAME_FACE_CACHE (XFRAME (frame));
+      if (c)
+	for (int i = 0; i < c->used; i++)
+	  if (c->faces_by_id[i])
+	    faces++;
+    }
+
+  Lisp_Object val = statistics_alist (FC_MAX, counter_symbols,
+				      face_cache_counters,
+				      1, seconds_symbols,
+				      &face_realization_seconds);
+  val = Fcons (Fcons (Qfaces, make_int (faces)), val);
+
+  if (!NILP (reset))
+    {
+      memset (face_cache_counters, 0, sizeof face_cache_counters);
+      face_realization_seconds = 0;
+    }
+
+  return val;
+}
+
 
 
 /***********************************************************************
@@ -3791,7 +3872,7 @@ update_face_from_frame_parameter (struct frame *f, Lisp_Object param,
       lface = lface_from_face_name (f, face, true);
       ASET (lface, LFACE_FOREGROUND_INDEX,
 	    (STRINGP (new_value) ? new_value : Qunspecified));
-      realize_basic_faces (f);
+      realize_basic_faces (f, false);
     }
   else if (EQ (param, Qbackground_color))
     {
@@ -3807,7 +3888,7 @@ update_face_from_frame_parameter (struct frame *f, Lisp_Object param,
       lface = lface_from_face_name (f, face, true);
       ASET (lface, LFACE_BACKGROUND_INDEX,
 	    (STRINGP (new_value) ? new_value : Qunspecified));
-      realize_basic_faces (f);
+      realize_basic_faces (f, false);
     }
 #ifdef HAVE_WINDOW_SYSTEM
   else if (EQ (param, Qborder_color))
@@ -4721,6 +4802,8 @@ make_face_cache (struct frame *f)
   c->faces_by_id = xmalloc (c->size * sizeof *c->faces_by_id);
   c->f = f;
   c->menu_face_changed_p = menu_face_changed_default;
+  c->default_face_changed_p = false;
+  c->merge_memo = NULL;
   return c;
 }
 
@@ -4754,6 +4837,18 @@ clear_face_gcs (struct face_cache *c)
 
 #endif /* HAVE_WINDOW_SYSTEM */
 
+/* Forget the faces merged from stacks of face references that are
+   remembered in face cache C.  */
+
+static void
+flush_face_merge_memo (struct face_cache *c)
+{
+  if (c->merge_memo)
+    for (int i = 0; i < FACE_MERGE_MEMO_SIZE; i++)
+      c->merge_memo[i].refs = Qnil;
+}
+
+
 /* Free all realized faces in face cache C, including basic faces.
    C may be null.  If faces are freed, make sure the frame's current
    matrix is marked invalid, so that a display caused by an expose
@@ -4780,7 +4875,11 @@ free_realized_faces (struct face_cache *c)
 
       /* Forget the escape-glyph and glyphless-char faces.  */
       forget_escape_and_glyphless_faces ();
+      face_cache_counters[FC_FREED] += c->used;
+      face_cache_counters[FC_FLUSHES]++;
       c->used = 0;
+      c->default_face_changed_p = false;
+      flush_face_merge_memo (c);
       size = FACE_CACHE_BUCKETS_SIZE * sizeof *c->buckets;
       memset (c->buckets, 0, size);
 
@@ -4818,6 +4917,106 @@ free_all_realized_faces (Lisp_Object frame)
 }
 
 
+/* Free the faces of face cache C, other than the basic faces, that
+   were not used since C was last refreshed, together with the faces
+   for non-ASCII characters derived from them.  Mark the others as not
+   used since then.  */
+
+static void
+free_unused_faces (struct face_cache *c)
+{
+  int i;
+
+  /* Free the faces for non-ASCII characters first, so that no face
+     points to a freed ASCII face.  */
+  for (i = BASIC_FACE_ID_SENTINEL; i < c->used; i++)
+    {
+      struct face *face = c->faces_by_id[i];
+      if (face && face != face->ascii_face
+	  && face->ascii_face->id >= BASIC_FACE_ID_SENTINEL
+	  && !face->ascii_face->used_since_refresh_p)
+	{
+	  uncache_face (c, face);
+	  free_realized_face (c->f, face);
+	  face_cache_counters[FC_FREED]++;
+	}
+    }
+
+  for (i = BASIC_FACE_ID_SENTINEL; i < c->used; i++)
+    {
+      struct face *face = c->faces_by_id[i];
+      if (face && face == face->ascii_face && !face->used_since_refresh_p)
+	{
+	  uncache_face (c, face);
+	  free_realized_face (c->f, face);
+	  face_cache_counters[FC_FREED]++;
+	}
+    }
+
+  for (i = 0; i < c->used; i++)
+    if (c->faces_by_id[i])
+      c->faces_by_id[i]->used_since_refresh_p = false;
+}
+
+
+/* Bring the realized faces of frame F up to date after attributes of
+   named faces on F have changed.  Realized faces are looked up by
+   their fully merged attributes, so a face whose attributes were
+   merged from a changed named face is simply not found again, and
+   faces that are still in use need not be realized anew.  What must
+   be redone are the basic faces, which have fixed IDs; and if the
+   default face changed, or was realized again since the other faces
+   were, these may share its font and fontset, so all realized faces
+   are freed then.
+
+   The faces that are not found again would stay in the cache until it
+   is flushed, which happens rarely on window systems and never on
+   text terminals.  So the faces that were not used since the last
+   refresh are freed: those merged from former definitions of the
+   changed faces are among them, and any others are realized again
+   when needed.  */
+
+void
+refresh_realized_faces (struct frame *f)
+{
+  struct face_cache *c = FRAME_FACE_CACHE (f);
+  struct face *default_face;
+  Lisp_Object lface;
+
+  if (c == NULL || c->used == 0)
+    return;
+
+  default_face = FACE_FROM_ID_OR_NULL (f, DEFAULT_FACE_ID);
+  lface = lface_from_face_name (f, Qdefault, false);
+  if (default_face == NULL
+      || c->default_face_changed_p
+      || NILP (lface)
+      || !lface_fully_specified_p (XVECTOR (lface)->contents)
+      || !lface_equal_p (default_face->lface, XVECTOR (lface)->contents))
+    {
+      free_realized_faces (c);
+      return;
+    }
+
+  block_input ();
+  forget_escape_and_glyphless_faces ();
+  flush_face_merge_memo (c);
+  realize_basic_faces (f, true);
+  free_unused_faces (c);
+  face_cache_counters[FC_REFRESHES]++;
+
+  /* Current matrices may show glyphs in faces of the old definitions
+     under IDs that are still valid, so make sure everything is drawn
+     again.  */
+  if (WINDOWP (f->root_window))
+    {
+      clear_current_matrices (f);
+      fset_redisplay (f);
+    }
+  unblock_input ();
+}
+
+
 /* Free face cache C and faces in it, including their X resources.  */
 
 static void
@@ -4826,6 +5025,7 @@ free_face_cache (struct face_cache *c)
   if (c)
     {
       free_realized_faces (c);
+      xfree (c->merge_memo);
       xfree (c->buckets);
       xfree (c->faces_by_id);
       xfree (c);
@@ -4846,6 +5046,7 @@ cache_face (struct face_cache *c, struct face *face, uintptr_t hash)
   int i = hash % FACE_CACHE_BUCKETS_SIZE;
 
   face->hash = hash;
+  face->used_since_refresh_p = true;
 
   if (face->ascii_face != face)
     {
@@ -4961,8 +5162,14 @@ lookup_face (struct frame *f, Lisp_Object *attr)
     }
 
   /* If not found, realize a new face.  */
+  face_cache_counters[FC_LOOKUPS]++;
   if (face == NULL)
     face = realize_face (cache, attr, -1);
+  else
+    {
+      face_cache_counters[FC_HITS]++;
+      face->used_since_refresh_p = true;
+    }
 
 #ifdef GLYPH_DEBUG
   eassert (face == FACE_FROM_ID_OR_NULL (f, face->id));
@@ -5025,7 +5232,7 @@ lookup_named_face (struct window *w, struct frame *f,
 
   if (default_face == NULL)
     {
-      if (!realize_basic_faces (f))
+      if (!realize_basic_faces (f, false))
 	return -1;
       default_face = FACE_FROM_ID (f, DEFAULT_FACE_ID);
     }
@@ -5616,7 +5823,7 @@ Point (2) implies that a `:weight black' attribute will be satisfied by
   def_face = FACE_FROM_ID_OR_NULL (f, DEFAULT_FACE_ID);
   if (def_face == NULL)
     {
-      if (! realize_basic_faces (f))
+      if (! realize_basic_faces (f, false))
 	error ("Cannot realize default face");
       def_face = FACE_FROM_ID (f, DEFAULT_FACE_ID);
     }
@@ -5690,6 +5897,9 @@ DEFUN ("internal-set-font-selection-order",
     {
       memcpy (font_sort_order, indices, sizeof font_sort_order);
       free_all_realized_faces (Qnil);
+#ifdef HAVE_WINDOW_SYSTEM
+      clear_font_search_cache ();
+#endif
     }
 
   font_update_sort_order (font_sort_order);
@@ -5723,6 +5933,9 @@ DEFUN ("internal-set-alternative-font-family-alist",
 
   Vface_alternative_font_family_alist = alist;
   free_all_realized_faces (Qnil);
+#ifdef HAVE_WINDOW_SYSTEM
+  clear_font_search_cache ();
+#endif
   return alist;
 }
 
@@ -5782,10 +5995,12 @@ face_fontset (Lisp_Object attrs[LFACE_VECTOR_SIZE])
 
 /* Realize basic faces on frame F.  Value is zero if frame parameters
    of F don't contain enough information needed to realize the default
-   face.  */
+   face.  If REFRESH_P, the default face is known to be up to date, and
+   the other basic faces are realized again only if their attributes
+   have changed.  */
 
 static bool
-realize_basic_faces (struct frame *f)
+realize_basic_faces (struct frame *f, bool refresh_p)
 {
   bool success_p = false;
 
@@ -5793,28 +6008,34 @@ realize_basic_faces (struct frame *f)
      event, for instance, without having the faces set up.  */
   block_input ();
 
-  if (realize_default_face (f))
-    {
-      realize_named_face (f, Qmode_line_active, MODE_LINE_ACTIVE_FACE_ID);
-      realize_named_face (f, Qmode_line_inactive, MODE_LINE_INACTIVE_FACE_ID);
-      realize_named_face (f, Qtool_bar, TOOL_BAR_FACE_ID);
-      realize_named_face (f, Qfringe, FRINGE_FACE_ID);
-      realize_named_face (f, Qheader_line, HEADER_LINE_FACE_ID);
-      realize_named_face (f, Qscroll_bar, SCROLL_BAR_FACE_ID);
-      realize_named_face (f, Qborder, BORDER_FACE_ID);
-      realize_named_face (f, Qcursor, CURSOR_FACE_ID);
-      realize_named_face (f, Qmouse, MOUSE_FACE_ID);
-      realize_named_face (f, Qmenu, MENU_FACE_ID);
-      realize_named_face (f, Qvertical_border, VERTICAL_BORDER_FACE_ID);
-      realize_named_face (f, Qwindow_divider, WINDOW_DIVIDER_FACE_ID);
+  if (refresh_p || realize_default_face (f))
+    {
+      realize_named_face (f, Qmode_line_active, MODE_LINE_ACTIVE_FACE_ID,
+			  refresh_p);
+      realize_named_face (f, Qmode_line_inactive, MODE_LINE_INACTIVE_FACE_ID,
+			  refresh_p);
+      realize_named_face (f, Qtool_bar, TOOL_BAR_FACE_ID, refresh_p);
+      realize_named_face (f, Qfringe, FRINGE_FACE_ID, refresh_p);
+      realize_named_face (f, Qheader_line, HEADER_LINE_FACE_ID, refresh_p);
+      realize_named_face (f, Qscroll_bar, SCROLL_BAR_FACE_ID, refresh_p);
+      realize_named_face (f, Qborder, BORDER_FACE_ID, refresh_p);
+      realize_named_face (f, Qcursor, CURSOR_FACE_ID, refresh_p);
+      realize_named_face (f, Qmouse, MOUSE_FACE_ID, refresh_p);
+      realize_named_face (f, Qmenu, MENU_FACE_ID, refresh_p);
+      realize_named_face (f, Qvertical_border, VERTICAL_BORDER_FACE_ID,
+			  refresh_p);
+      realize_named_face (f, Qwindow_divider, WINDOW_DIVIDER_FACE_ID,
+			  refresh_p);
       realize_named_face (f, Qwindow_divider_first_pixel,
-			  WINDOW_DIVIDER_FIRST_PIXEL_FACE_ID);
+			  WINDOW_DIVIDER_FIRST_PIXEL_FACE_ID, refresh_p);
       realize_named_face (f, Qwindow_divider_last_pixel,
-			  WINDOW_DIVIDER_LAST_PIXEL_FACE_ID);
-      realize_named_face (f, Qinternal_border, INTERNAL_BORDER_FACE_ID);
-      realize_named_face (f, Qchild_frame_border, CHILD_FRAME_BORDER_FACE_ID);
-      realize_named_face (f, Qtab_bar, TAB_BAR_FACE_ID);
-      realize_named_face (f, Qtab_line, TAB_LINE_FACE_ID);
+			  WINDOW_DIVIDER_LAST_PIXEL_FACE_ID, refresh_p);
+      realize_named_face (f, Qinternal_border, INTERNAL_BORDER_FACE_ID,
+			  refresh_p);
+      realize_named_face (f, Qchild_frame_border, CHILD_FRAME_BORDER_FACE_ID,
+			  refresh_p);
+      realize_named_face (f, Qtab_bar, TAB_BAR_FACE_ID, refresh_p);
+      realize_named_face (f, Qtab_line, TAB_LINE_FACE_ID, refresh_p);
 
       /* Reflect changes in the `menu' face in menu bars.  */
       if (FRAME_FACE_CACHE (f)->menu_face_changed_p)
@@ -5961,10 +6182,13 @@ realize_default_face (struct frame *f)
 
 /* Realize basic faces other than the default face in face cache C.
    SYMBOL is the face name, ID is the face id the realized face must
-   have.  The default face must have been realized already.  */
+   have.  The default face must have been realized already.  If
+   REFRESH_P, keep the face realized with ID if it already has the
+   attributes SYMBOL now specifies.  */
 
 static void
-realize_named_face (struct frame *f, Lisp_Object symbol, int id)
+realize_named_face (struct frame *f, Lisp_Object symbol, int id,
+		    bool refresh_p)
 {
   struct face_cache *c = FRAME_FACE_CACHE (f);
   Lisp_Object lface = lface_from_face_name (f, symbol, false);
@@ -5996,6 +6220,10 @@ realize_named_face (struct frame *f, Lisp_Object symbol, int id)
   /* Merge SYMBOL's face with the default face.  */
   merge_face_vectors (NULL, f, symbol_attrs, attrs, 0);
 
+  if (refresh_p && id < c->used && c->faces_by_id[id]
+      && lface_equal_p (c->faces_by_id[id]->lface, attrs))
+    return;
+
   /* Realize the face.  */
   realize_face (c, attrs, id);
 }
@@ -6016,13 +6244,31 @@ realize_face (struct face_cache *cache, Lisp_Object attrs[LFACE_VECTOR_SIZE],
   eassert (cache != NULL);
   check_lface_attrs (attrs);
 
+  struct timespec start = current_timespec ();
+
   if (former_face_id >= 0 && cache->used > former_face_id)
     {
-      /* Remove the former face.  */
+      /* Remove the former face, and the faces for non-ASCII
+	 characters derived from it, which would otherwise keep
+	 pointing to it.  */
       struct face *former_face = cache->faces_by_id[former_face_id];
+      if (FRAME_WINDOW_P (cache->f))
+	for (int i = 0; i < cache->used; i++)
+	  {
+	    struct face *derived = cache->faces_by_id[i];
+	    if (derived && derived != former_face
+		&& derived->ascii_face == former_face)
+	      {
+		uncache_face (cache, derived);
+		free_realized_face (cache->f, derived);
+	      }
+	  }
       uncache_face (cache, former_face);
       free_realized_face (cache->f, former_face);
       SET_FRAME_GARBAGED (cache->f);
+      flush_face_merge_memo (cache);
+      if (former_face_id == DEFAULT_FACE_ID)
+	cache->default_face_changed_p = true;
     }
 
   if (FRAME_WINDOW_P (cache->f))
@@ -6039,6 +6285,10 @@ realize_face (struct face_cache *cache, Lisp_Object attrs[LFACE_VECTOR_SIZE],
 
   /* Insert the new face.  */
   cache_face (cache, face, lface_hash (attrs));
+
+  face_cache_counters[FC_REALIZED]++;
+  face_realization_seconds
+    += timespectod (timespec_sub (current_timespec (), start));
   return face;
 }
 
@@ -6070,6 +6320,7 @@ realize_non_ascii_face (struct frame *f, Lisp_Object font_object,
   face->gc = 0;
 
   cache_face (cache, face, face->hash);
+  face_cache_counters[FC_REALIZED_NON_ASCII]++;
 
   return face;
 }
@@ -6556,6 +6807,109 @@ compute_char_face (struct frame *f, int ch, Lisp_Object prop)
   return face_id;
 }
 
+/* Return true if face reference REF may be part of the key of an
+   entry in the memo of merged faces.  That is the case for face names
+   and for lists of atoms, such as lists of face names or property
+   lists of face attributes.  Other references may contain filters,
+   which depend on the window, and the memo keeps only a shallow copy
+   of each list to detect changes.  */
+
+static bool
+face_ref_memoizable_p (Lisp_Object ref)
+{
+  if (SYMBOLP (ref))
+    return true;
+
+  for (; CONSP (ref); ref = XCDR (ref))
+    {
+      Lisp_Object elt = XCAR (ref);
+      if (!(SYMBOLP (elt) || FIXNUMP (elt) || FLOATP (elt) || STRINGP (elt)))
+	return false;
+    }
+  return NILP (ref);
+}
+
+/* Merge the NREFS face references in REFS, in this order, into the
+   attributes of BASE_FACE on frame F, and return the ID of the
+   realized face for the result.  W is the window for which to merge.
+
+   The same stacks of faces from text properties and overlays are
+   found at many positions, so remember the face ID in the memo of
+   F's face cache, keyed by BASE_FACE, ATTR_FILTER and the references.
+   Face remapping may depend on W and is changed by modifying lists,
+   so don't use the memo when it is in effect.  */
+
+static int
+merge_face_stack (struct window *w, struct frame *f, struct face *base_face,
+		  Lisp_Object *refs, ptrdiff_t nrefs,
+		  enum lface_attribute_index attr_filter)
+{
+  struct face_cache *c = FRAME_FACE_CACHE (f);
+  struct face_merge_entry *e = NULL;
+  Lisp_Object attrs[LFACE_VECTOR_SIZE];
+  EMACS_UINT hash = sxhash_combine (base_face->id, attr_filter);
+  ptrdiff_t i;
+  int face_id;
+
+  if (nrefs > 0 && NILP (Vface_remapping_alist))
+    {
+      for (i = 0; i < nrefs; i++)
+	{
+	  if (!face_ref_memoizable_p (refs[i]))
+	    break;
+	  hash = sxhash_combine (hash, sxhash (refs[i]));
+	}
+
+      if (i == nrefs)
+	{
+	  if (c->merge_memo == NULL)
+	    {
+	      c->merge_memo = xmalloc (FACE_MERGE_MEMO_SIZE
+				       * sizeof *c->merge_memo);
+	      flush_face_merge_memo (c);
+	    }
+
+	  e = &c->merge_memo[hash % FACE_MERGE_MEMO_SIZE];
+	  face_cache_counters[FC_MERGE_LOOKUPS]++;
+	  if (!NILP (e->refs)
+	      && e->hash == hash
+	      && e->base_face_id == base_face->id
+	      && e->attr_filter == attr_filter
+	      && ASIZE (e->refs) == nrefs
+	      && FACE_FROM_ID_OR_NULL (f, e->face_id))
+	    {
+	      for (i = 0; i < nrefs; i++)
+		if (NILP (Fequal (AREF (e->refs, i), refs[i])))
+		  break;
+	      if (i == nrefs)
+		{
+		  face_cache_counters[FC_MERGE_HITS]++;
+		  return e->face_id;
+		}
+	    }
+	}
+    }
+
+  memcpy (attrs, base_face->lface, sizeof attrs);
+  for (i = 0; i < nrefs; i++)
+    merge_face_ref (w, f, refs[i], attrs, true, NULL, attr_filter);
+  face_id = lookup_face (f, attrs);
+
+  if (e)
+    {
+      Lisp_Object key = make_nil_vector (nrefs);
+      for (i = 0; i < nrefs; i++)
+	ASET (key, i, CONSP (refs[i]) ? Fcopy_sequence (refs[i]) : refs[i]);
+      e->refs = key;
+      e->hash = hash;
+      e->base_face_id = base_face->id;
+      e->face_id = face_id;
+      e->attr_filter = attr_filter;
+    }
+
+  return face_id;
+}
+
 /* Return the face ID associated with buffer position POS for
    displaying ASCII characters.  Return in *ENDPTR the position at
    which a different face is needed, as far as text properties and
@@ -6654,57 +7008,69 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
       return default_face->id;
     }
 
-  /* Begin with attributes from the default face.  */
-  memcpy (attrs, default_face->lface, sizeof(attrs));
-
-  /* Merge in attributes specified via text properties.  */
-  if (!NILP (prop))
-    merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
-
-  /* Now merge the overlay data.  */
   noverlays = sort_overlays (overlay_vec, noverlays, w);
-  /* For mouse-face, we need only the single highest-priority face
-     from the overlays, if any.  */
-  if (mouse)
+
+  if (!mouse)
     {
-      for (prop = Qnil, i = noverlays - 1; i >= 0 && NILP (prop); --i)
+      /* Collect the faces from the text property and from the
+	 overlays, in the order they must be merged.  */
+      Lisp_Object *refs;
+      ptrdiff_t nrefs = 0;
+      int face_id;
+
+      SAFE_NALLOCA (refs, 1, noverlays + 1);
+      if (!NILP (prop))
+	refs[nrefs++] = prop;
+      for (i = 0; i < noverlays; i++)
 	{
 	  Lisp_Object oend;
 	  ptrdiff_t oendpos;
 
 	  prop = Foverlay_get (overlay_vec[i], propname);
 	  if (!NILP (prop))
-	    {
-	      /* Overlays always take priority over text properties,
-		 so discard the mouse-face text property, if any, and
-		 use the overlay property instead.  */
-	      memcpy (attrs, default_face->lface, sizeof attrs);
-	      merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
-	    }
+	    refs[nrefs++] = prop;
 
 	  oend = OVERLAY_END (overlay_vec[i]);
 	  oendpos = OVERLAY_POSITION (oend);
 	  if (oendpos < endpos)
 	    endpos = oendpos;
 	}
+
+      *endptr = endpos;
+      face_id = merge_face_stack (w, f, default_face, refs, nrefs,
+				  attr_filter);
+      SAFE_FREE ();
+      return face_id;
     }
-  else
-    {
-      for (i = 0; i < noverlays; i++)
-	{
-	  Lisp_Object oend;
-	  ptrdiff_t oendpos;
 
-	  prop = Foverlay_get (overlay_vec[i], propname);
+  /* Begin with attributes from the default face.  */
+  memcpy (attrs, default_face->lface, sizeof(attrs));
 
-	  if (!NILP (prop))
-	    merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
+  /* Merge in attributes specified via text properties.  */
+  if (!NILP (prop))
+    merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
 
-	  oend = OVERLAY_END (overlay_vec[i]);
-	  oendpos = OVERLAY_POSITION (oend);
-	  if (oendpos < endpos)
-	    endpos = oendpos;
+  /* For mouse-face, we need only the single highest-priority face
+     from the overlays, if any.  */
+  for (prop = Qnil, i = noverlays - 1; i >= 0 && NILP (prop); --i)
+    {
+      Lisp_Object oend;
+      ptrdiff_t oendpos;
+
+      prop = Foverlay_get (overlay_vec[i], propname);
+      if (!NILP (prop))
+	{
+	  /* Overlays always take priority over text properties,
+	     so discard the mouse-face text property, if any, and
+	     use the overlay property instead.  */
+	  memcpy (attrs, default_face->lface, sizeof attrs);
+	  merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
 	}
+
+      oend = OVERLAY_END (overlay_vec[i]);
+      oendpos = OVERLAY_POSITION (oend);
+      if (oendpos < endpos)
+	endpos = oendpos;
     }
 
   *endptr = endpos;
@@ -7243,6 +7609,19 @@ syms_of_xfaces (void)
   /* The name of the function used to compute colors on TTYs.  */
   DEFSYM (Qtty_color_alist, "tty-color-alist");
 
+  /* Names of the elements of `face-cache-statistics'.  */
+  DEFSYM (Qfaces, "faces");
+  DEFSYM (Qlookups, "lookups");
+  DEFSYM (Qhits, "hits");
+  DEFSYM (Qrealized, "realized");
+  DEFSYM (Qrealized_non_ascii, "realized-non-ascii");
+  DEFSYM (Qfreed, "freed");
+  DEFSYM (Qflushes, "flushes");
+  DEFSYM (Qrefreshes, "refreshes");
+  DEFSYM (Qmerge_lookups, "merge-lookups");
+  DEFSYM (Qmerge_hits, "merge-hits");
+  DEFSYM (Qrealize_time, "realize-time");
+
   Vface_alternative_font_family_alist = Qnil;
   staticpro (&Vface_alternative_font_family_alist);
   Vface_alternative_font_registry_alist = Qnil;
@@ -7280,6 +7659,7 @@ syms_of_xfaces (void)
   defsubr (&Sshow_face_resources);
 #endif /* GLYPH_DEBUG */
   defsubr (&Sclear_face_cache);
+  defsubr (&Sface_cache_statistics);
   defsubr (&Stty_suppress_bold_inverse_default_colors);
 
 #if defined DEBUG_X_COLORS && defined HAVE_X_WINDOWS
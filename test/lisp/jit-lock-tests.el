@@ -59,4 +59,51 @@ jit-lock-fontify-now-does-not-refontify-unnecessarily
       (put-text-property (point-min) (point-max) 'fontified t))
     (jit-lock-fontify-now (point-min) (point-max))))
 
+(defmacro jit-lock-tests--with-lookahead-window (&rest body)
+  "Run BODY with a window showing a fontified region of a long buffer."
+  (declare (debug t) (indent 0))
+  `(ert-with-test-buffer (:name "xxx")
+     (jit-lock-tests--setup-buffer)
+     (dotimes (i 5000)
+       (insert (format "line %d\n" i)))
+     (save-window-excursion
+       (switch-to-buffer (current-buffer))
+       (set-window-start nil 20000)
+       (let ((redisplay-skip-initial-frame nil))
+         (redisplay t))
+       ,@body)))
+
+(ert-deftest jit-lock-stealth-lookahead-around-window ()
+  (let ((jit-lock-chunk-size 500)
+        (jit-lock-stealth-lookahead 2)
+        (jit-lock-stealth-lookahead-budget 10))
+    (jit-lock-tests--with-lookahead-window
+      (let ((start (window-start))
+            (end (window-end)))
+        (should (jit-lock--stealth-lookahead))
+        ;; The text just before and after the window is fontified...
+        (should-not (text-property-not-all (- start 1000) start 'fontified t))
+        (should-not (text-property-not-all end (+ end 1000) 'fontified t))
+        ;; ...but not the text far from it.
+        (should-not (get-text-property (point-min) 'fontified))
+        (should-not (get-text-property (1- (point-max)) 'fontified))
+        ;; Then the rest is left to the rest of stealth fontification.
+        (should-not (jit-lock--stealth-lookahead))))))
+
+(ert-deftest jit-lock-stealth-lookahead-nearest-first ()
+  (let ((jit-lock-chunk-size 500)
+        (jit-lock-stealth-lookahead 10)
+        (jit-lock-stealth-lookahead-budget 0))
+    (jit-lock-tests--with-lookahead-window
+      (let ((start (window-start))
+            (end (window-end)))
+        ;; Without time to spare, only the unfontified chunk nearest
+        ;; to the window is fontified each time.
+        (dotimes (_ 4)
+          (should (jit-lock--stealth-lookahead)))
+        (should-not (text-property-not-all (- start 500) start 'fontified t))
+        (should-not (text-property-not-all end (+ end 500) 'fontified t))
+        (should-not (get-text-property (- start 1500) 'fontified))
+        (should-not (get-text-property (+ end 1500) 'fontified))))))
+
 ;;; jit-lock-tests.el ends here
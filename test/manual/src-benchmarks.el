@@ -0,0 +1,497 @@
+;;; src-benchmarks.el --- benchmarks for C primitives  -*- lexical-binding: t -*-
+
+;; Copyright (C) 2022 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Timings of C primitives on large inputs, for comparing one build
+;; with another.  They take too long to be part of "make check".  Run
+;; them all with
+;;
+;;   make -C test src-benchmarks
+;;
+;; or only those whose names match a regexp with
+;;
+;;   make -C test src-benchmarks BENCHMARKS=textprop
+;;
+;; Each benchmark function takes optional size arguments and returns
+;; an alist of (LABEL . SECONDS).
+
+;;; Code:
+
+(eval-when-compile (require 'cl-lib))
+
+(defvar src-benchmarks nil
+  "List of the benchmarks defined with `src-benchmarks-define'.")
+
+(defmacro src-benchmarks-define (name arglist docstring &rest body)
+  "Define NAME as a benchmark function with ARGLIST, DOCSTRING and BODY.
+BODY should return an alist of (LABEL . SECONDS)."
+  (declare (doc-string 3) (indent 2))
+  `(progn
+     (defun ,name ,arglist ,docstring ,@body)
+     (add-to-list 'src-benchmarks ',name t)))
+
+(defmacro src-benchmarks-time (&rest body)
+  "Run BODY once and return the elapsed time in seconds."
+  (declare (indent 0))
+  `(car (benchmark-run nil ,@body)))
+
+(defun src-benchmarks-report (&optional regexp)
+  "Run the benchmarks whose names match REGEXP and print their timings.
+REGEXP defaults to the value of the environment variable BENCHMARKS,
+and if that is unset or empty, all benchmarks are run."
+  (setq regexp (or regexp (getenv "BENCHMARKS") ""))
+  (dolist (name src-benchmarks)
+    (when (string-match-p regexp (symbol-name name))
+      (garbage-collect)
+      (pcase-dolist (`(,label . ,seconds) (funcall name))
+        (message "%-60s %9.3fs" (format "%s %s" name label) seconds)))))
+
+;;; casefiddle.c
+
+(src-benchmarks-define src-benchmarks-casefiddle-mostly-ascii
+    (&optional size)
+  "Time upcasing and downcasing mostly ASCII text.
+Upcase and downcase a multibyte buffer of about SIZE characters, and
+then a string of its contents.  SIZE defaults to 10,000,000."
+  (setq size (or size 10000000))
+  (with-temp-buffer
+    (let ((line "  (defun foo (x) \"Doc é.\" (skip-chars-forward x))\n"))
+      (dotimes (_ (/ size (length line)))
+        (insert line)))
+    (let ((string (buffer-string)))
+      (list (cons 'upcase-region
+                  (src-benchmarks-time
+                    (upcase-region (point-min) (point-max))))
+            (cons 'downcase-region
+                  (src-benchmarks-time
+                    (downcase-region (point-min) (point-max))))
+            (cons 'upcase (src-benchmarks-time (upcase string)))
+            (cons 'downcase (src-benchmarks-time (downcase string)))))))
+
+;;; chartab.c
+
+(src-benchmarks-define src-benchmarks-chartab-non-ascii (&optional count)
+  "Time looking up non-ASCII characters in char-tables.
+Call `char-width', `char-syntax' in the syntax table of Emacs Lisp
+mode and `get-char-code-property' for Cyrillic and CJK characters
+COUNT times each.  COUNT defaults to 1000."
+  (setq count (or count 1000))
+  (let ((chars (vconcat (number-sequence #x400 #x4ff)
+                        (number-sequence #x4e00 #x4eff)))
+        (table (with-temp-buffer
+                 (emacs-lisp-mode)
+                 (syntax-table))))
+    (list (cons 'char-width
+                (src-benchmarks-time
+                  (dotimes (_ count)
+                    (mapc #'char-width chars))))
+          (cons 'char-syntax
+                (src-benchmarks-time
+                  (with-syntax-table table
+                    (dotimes (_ count)
+                      (mapc #'char-syntax chars)))))
+          (cons 'get-char-code-property
+                (src-benchmarks-time
+                  (dotimes (_ count)
+                    (mapc (lambda (c)
+                            (get-char-code-property c 'general-category))
+                          chars)))))))
+
+;;; indent.c
+
+(src-benchmarks-define src-benchmarks-indent-long-line (&optional size)
+  "Time `current-column' and `move-to-column' in a long line.
+Move through a line of about SIZE characters, asking for the column
+every 10,000 characters and then moving back to each of those
+columns.  Do that with and without column checkpoints.  SIZE defaults
+to 1,000,000."
+  (setq size (or size 1000000))
+  (with-temp-buffer
+    (let ((text "(function(a,b){return a\t+ b;})"))
+      (dotimes (_ (/ size (length text)))
+        (insert text)))
+    (cl-flet ((run ()
+                (src-benchmarks-time
+                  (let (cols)
+                    (goto-char (point-min))
+                    (while (< (point) (point-max))
+                      (push (current-column) cols)
+                      (forward-char (min 10000 (- (point-max) (point)))))
+                    (dolist (col cols)
+                      (move-to-column col))))))
+      (list (cons 'checkpoints (run))
+            (cons 'no-checkpoints (let ((cache-long-scans nil))
+                                    (run)))))))
+
+(src-benchmarks-define src-benchmarks-indent-vertical-motion
+    (&optional size)
+  "Time `vertical-motion' in a long line.
+Move 1000 screen lines down and then up again from the middle of a
+line of about SIZE characters, with and without motion checkpoints.
+Only batch mode uses them.  SIZE defaults to 1,000,000."
+  (setq size (or size 1000000))
+  (save-window-excursion
+    (with-temp-buffer
+      (set-window-buffer nil (current-buffer))
+      (let ((text "(function(a,b){return a\t+ b;}) "))
+        (dotimes (_ (/ size (length text)))
+          (insert text)))
+      (cl-flet ((run ()
+                  (src-benchmarks-time
+                    (goto-char (/ (point-max) 2))
+                    (dotimes (_ 1000)
+                      (vertical-motion 1))
+                    (dotimes (_ 1000)
+                      (vertical-motion -1)))))
+        (list (cons 'checkpoints (run))
+              (cons 'no-checkpoints (let ((cache-long-scans nil))
+                                      (run))))))))
+
+;;; insdel.c
+
+(src-benchmarks-define src-benchmarks-insdel-alternating-edits
+    (&optional size nedits)
+  "Time editing both ends of a large buffer in turn.
+Edit alternately at the beginning and at the end of a unibyte buffer
+of SIZE bytes, NEDITS times.  Insertions have to move the gap across
+the whole text, replacements by text of the same length don't.  SIZE
+defaults to 1,000,000,000 and NEDITS to 100."
+  (setq size (or size 1000000000)
+        nedits (or nedits 100))
+  (with-temp-buffer
+    (set-buffer-multibyte nil)
+    (let ((chunk (make-string (min size 1000000) ?a)))
+      (dotimes (_ (/ size (length chunk)))
+        (insert chunk)))
+    (list (cons 'insert
+                (src-benchmarks-time
+                  (dotimes (i nedits)
+                    (goto-char (if (= (% i 2) 0) (point-min) (point-max)))
+                    (insert "b"))))
+          (cons 'replace-match
+                (src-benchmarks-time
+                  (dotimes (i nedits)
+                    (goto-char (if (= (% i 2) 0) (point-min) (1- (point-max))))
+                    (looking-at ".")
+                    (replace-match "c")))))))
+
+;;; marker.c
+
+(src-benchmarks-define src-benchmarks-marker-edit (&optional nmarkers nedits)
+  "Time editing a buffer that carries NMARKERS markers.
+Insert and delete a character NEDITS times near the middle of a
+buffer with NMARKERS markers spread over it.  NMARKERS defaults to
+1,000,000 and NEDITS to 10,000."
+  (setq nmarkers (or nmarkers 1000000)
+        nedits (or nedits 10000))
+  (with-temp-buffer
+    (insert (make-string (/ nmarkers 10) ?a))
+    (let ((markers (make-vector nmarkers nil)))
+      (dotimes (i nmarkers)
+        (aset markers i (copy-marker (1+ (% i (buffer-size))))))
+      (goto-char (/ (point-max) 2))
+      (list (cons 'insert-and-delete
+                  (src-benchmarks-time
+                    (dotimes (_ nedits)
+                      (insert "é")
+                      (delete-char -1)
+                      (forward-char 1)
+                      (position-bytes (point)))))))))
+
+(src-benchmarks-define src-benchmarks-marker-goto-char (&optional size ngotos)
+  "Time moving to random places in a multibyte buffer.
+Convert NGOTOS random character positions to byte positions in a
+buffer of SIZE characters, most of them multibyte.  SIZE defaults
+to 500,000,000 and NGOTOS to 100,000."
+  (setq size (or size 500000000)
+        ngotos (or ngotos 100000))
+  (with-temp-buffer
+    (let ((chunk (make-string 1000000 ?é)))
+      (dotimes (i 1000000)
+        (when (= (% i 10) 0)
+          (aset chunk i ?a)))
+      (dotimes (_ (/ size (length chunk)))
+        (insert chunk)))
+    (list (cons 'position-bytes
+                (src-benchmarks-time
+                  (dotimes (_ ngotos)
+                    (goto-char (1+ (random (buffer-size))))
+                    (position-bytes (point))))))))
+
+;;; syntax.c
+
+(defun src-benchmarks--random-lisp (n)
+  "Return a random string of N Lisp-like snippets."
+  (let ((snippets ["(" ")" "(foo " "bar)" "\"str\\\"ing\" " "\"\n"
+                   "; comment\n" ";\n" "?\\( " "#| x |# " "'(a b) " "\n"
+                   "\\\\" "|" "[" "]"])
+        (pieces nil))
+    (dotimes (_ n)
+      (push (aref snippets (random (length snippets))) pieces))
+    (apply #'concat pieces)))
+
+(src-benchmarks-define src-benchmarks-syntax-skip (&optional size)
+  "Time skipping over the lines and words of a buffer.
+Move over a multibyte buffer of about SIZE characters line by line
+with `skip-chars-forward', then word by word with
+`skip-syntax-forward'.  SIZE defaults to 10,000,000."
+  (setq size (or size 10000000))
+  (with-temp-buffer
+    (let ((line "  (defun foo (x) \"Doc é.\" (skip-chars-forward x))\n"))
+      (dotimes (_ (/ size (length line)))
+        (insert line)))
+    (list (cons 'skip-chars-forward
+                (src-benchmarks-time
+                  (goto-char (point-min))
+                  (while (< (point) (point-max))
+                    (skip-chars-forward "^\n")
+                    (forward-char 1))))
+          (cons 'skip-syntax-forward
+                (src-benchmarks-time
+                  (goto-char (point-min))
+                  (while (< (point) (point-max))
+                    (skip-syntax-forward "^w")
+                    (skip-syntax-forward "w")))))))
+
+(src-benchmarks-define src-benchmarks-syntax-parse-state
+    (&optional size nqueries)
+  "Time asking for parse states while editing a large Lisp buffer.
+Type NQUERIES characters in the middle of a buffer of about SIZE
+characters, asking after each one for the state at a random position
+of the next few thousand characters, as fontification would.  Do that
+once with `parse-partial-sexp' and once with `syntax-parse-state'.
+SIZE defaults to 10,000,000 and NQUERIES to 100."
+  (setq size (or size 10000000)
+        nqueries (or nqueries 100))
+  (with-temp-buffer
+    (emacs-lisp-mode)
+    (let ((text (src-benchmarks--random-lisp 10000)))
+      (dotimes (_ (/ size (length text)))
+        (insert text)))
+    (goto-char (/ (point-max) 2))
+    (cl-flet ((run (fn)
+                (src-benchmarks-time
+                  (dotimes (_ nqueries)
+                    (insert " ")
+                    (funcall fn (+ (point) (random 3000)))))))
+      (list (cons 'parse-partial-sexp
+                  (run (lambda (pos)
+                         (save-excursion
+                           (parse-partial-sexp (point-min) pos)))))
+            (cons 'syntax-parse-state (run #'syntax-parse-state))))))
+
+;;; textprop.c
+
+(src-benchmarks-define src-benchmarks-textprop-sparse-search (&optional lines)
+  "Time a walk over every `button' change in a heavily fontified buffer.
+Every line has a `face' property, and every 97th line has a `button'
+property.  LINES defaults to enough lines for roughly 100 MB of text."
+  (with-temp-buffer
+    (dotimes (i (or lines (/ 100000000 9)))
+      (insert (propertize "abcdefgh" 'face (if (= (% i 2) 1) 'bold 'italic)))
+      (when (zerop (% i 97))
+        (put-text-property (- (point) 4) (point) 'button i))
+      (insert "\n"))
+    (list (cons 'next-single-property-change
+                (src-benchmarks-time
+                  (let ((pos 1))
+                    (while (setq pos (next-single-property-change
+                                      pos 'button)))))))))
+
+;;; xdisp.c
+
+(defvar src-benchmarks--tty-process nil
+  "Process whose pseudo-terminal shows the benchmark frame, if any.")
+
+(defun src-benchmarks--redisplay ()
+  "Redisplay, then drain what was written to the benchmark terminal."
+  (redisplay t)
+  (when src-benchmarks--tty-process
+    (while (accept-process-output src-benchmarks--tty-process 0))))
+
+(defun src-benchmarks--call-with-virtual-tty (function)
+  "Call FUNCTION with an 80x25 terminal frame selected.
+The frame writes to a pseudo-terminal read by Emacs itself.  If no
+pseudo-terminal is available, call FUNCTION with the selected frame
+instead; in batch mode that is the initial frame, for which redisplay
+lays out windows but writes nothing."
+  (let* ((redisplay-skip-initial-frame nil)
+         (old-frame (selected-frame))
+         (src-benchmarks--tty-process
+          (and (executable-find "sleep")
+               (ignore-errors
+                 (make-process :name "src-benchmarks-tty"
+                               :command '("sleep" "3600")
+                               :connection-type 'pty
+                               :filter #'ignore
+                               :noquery t))))
+         (frame (and src-benchmarks--tty-process
+                     (ignore-errors
+                       (make-terminal-frame
+                        `((tty . ,(process-tty-name
+                                   src-benchmarks--tty-process))
+                          (tty-type . "vt100")))))))
+    (unless frame
+      (setq src-benchmarks--tty-process nil))
+    (unwind-protect
+        (progn
+          (when frame
+            (set-frame-size frame 80 25)
+            (select-frame frame))
+          (save-window-excursion
+            (funcall function)))
+      (when frame
+        (select-frame old-frame)
+        (delete-frame frame t))
+      (when (processp src-benchmarks--tty-process)
+        (delete-process src-benchmarks--tty-process)))))
+
+(defun src-benchmarks--scroll-scenario (n)
+  "Scroll N screens forward, then back again."
+  (goto-char (point-min))
+  (dotimes (_ n)
+    (ignore-errors (scroll-up))
+    (src-benchmarks--redisplay))
+  (dotimes (_ n)
+    (ignore-errors (scroll-down))
+    (src-benchmarks--redisplay)))
+
+(defun src-benchmarks--motion-scenario (n)
+  "Move point over 4*N lines and along the last of them."
+  (goto-char (point-min))
+  (dotimes (_ (* 4 n))
+    (forward-line 1)
+    (src-benchmarks--redisplay))
+  (dotimes (_ n)
+    (unless (eolp)
+      (forward-char 1))
+    (src-benchmarks--redisplay)))
+
+(defun src-benchmarks--edit-scenario (n)
+  "Type N characters and N lines in the middle of the buffer."
+  (goto-char (/ (point-max) 2))
+  (recenter)
+  (src-benchmarks--redisplay)
+  (dotimes (_ n)
+    (insert "x")
+    (src-benchmarks--redisplay))
+  (dotimes (_ n)
+    (insert "\n")
+    (src-benchmarks--redisplay))
+  (dotimes (_ n)
+    (delete-char -1)
+    (src-benchmarks--redisplay)))
+
+(defun src-benchmarks--resize-scenario (n)
+  "Split, resize and delete windows N times."
+  (goto-char (/ (point-max) 3))
+  (dotimes (_ n)
+    (split-window-below)
+    (src-benchmarks--redisplay)
+    (ignore-errors (enlarge-window 3))
+    (src-benchmarks--redisplay)
+    (split-window-right)
+    (src-benchmarks--redisplay)
+    (delete-other-windows)
+    (src-benchmarks--redisplay)))
+
+(defun src-benchmarks--wide-scroll-scenario (n)
+  "Scroll N lines forward one at a time through wide, repeated rows.
+Then scroll back again.  The rows are the first lines of the current
+buffer, widened to three times the window width and repeated, so that
+no row of the window is unique."
+  (let* ((width (* 3 (window-width)))
+         (nlines (+ n (window-height)))
+         (lines (save-excursion
+                  (goto-char (point-min))
+                  (cl-loop repeat 4
+                           collect (let ((piece (concat (buffer-substring
+                                                         (point)
+                                                         (line-end-position))
+                                                        " ")))
+                                     (truncate-string-to-width
+                                      (apply #'concat
+                                             (make-list
+                                              (1+ (/ width (length piece)))
+                                              piece))
+                                      width))
+                           do (forward-line 1)))))
+    (with-temp-buffer
+      (dotimes (i nlines)
+        (insert (nth (% i 4) lines) "\n"))
+      (setq truncate-lines t
+            show-trailing-whitespace t)
+      (switch-to-buffer (current-buffer))
+      (goto-char (point-min))
+      (src-benchmarks--redisplay)
+      (dotimes (_ n)
+        (ignore-errors (scroll-up 1))
+        (src-benchmarks--redisplay))
+      (dotimes (_ n)
+        (ignore-errors (scroll-down 1))
+        (src-benchmarks--redisplay)))))
+
+(src-benchmarks-define src-benchmarks-xdisp-redisplay (&optional n files)
+  "Time redisplay of FILES under scripted scenarios.
+Scroll, move point, type, split windows and scroll through wide rows
+with argument N, 20 by default, in a buffer visiting a copy of each
+file, on a terminal frame shown on a pseudo-terminal.  FILES are
+relative to `source-directory' and default to a C file, a Lisp file
+and etc/HELLO.  Besides the total time of each scenario, report the
+time that `redisplay-statistics' counted in redisplay and in updating
+the frame."
+  (setq n (or n 20))
+  (let (results)
+    (src-benchmarks--call-with-virtual-tty
+     (lambda ()
+       (dolist (file (or files
+                         '("src/xdisp.c" "lisp/simple.el" "etc/HELLO")))
+         (with-temp-buffer
+           (insert-file-contents (expand-file-name file source-directory))
+           (let ((buffer-file-name file))
+             (set-auto-mode))
+           (delete-other-windows)
+           (switch-to-buffer (current-buffer))
+           (pcase-dolist (`(,label . ,scenario)
+                          '((scroll . src-benchmarks--scroll-scenario)
+                            (motion . src-benchmarks--motion-scenario)
+                            (edit . src-benchmarks--edit-scenario)
+                            (resize . src-benchmarks--resize-scenario)
+                            (wide-scroll
+                             . src-benchmarks--wide-scroll-scenario)))
+             (delete-other-windows)
+             (src-benchmarks--redisplay)
+             (redisplay-statistics t)
+             (let* ((name (format "%s %s" (file-name-nondirectory file)
+                                  label))
+                    (time (src-benchmarks-time (funcall scenario n)))
+                    (stats (redisplay-statistics t)))
+               (push (cons name time) results)
+               (push (cons (concat name " redisplay")
+                           (alist-get 'redisplay-time stats))
+                     results)
+               (push (cons (concat name " update")
+                           (alist-get 'update-time stats))
+                     results)))))))
+    (nreverse results)))
+
+(provide 'src-benchmarks)
+
+;;; src-benchmarks.el ends here
@@ -1748,4 +1748,47 @@ test-buffer-chars-modified-ticks
       (if f2 (delete-file f2))
       )))
 
+(ert-deftest buffer-tests-gap-allowance ()
+  "The gap of a large buffer grows with the buffer."
+  (with-temp-buffer
+    (insert (make-string 1000000 ?a))
+    (goto-char (point-min))
+    (while (> (gap-size) 0)
+      (insert "b"))
+    (insert "c")
+    (should (>= (gap-size) (/ (buffer-size) 100)))
+    (goto-char (point-max))
+    (insert "d")
+    (should (= (gap-position) (point-max)))
+    (should (eq (char-before) ?d))
+    (goto-char (point-min))
+    (should (looking-at "b+ca"))))
+
+(ert-deftest buffer-tests-replace-in-place ()
+  "A replacement as long as the text it replaces doesn't move the gap."
+  (with-temp-buffer
+    (buffer-enable-undo)
+    (insert "abc éü xyz")
+    (undo-boundary)
+    (let ((gap (gap-position))
+          (m1 (copy-marker 2))
+          (m2 (copy-marker 5)))
+      (goto-char (point-min))
+      (should (looking-at "abc"))
+      (replace-match (propertize "ABC" 'face 'bold))
+      (should (equal (buffer-string) "ABC éü xyz"))
+      (should (eq (get-text-property 2 'face) 'bold))
+      (should (= (gap-position) gap))
+      (should (= m1 1))
+      (goto-char 5)
+      (should (looking-at "éü"))
+      (replace-match "üé")
+      (should (equal (buffer-string) "ABC üé xyz"))
+      (should (= (gap-position) gap))
+      (should (= m2 5))
+      (should (= (position-bytes 8) 10))
+      (primitive-undo 1 buffer-undo-list)
+      (should (equal (buffer-substring-no-properties (point-min) (point-max))
+                     "abc éü xyz")))))
+
 ;;; buffer-tests.el ends here
@@ -294,4 +294,42 @@ casefiddle-turkish
     ;;(should (string-equal (capitalize "indIá") "İndıa"))
     ))
 
+;; The tests below cover the ASCII fast path of upcasing and downcasing.
+
+(ert-deftest casefiddle-tests-ascii-context ()
+  "Casing ASCII text sets up the context for the next character."
+  (dolist (str '("AΣ B" "AΣ" "A.Σ B" "aΣb ΣΣ. XΣ"))
+    (let ((expected (mapconcat (lambda (c) (string (downcase c)))
+                               str "")))
+      ;; Final sigma at the end of words.
+      (setq expected (replace-regexp-in-string
+                      "\\(\\w\\)σ\\(\\W\\|\\'\\)" "\\1ς\\2" expected))
+      (should (equal (downcase str) expected))
+      (with-temp-buffer
+        (insert str)
+        (downcase-region (point-min) (point-max))
+        (should (equal (buffer-string) expected))))))
+
+(ert-deftest casefiddle-tests-ascii-case-table ()
+  "Casing ASCII text honors case tables that map it to non-ASCII."
+  (let ((table (copy-case-table (standard-case-table))))
+    (set-case-syntax-pair ?İ ?i table)
+    (set-case-syntax-pair ?I ?ı table)
+    (with-temp-buffer
+      (set-case-table table)
+      (insert "title: this")
+      (upcase-region (point-min) (point-max))
+      (should (equal (buffer-string) "TİTLE: THİS"))
+      (erase-buffer)
+      (insert "TITLE: THIS")
+      (downcase-region (point-min) (point-max))
+      (should (equal (buffer-string) "tıtle: thıs"))))
+  (with-temp-buffer
+    (set-buffer-multibyte nil)
+    (insert "Mixed CASE\377")
+    (upcase-region (point-min) (point-max))
+    (should (equal (buffer-string) "MIXED CASE\377"))
+    (downcase-region (point-min) (point-max))
+    (should (equal (buffer-string) "mixed case\377"))))
+
 ;;; casefiddle-tests.el ends here
@@ -69,5 +69,55 @@ chartab-test-char-table-extra-slot
     (set-char-table-extra-slot tbl 1 'bar)
     (should (eq (char-table-extra-slot tbl 1) 'bar))))
 
+;; char_table_ref caches the values of non-ASCII characters, so check
+;; that changing a char-table or its parent is seen by later lookups.
+(ert-deftest chartab-test-lookup-cache ()
+  (let ((parent (make-char-table 'foo))
+        (child (make-char-table 'foo)))
+    (set-char-table-parent child parent)
+    (set-char-table-range parent '(#x400 . #x4ff) 'cyrillic)
+    (should (eq (aref child #x410) 'cyrillic))
+    (should (eq (aref child #x411) 'cyrillic))
+    (aset parent #x410 'a)
+    (should (eq (aref child #x410) 'a))
+    (aset child #x411 'b)
+    (should (eq (aref child #x411) 'b))
+    (should (eq (aref parent #x411) 'cyrillic))
+    (set-char-table-range child '(#x400 . #x4ff) nil)
+    (should (eq (aref child #x411) 'cyrillic))
+    (set-char-table-parent child nil)
+    (should-not (aref child #x411))
+    (set-char-table-range child nil 'default)
+    (should (eq (aref child #x411) 'default))
+    (garbage-collect)
+    (should (eq (aref child #x411) 'default))
+    (should (eq (aref parent #x410) 'a))))
+
+;; Each char-table has its own modification count, so check that
+;; lookups follow changes when there are many char-tables, some of
+;; them garbage, and when the changes are made to a grandparent.
+(ert-deftest chartab-test-lookup-cache-many-tables ()
+  (let* ((grandparent (make-char-table 'foo))
+         (parent (make-char-table 'foo))
+         (tables (mapcar (lambda (_)
+                           (let ((table (make-char-table 'foo)))
+                             (set-char-table-parent table parent)
+                             table))
+                         (number-sequence 1 300))))
+    (set-char-table-parent parent grandparent)
+    (dotimes (_ 300)
+      (aref (make-char-table 'foo) #x410))
+    (dolist (table tables)
+      (should-not (aref table #x410)))
+    (garbage-collect)
+    (aset grandparent #x410 'a)
+    (dolist (table tables)
+      (should (eq (aref table #x410) 'a)))
+    (set-char-table-extra-slot (make-char-table 'case-table) 1 'b)
+    (aset (nth 7 tables) #x410 'b)
+    (set-char-table-parent parent nil)
+    (dolist (table tables)
+      (should (eq (aref table #x410) (and (eq table (nth 7 tables)) 'b))))))
+
 (provide 'chartab-tests)
 ;;; chartab-tests.el ends here
@@ -0,0 +1,62 @@
+;;; composite-tests.el --- tests for composite.c      -*- lexical-binding: t -*-
+
+;; Copyright (C) 2022 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Code:
+
+(require 'ert)
+
+(ert-deftest composite-find-automatic-composition ()
+  (with-temp-buffer
+    (set-window-buffer nil (current-buffer))
+    (insert "ae\u0301b ae\u0301b")
+    (let ((first (find-composition 2 nil nil t)))
+      (should (equal (list (nth 0 first) (nth 1 first)) '(2 4)))
+      ;; The same characters elsewhere are composed the same way.
+      (should (equal (nthcdr 2 (find-composition 7 nil nil t))
+                     (nthcdr 2 first))))))
+
+(ert-deftest composite-cache-failed-shaping ()
+  "Check that text which cannot be composed is only shaped once."
+  (let ((calls 0))
+    (unwind-protect
+        (cl-letf (((symbol-function 'compose-gstring-for-terminal)
+                   (lambda (_gstring _direction)
+                     (setq calls (1+ calls))
+                     nil)))
+          (with-temp-buffer
+            (set-window-buffer nil (current-buffer))
+            (insert "ae\u0301b ae\u0301b")
+            (clear-composition-cache)
+            (composition-cache-statistics t)
+            (should-not (find-composition 2 nil nil t))
+            (should-not (find-composition 7 nil nil t))
+            (should (> calls 0))
+            (let ((shaped calls))
+              (should-not (find-composition 2 nil nil t))
+              (should-not (find-composition 7 nil nil t))
+              (should (= calls shaped))
+              (let ((stats (composition-cache-statistics)))
+                (should (= (alist-get 'shaped stats) shaped))
+                (should (> (alist-get 'hits stats) 0))))))
+      ;; Forget the failures recorded above.
+      (clear-composition-cache))))
+
+(provide 'composite-tests)
+
+;;; composite-tests.el ends here
@@ -938,6 +938,34 @@ test-string-distance
   (should (equal 1 (string-distance "" "x")))
   (should (equal 1 (string-distance "" "x" t))))
 
+(ert-deftest test-string-flex-match ()
+  "Test `string-flex-match' behavior."
+  (let ((candidates ["find-file" "fofo" "buffer-file-name" "xyz" "diff"]))
+    (should (equal (string-flex-match "ff" candidates)
+                   '(("find-file" 50 (0 5))
+                     ("fofo" 45 (0 2))
+                     ("buffer-file-name" 36 (2 3))
+                     ("diff" 36 (2 3)))))
+    ;; Only the best matches, in the same order.
+    (should (equal (mapcar #'car (string-flex-match "ff" candidates 2))
+                   '("find-file" "fofo")))
+    (should-not (string-flex-match "ff" candidates 0))
+    (should-not (string-flex-match "fx" candidates)))
+  ;; Lists work too, and an empty pattern matches everything.
+  (should (equal (string-flex-match "" '("b" "a")) '(("b" 0 nil) ("a" 0 nil))))
+  ;; Letter-case.
+  (should-not (string-flex-match "FF" ["find-file"]))
+  (should (equal (string-flex-match "FF" ["find-file" "FindFile"] nil t)
+                 '(("find-file" 50 (0 5)) ("FindFile" 50 (0 4)))))
+  ;; Matches are scored at the shortest occurrence of the pattern.
+  (should (equal (caddr (car (string-flex-match "ab" ["a-a-ab"]))) '(4 5)))
+  ;; Non-ASCII characters.
+  (should (equal (string-flex-match "我b" ["a我xb" "ab"])
+                 '(("a我xb" 29 (1 3)))))
+  (should (equal (mapcar #'car (string-flex-match "éa" ["Éxa" "ea"] nil t))
+                 '("Éxa")))
+  (should-error (string-flex-match "a" '("a" b))))
+
 (ert-deftest test-bignum-eql ()
   "Test that `eql' works for bignums."
   (let ((x (+ most-positive-fixnum 1))
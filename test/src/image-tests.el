@@ -62,4 +62,65 @@ image-tests-init-image-library
   (should (init-image-library 'pbm)) ; built-in
   (should-not (init-image-library 'invalid-image-type)))
 
+;; The bytes of the images in the caches are counted when images are
+;; loaded and freed.  Images still shown are never freed to keep the
+;; caches within `image-cache-size-limit'.
+(ert-deftest image-tests-image-cache-bytes ()
+  (skip-unless (display-images-p))
+  (declare-function image-cache-statistics "image.c" (&optional reset))
+  (defvar image-cache-size-limit)
+  (clear-image-cache t)
+  (redisplay t)
+  (let ((bytes (image-cache-size))
+        (image (create-image (concat "P1\n16 16\n" (make-string 256 ?1))
+                             'pbm t)))
+    (should (= bytes (alist-get 'bytes (image-cache-statistics))))
+    (with-temp-buffer
+      (insert-image image)
+      (save-window-excursion
+        (switch-to-buffer (current-buffer))
+        (redisplay t)
+        (should (> (image-cache-size) bytes))
+        (should (= (image-cache-size)
+                   (alist-get 'bytes (image-cache-statistics))))
+        (image-cache-statistics t)
+        (let ((image-cache-size-limit 0))
+          (redisplay t)
+          (should (> (image-cache-size) bytes))
+          (should (= (alist-get 'evictions (image-cache-statistics)) 0))
+          (erase-buffer)
+          (redisplay t)
+          (redisplay t)
+          (let ((stats (image-cache-statistics)))
+            (should (> (alist-get 'evictions stats) 0))
+            (should (> (alist-get 'evicted-bytes stats) 0))
+            (should (<= (alist-get 'bytes stats) bytes))
+            (should (= (alist-get 'bytes stats) (image-cache-size)))))))))
+
+;; Once a redisplay has spent `image-load-time-limit' loading images,
+;; it shows the images it would load after that as empty rectangles,
+;; and later redisplays load them.
+(ert-deftest image-tests-image-load-time-limit ()
+  (skip-unless (display-images-p))
+  (declare-function image-display-deferred "image.c" ())
+  (defvar image-load-time-limit)
+  (clear-image-cache t)
+  (redisplay t)
+  (image-display-deferred)
+  (let ((image (create-image (concat "P1\n16 16\n" (make-string 256 ?1))
+                             'pbm t)))
+    (with-temp-buffer
+      (insert-image image)
+      (save-window-excursion
+        (switch-to-buffer (current-buffer))
+        (let ((bytes (image-cache-size)))
+          (let ((image-load-time-limit 0))
+            (redisplay t)
+            (should (= (image-cache-size) bytes))
+            (should (image-display-deferred))
+            (should-not (image-display-deferred)))
+          (redisplay t)
+          (should (> (image-cache-size) bytes))
+          (should-not (image-display-deferred)))))))
+
 ;;; image-tests.el ends here
@@ -58,4 +58,125 @@ indent-tests-move-to-column-invis-between-tabs
       (buffer-substring-no-properties 1 14))
     "\txxx    \tLine")))
 
+;; Columns in long lines, which use checkpoints unless
+;; `cache-long-scans' is nil.
+
+(defun indent-tests--check-column (pos)
+  "Check the columns at and before POS with and without checkpoints."
+  (goto-char pos)
+  (let ((col (current-column)))
+    ;; Forget the last column `current-column' computed.
+    (goto-char (point-min))
+    (current-column)
+    (goto-char pos)
+    (should (= col (let ((cache-long-scans nil))
+                     (current-column))))
+    (let* ((goal (random (1+ col)))
+           (to (progn (move-to-column goal) (point))))
+      (goto-char pos)
+      (should (= to (let ((cache-long-scans nil))
+                      (move-to-column goal)
+                      (point)))))))
+
+(ert-deftest indent-tests-column-cache ()
+  "Columns in long lines stay right as the text and properties change."
+  (with-temp-buffer
+    (random "indent-tests")
+    (let ((chars ["a" "b" " " "\t" "é" "中"]))
+      (dotimes (_ 3)
+        (dotimes (_ 20000)
+          (insert (aref chars (random (length chars)))))
+        (insert "\n")))
+    (dotimes (_ 100)
+      (let* ((beg (+ (point-min) (random (- (point-max) (point-min)))))
+             (end (min (point-max) (+ beg 1 (random 10)))))
+        (pcase (random 6)
+          (0 (goto-char beg) (insert "x\t"))
+          (1 (delete-region beg end))
+          (2 (put-text-property beg end 'invisible t))
+          (3 (put-text-property beg end 'display "display"))
+          (4 (remove-text-properties beg end '(invisible nil display nil)))
+          (5 (overlay-put (make-overlay beg end) 'invisible t))))
+      (dotimes (_ 5)
+        (indent-tests--check-column
+         (+ (point-min) (random (- (point-max) (point-min)))))))))
+
+(ert-deftest indent-tests-vertical-motion-long-lines ()
+  "`vertical-motion' in long lines stays right as the text changes."
+  (save-window-excursion
+    (with-temp-buffer
+      (set-window-buffer nil (current-buffer))
+      (random "indent-tests")
+      (let ((chars ["a" "b" " " "\t" "é" "中" "\e"]))
+        (dotimes (_ 3)
+          (dotimes (_ 20000)
+            (insert (aref chars (random (length chars)))))
+          (insert "\n")))
+      (dotimes (_ 50)
+        (let* ((beg (+ (point-min) (random (- (point-max) (point-min)))))
+               (end (min (point-max) (+ beg 1 (random 10)))))
+          (pcase (random 4)
+            (0 (goto-char beg) (insert "x\t中"))
+            (1 (delete-region beg end))
+            (2 (put-text-property beg end 'invisible t))
+            (3 (overlay-put (make-overlay beg end) 'before-string "ov"))))
+        (dotimes (_ 5)
+          (let ((pos (+ (point-min) (random (- (point-max) (point-min)))))
+                (lines (- (random 61) 30)))
+            (goto-char pos)
+            (let ((moved (vertical-motion lines))
+                  (to (point)))
+              (goto-char pos)
+              (let ((cache-long-scans nil))
+                (should (equal (cons (vertical-motion lines) (point))
+                               (cons moved to)))))))))))
+
+(ert-deftest indent-tests-column-cache-invisibility-spec ()
+  "Columns follow in-place changes to `buffer-invisibility-spec'."
+  (with-temp-buffer
+    (insert (make-string 23000 ?a))
+    (put-text-property 1 3001 'invisible 'foo)
+    (add-to-invisibility-spec 'foo)
+    (add-to-invisibility-spec 'bar)
+    (should (= (current-column) 20000))
+    ;; This deletes `foo' from the list in place.
+    (remove-from-invisibility-spec 'foo)
+    ;; Move so as not to get the last column `current-column' computed.
+    (backward-char)
+    (should (= (current-column) 22999))))
+
+;; Char-tables are modified in place rather than replaced by changed
+;; copies, so checkpoints are no good after any such change.
+
+(ert-deftest indent-tests-column-cache-char-tables ()
+  "Columns and screen lines follow in-place changes to char-tables."
+  (save-window-excursion
+    (with-temp-buffer
+      (set-window-buffer nil (current-buffer))
+      (let ((char-width-table (copy-sequence char-width-table))
+            (table (make-display-table))
+            (window-table (make-display-table)))
+        (setq buffer-display-table table)
+        (set-window-display-table nil window-table)
+        (dotimes (_ 20000)
+          (insert "ab é "))
+        (dolist (change (list (lambda ()
+                                (set-char-table-range char-width-table
+                                                      ?é 2))
+                              (lambda () (aset table ?b [?x ?y ?z]))
+                              (lambda () (aset window-table ?a [?x ?y]))))
+          (indent-tests--check-column (1- (point-max)))
+          (goto-char (point-max))
+          (vertical-motion -1000)
+          (funcall change)
+          (set-window-display-table nil window-table)
+          (indent-tests--check-column (1- (point-max)))
+          (goto-char (point-max))
+          (let ((moved (vertical-motion -1000))
+                (to (point)))
+            (goto-char (point-max))
+            (let ((cache-long-scans nil))
+              (should (equal (cons (vertical-motion -1000) (point))
+                             (cons moved to))))))))))
+
 ;;; indent-tests.el ends here
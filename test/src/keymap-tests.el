@@ -442,6 +442,16 @@ keymap-test-duplicate-definitions
        "a" #'next-line
        "a" #'previous-line)))
 
+(ert-deftest keymap-test-lookup-statistics ()
+  (keymap-lookup-statistics t)
+  (let ((map (make-sparse-keymap)))
+    (define-key map [?a ?b] #'ignore)
+    (should (eq (lookup-key map [?a ?b]) #'ignore))
+    (let ((stats (keymap-lookup-statistics t)))
+      (should (>= (alist-get 'accesses stats) 2))
+      (should (floatp (alist-get 'key-time stats))))
+    (should (= (alist-get 'accesses (keymap-lookup-statistics)) 0))))
+
 (provide 'keymap-tests)
 
 ;;; keymap-tests.el ends here
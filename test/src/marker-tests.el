@@ -57,4 +57,179 @@ marker-goto-char-from-other-buffer
     (set-marker marker-2 marker-1)
     (should (goto-char marker-2))))
 
+;; The following tests exercise the sorted marker index with more
+;; markers than fit in a single chunk of it.
+
+(defun marker-tests--check (markers)
+  "Check that each of MARKERS, an alist of (MARKER . POSITION), agrees."
+  (dolist (entry markers)
+    (should (= (marker-position (car entry)) (cdr entry)))
+    (should (= (position-bytes (car entry))
+               (1+ (string-bytes (buffer-substring (point-min)
+                                                   (car entry))))))))
+
+(ert-deftest marker-index-edits ()
+  "Markers follow random insertions and deletions."
+  (with-temp-buffer
+    (random "marker-tests")
+    (insert (make-string 2000 ?a))
+    (let ((markers nil))
+      (dotimes (i 1000)
+        (let ((m (copy-marker (1+ (random (point-max))) (= (% i 3) 0))))
+          (push (cons m (marker-position m)) markers)))
+      (dotimes (_ 300)
+        (let ((pos (1+ (random (point-max)))))
+          (if (or (zerop (random 2)) (= pos (point-max)))
+              (let ((n (1+ (random 20))))
+                (goto-char pos)
+                (insert (make-string n ?ä))
+                (dolist (entry markers)
+                  (when (or (> (cdr entry) pos)
+                            (and (= (cdr entry) pos)
+                                 (marker-insertion-type (car entry))))
+                    (setcdr entry (+ (cdr entry) n)))))
+            (let ((end (min (point-max) (+ pos (random 30)))))
+              (delete-region pos end)
+              (dolist (entry markers)
+                (cond ((> (cdr entry) end)
+                       (setcdr entry (- (cdr entry) (- end pos))))
+                      ((> (cdr entry) pos)
+                       (setcdr entry pos)))))))
+        ;; Move a marker out of order now and then.
+        (let ((entry (nth (random (length markers)) markers)))
+          (set-marker (car entry) (1+ (random (point-max))))
+          (setcdr entry (marker-position (car entry)))))
+      (marker-tests--check markers))))
+
+(ert-deftest marker-index-insert-before-markers ()
+  "Markers at the insertion point keep their relative order."
+  (with-temp-buffer
+    (insert (make-string 100 ?x))
+    (let ((markers nil))
+      (dotimes (i 500)
+        (push (cons (copy-marker 50 (= (% i 2) 0)) nil) markers))
+      (goto-char 50)
+      (insert "éé")
+      (dolist (entry markers)
+        (setcdr entry (if (marker-insertion-type (car entry)) 52 50)))
+      (marker-tests--check markers)
+      (goto-char 51)
+      (insert-before-markers "ö")
+      (dolist (entry markers)
+        (when (= (cdr entry) 52)
+          (setcdr entry 53)))
+      (marker-tests--check markers)
+      (goto-char 50)
+      (insert-before-markers "ü")
+      (dolist (entry markers)
+        (setcdr entry (1+ (cdr entry))))
+      (marker-tests--check markers))))
+
+(ert-deftest marker-index-gc ()
+  "Unreferenced markers are dropped from the index by GC."
+  (with-temp-buffer
+    (insert (make-string 1000 ?ß))
+    (let ((markers nil))
+      (dotimes (i 2000)
+        (let ((m (copy-marker (1+ (% (* i 7) 1000)))))
+          (when (= (% i 4) 0)
+            (push (cons m (marker-position m)) markers))))
+      (garbage-collect)
+      (goto-char 500)
+      (insert "abc")
+      (dolist (entry markers)
+        (when (> (cdr entry) 500)
+          (setcdr entry (+ (cdr entry) 3))))
+      (marker-tests--check markers))))
+
+(ert-deftest marker-index-replace-at-markers ()
+  "Replacing an empty match advances the markers at its start."
+  (with-temp-buffer
+    (insert (make-string 1000 ?x))
+    (let ((markers nil))
+      ;; Put the markers at 101 in a chunk that starts before them and
+      ;; in the next one.
+      (dolist (spec '((1 . 62) (101 . 4) (500 . 100)))
+        (dotimes (_ (cdr spec))
+          (let ((m (copy-marker (car spec))))
+            (push (cons m (marker-position m)) markers))))
+      (goto-char 101)
+      (should (looking-at ""))
+      (replace-match "XYZ")
+      (dolist (entry markers)
+        (when (>= (cdr entry) 101)
+          (setcdr entry (+ (cdr entry) 3))))
+      (marker-tests--check markers)
+      ;; Markers at the start of a nonempty match stay there.
+      (goto-char 104)
+      (should (looking-at "x"))
+      (replace-match "é")
+      (marker-tests--check markers))))
+
+;; The following tests exercise the index of character and byte
+;; positions kept for large multibyte buffers.
+
+(defun marker-tests--random-text (n)
+  "Return a random string of N characters of varying byte lengths."
+  (let ((chars [?a ?b ?\n ?é ?ß ?ж ?€ ?中 ?😀 #x3fff80])
+        (v (make-vector n nil)))
+    (dotimes (i n)
+      (aset v i (aref chars (random (length chars)))))
+    (concat v)))
+
+(defun marker-tests--check-positions (text count)
+  "Check COUNT random positions of the current buffer against TEXT.
+TEXT is a string with the same contents as the buffer."
+  (dotimes (_ count)
+    (let* ((pos (1+ (random (1+ (length text)))))
+           (byte (1+ (string-bytes (substring text 0 (1- pos))))))
+      (should (= (position-bytes pos) byte))
+      (should (= (byte-to-position byte) pos)))))
+
+(ert-deftest marker-position-index-edits ()
+  "Conversions between positions stay right across edits."
+  (with-temp-buffer
+    (random "marker-tests")
+    (let ((text (marker-tests--random-text 60000)))
+      (insert text)
+      (marker-tests--check-positions text 50)
+      (should (buffer-position-index-statistics))
+      (dotimes (_ 100)
+        (let ((pos (1+ (random (length text)))))
+          (pcase (random 3)
+            (0 (let ((new (marker-tests--random-text (random 5000))))
+                 (goto-char pos)
+                 (insert new)
+                 (setq text (concat (substring text 0 (1- pos)) new
+                                    (substring text (1- pos))))))
+            (1 (let ((end (min (1+ (length text)) (+ pos (random 5000)))))
+                 (delete-region pos end)
+                 (setq text (concat (substring text 0 (1- pos))
+                                    (substring text (1- end))))))
+            ;; Case changes replace text without moving markers,
+            ;; and "ß" grows into "SS".
+            (2 (let ((end (min (1+ (length text)) (+ pos (random 5000)))))
+                 (upcase-region pos end)
+                 (setq text (concat (substring text 0 (1- pos))
+                                    (upcase (substring text (1- pos) (1- end)))
+                                    (substring text (1- end)))))))
+          (marker-tests--check-positions text 10)))
+      (let ((mid (/ (length text) 2)))
+        (transpose-regions 1 mid mid (1+ (length text)))
+        (setq text (concat (substring text (1- mid))
+                           (substring text 0 (1- mid)))))
+      (marker-tests--check-positions text 50))))
+
+(ert-deftest marker-position-index-multibyte ()
+  "Changing the multibyteness of a buffer drops its position index."
+  (with-temp-buffer
+    (let ((text (marker-tests--random-text 30000)))
+      (insert text)
+      (marker-tests--check-positions text 10)
+      (should (buffer-position-index-statistics))
+      (set-buffer-multibyte nil)
+      (should-not (buffer-position-index-statistics))
+      (set-buffer-multibyte t)
+      (marker-tests--check-positions text 10))))
+
 ;;; marker-tests.el ends here
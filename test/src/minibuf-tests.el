@@ -47,6 +47,8 @@ minibuf-tests--strings-to-symbol-hashtable
         (num 0))
     (mapc (lambda (str) (puthash (intern str) (cl-incf num) ht)) list)
     ht))
+(defun minibuf-tests--strings-to-completion-index (list)
+  (make-completion-index list))
 
 ;;; Functions that produce a predicate (for *-completion functions)
 ;;; which always returns non-nil for a given collection.
@@ -57,6 +59,8 @@ minibuf-tests--part-of-obarray
   (lambda (sym) (eq (intern-soft (symbol-name sym) ob) sym)))
 (defun minibuf-tests--part-of-hashtable (table)
   (lambda (k v) (equal (gethash k table) v)))
+(defun minibuf-tests--part-of-completion-index (index)
+  (lambda (string) (test-completion string index)))
 
 
 ;;; Testing functions that are agnostic to type of COLLECTION.
@@ -246,6 +250,17 @@ try-completion-symbol-hashtable-completion-regexp
    #'minibuf-tests--strings-to-symbol-hashtable))
 
 
+(ert-deftest try-completion-completion-index ()
+  (minibuf-tests--try-completion
+   #'minibuf-tests--strings-to-completion-index))
+(ert-deftest try-completion-completion-index-predicate ()
+  (minibuf-tests--try-completion-pred
+   #'minibuf-tests--strings-to-completion-index
+   #'minibuf-tests--part-of-completion-index))
+(ert-deftest try-completion-completion-index-completion-regexp ()
+  (minibuf-tests--try-completion-regexp
+   #'minibuf-tests--strings-to-completion-index))
+
 ;;; Tests for `all-completions'.
 
 (ert-deftest all-completions-string-list ()
@@ -323,6 +338,19 @@ all-completions-symbol-hashtable-completion-regexp
    #'minibuf-tests--strings-to-symbol-hashtable))
 
 
+(ert-deftest all-completions-completion-index ()
+  ;; The strings in a completion index are returned in sorted order.
+  (let ((index (make-completion-index '("abc" "abba" "def"))))
+    (should (equal (all-completions "a" index) '("abba" "abc")))
+    (should (equal (all-completions "abc" index) '("abc")))
+    (should (equal (all-completions "abcd" index) nil))
+    (should (equal (all-completions "a" index (lambda (s) (equal s "abc")))
+                   '("abc")))
+    (let ((completion-regexp-list '("b.")))
+      (should (equal (all-completions "a" index) '("abba" "abc"))))
+    (let ((completion-regexp-list '("X")))
+      (should-not (all-completions "a" index)))))
+
 ;;; Tests for `test-completion'.
 
 (ert-deftest test-completion-string-list ()
@@ -399,6 +427,78 @@ test-completion-symbol-hashtable-completion-regexp
   (minibuf-tests--test-completion-regexp
    #'minibuf-tests--strings-to-symbol-hashtable))
 
+(ert-deftest test-completion-completion-index ()
+  (minibuf-tests--test-completion
+   #'minibuf-tests--strings-to-completion-index))
+(ert-deftest test-completion-completion-index-predicate ()
+  (minibuf-tests--test-completion-pred
+   #'minibuf-tests--strings-to-completion-index
+   #'minibuf-tests--part-of-completion-index))
+(ert-deftest test-completion-completion-index-completion-regexp ()
+  (minibuf-tests--test-completion-regexp
+   #'minibuf-tests--strings-to-completion-index))
+
+(ert-deftest completion-index-update ()
+  (let ((index (make-completion-index '("foo" "foobar"))))
+    (should (completion-index-p index))
+    (should-not (completion-index-add index "foo"))
+    (should (completion-index-add index "foobaz"))
+    (should (equal (try-completion "foo" index) "foo"))
+    (should (equal (try-completion "foob" index) "fooba"))
+    (should (completion-index-remove index "foo"))
+    (should-not (completion-index-remove index "foo"))
+    (should-not (test-completion "foo" index))
+    (should (equal (try-completion "f" index) "fooba"))
+    (should (completion-index-remove index "foobar"))
+    (should (equal (try-completion "f" index) "foobaz"))
+    (should (equal (try-completion "foobaz" index) t))
+    (should (equal (all-completions "" index) '("foobaz")))))
+
+(ert-deftest completion-index-returns-copies ()
+  "Check that changing the strings returned leaves the index intact."
+  (let ((index (make-completion-index '("foobar" "foobaz"))))
+    (dolist (string (all-completions "foo" index))
+      (aset string 0 ?x))
+    (test-completion "foobar" index
+                     (lambda (string) (aset string 0 ?x)))
+    (should (equal (all-completions "foo" index) '("foobar" "foobaz")))
+    (should (equal (try-completion "foo" index) "fooba"))
+    (should (test-completion "foobar" index))
+    (should-not (all-completions "x" index))))
+
+(ert-deftest completion-index-same-as-list ()
+  "Check that a completion index completes like a list of strings."
+  (let* ((chars "ab\u00e9\u4e2d")
+         (strings
+          (delete-dups
+           (cl-loop repeat 300
+                    collect (apply #'string
+                                   (cl-loop repeat (random 6)
+                                            collect (aref chars
+                                                          (random 4)))))))
+         (index (make-completion-index nil))
+         (list nil))
+    (dolist (string strings)
+      (completion-index-add index string)
+      (push string list)
+      ;; Remove some of the strings again.
+      (when (zerop (random 3))
+        (let ((old (nth (random (length list)) list)))
+          (should (completion-index-remove index old))
+          (setq list (delete old list)))))
+    (dolist (prefix (cons "" strings))
+      (should (equal (try-completion prefix index)
+                     (try-completion prefix list)))
+      (should (equal (all-completions prefix index)
+                     (sort (all-completions prefix list) #'string<)))
+      (should (eq (test-completion prefix index)
+                  (test-completion prefix list)))
+      (let ((completion-ignore-case t))
+        (should (equal (sort (all-completions (upcase prefix) index)
+                             #'string<)
+                       (sort (all-completions (upcase prefix) list)
+                             #'string<)))))))
+
 (ert-deftest test-try-completion-ignore-case ()
   (let ((completion-ignore-case t))
     (should (equal (try-completion "bar" '("bAr" "barfoo")) "bAr"))
@@ -521,4 +521,198 @@ syntax-char-syntax
         (should (equal (funcall cs 128) ?_))))
     (list (char-syntax 128) (funcall cs 128))))
 
+(defun syntax-tests--skip-model (match forward lim)
+  "Return where skipping characters that satisfy MATCH would stop.
+Skip forward if FORWARD, else backward, but not past LIM."
+  (save-excursion
+    (if forward
+        (while (and (< (point) lim) (funcall match (char-after)))
+          (forward-char 1))
+      (while (and (> (point) lim) (funcall match (char-before)))
+        (forward-char -1)))
+    (point)))
+
+(ert-deftest syntax-skip-chars-random ()
+  "`skip-chars-forward' and `skip-chars-backward' agree with a model."
+  (dolist (multibyte '(t nil))
+    (with-temp-buffer
+      (random "syntax-tests")
+      (set-buffer-multibyte multibyte)
+      (let ((chars (if multibyte "ab Z\n\t.é中" "ab Z\n\t.\351")))
+        (dotimes (_ 2000)
+          (insert (aref chars (random (length chars))))))
+      (dolist (set (if multibyte
+                       '("^\n" "a-z" "^a-z" " \t" "^ \t\n" "[:alpha:]"
+                         "^[:space:]" "é" "^中" "a-zé-ü")
+                     '("^\n" "a-z" "^a-z" " \t" "^ \t\n" "^[:space:]"
+                       "\351" "^\351")))
+        (let ((re (concat "\\`[" set "]\\'")))
+          (dotimes (_ 100)
+            (let ((pos (1+ (random (point-max))))
+                  (lim (1+ (random (point-max))))
+                  (match (lambda (c) (let ((case-fold-search nil))
+                                   (string-match-p
+                                    re (if multibyte (string c)
+                                         (unibyte-string c)))))))
+              (goto-char pos)
+              (skip-chars-forward set lim)
+              (should (= (point)
+                         (if (< pos lim)
+                             (progn (goto-char pos)
+                                    (syntax-tests--skip-model match t lim))
+                           pos)))
+              (goto-char pos)
+              (skip-chars-backward set lim)
+              (should (= (point)
+                         (if (> pos lim)
+                             (progn (goto-char pos)
+                                    (syntax-tests--skip-model match nil lim))
+                           pos))))))))))
+
+(ert-deftest syntax-skip-syntax-random ()
+  "`skip-syntax-forward' and `skip-syntax-backward' agree with a model."
+  (with-temp-buffer
+    (random "syntax-tests")
+    (let ((chars "ab Z\n\t.()é中_"))
+      (dotimes (_ 2000)
+        (insert (aref chars (random (length chars))))))
+    (dolist (syntaxes '("w" "^w" " " "w_" "^ " "()"))
+      (let* ((negate (eq (aref syntaxes 0) ?^))
+             (codes (if negate (substring syntaxes 1) syntaxes))
+             (match (lambda (c)
+                      (let ((in (seq-contains-p codes (char-syntax c))))
+                        (if negate (not in) in))))
+             (lim (point-max)))
+        (dotimes (_ 100)
+          (let ((pos (1+ (random (point-max)))))
+            (goto-char pos)
+            (skip-syntax-forward syntaxes)
+            (should (= (point)
+                       (progn (goto-char pos)
+                              (syntax-tests--skip-model match t lim))))
+            (goto-char pos)
+            (skip-syntax-backward syntaxes)
+            (should (= (point)
+                       (progn (goto-char pos)
+                              (syntax-tests--skip-model match nil 1))))))))))
+
+(ert-deftest syntax-skip-syntax-properties ()
+  "`skip-syntax-forward' and `skip-syntax-backward' obey `syntax-table'."
+  (with-temp-buffer
+    (random "syntax-tests")
+    (let ((chars "ab .-é")
+          (table (make-syntax-table))
+          (parse-sexp-lookup-properties t))
+      (modify-syntax-entry ?. "w" table)
+      (dotimes (_ 2000)
+        (insert (aref chars (random (length chars)))))
+      (dotimes (_ 100)
+        (let ((beg (1+ (random (point-max)))))
+          (put-text-property beg (min (point-max) (+ beg (random 20)))
+                             'syntax-table
+                             (if (zerop (random 2)) table
+                               (string-to-syntax "w")))))
+      (let ((word (lambda (pos)
+                    (eq (syntax-class (syntax-after pos)) 2))))
+        (dotimes (_ 100)
+          (let ((pos (1+ (random (point-max)))))
+            (goto-char pos)
+            (skip-syntax-forward "w")
+            (should (= (point)
+                       (let ((p pos))
+                         (while (and (< p (point-max)) (funcall word p))
+                           (setq p (1+ p)))
+                         p)))
+            (goto-char pos)
+            (skip-syntax-backward "w")
+            (should (= (point)
+                       (let ((p pos))
+                         (while (and (> p (point-min))
+                                     (funcall word (1- p)))
+                           (setq p (1- p)))
+                         p)))))))))
+
+(defun syntax-tests--random-lisp (n)
+  "Return a random string of N Lisp-like snippets."
+  (let ((snippets ["(" ")" "(foo " "bar)" "\"str\\\"ing\" " "\"\n"
+                   "; comment\n" ";\n" "?\\( " "#| x |# " "'(a b) " "\n"
+                   "\\\\" "|" "[" "]"]))
+    (apply #'concat
+           (cl-loop repeat n
+                    collect (aref snippets (random (length snippets)))))))
+
+(defun syntax-tests--check-parse-state (count)
+  "Compare `syntax-parse-state' with `parse-partial-sexp' at COUNT places."
+  (dotimes (_ count)
+    (let* ((pos (+ (point-min) (random (1+ (- (point-max) (point-min))))))
+           (expected (save-excursion (parse-partial-sexp (point-min) pos)))
+           (state (syntax-parse-state pos)))
+      ;; Elements 2 and 6 depend on where parsing started.
+      (setf (nth 2 expected) nil (nth 6 expected) nil
+            (nth 2 state) nil (nth 6 state) nil)
+      (should (equal state expected)))))
+
+(ert-deftest syntax-parse-state-edits ()
+  "The parse states kept for a buffer follow changes to its text."
+  (with-temp-buffer
+    (random "syntax-tests")
+    (emacs-lisp-mode)
+    (insert (syntax-tests--random-lisp 5000))
+    (syntax-tests--check-parse-state 50)
+    (dotimes (_ 50)
+      (let ((pos (+ (point-min) (random (buffer-size)))))
+        (if (zerop (random 2))
+            (save-excursion
+              (goto-char pos)
+              (insert (syntax-tests--random-lisp (random 5))))
+          (delete-region pos (min (point-max) (+ pos (random 30))))))
+      (syntax-tests--check-parse-state 5))
+    (save-restriction
+      (narrow-to-region (/ (point-max) 3) (point-max))
+      (syntax-tests--check-parse-state 20))
+    (syntax-tests--check-parse-state 20)))
+
+(ert-deftest syntax-parse-state-syntax-changes ()
+  "The parse states kept for a buffer follow changes to its syntax."
+  (with-temp-buffer
+    (let ((table (make-syntax-table)))
+      (set-syntax-table table)
+      (insert (make-string 10000 ?x) "'a'" (make-string 10000 ?x))
+      (should-not (nth 3 (syntax-parse-state 10003)))
+      (should-not (nth 3 (syntax-parse-state 20000)))
+      (modify-syntax-entry ?' "\"" table)
+      (should (eq (nth 3 (syntax-parse-state 10003)) ?'))
+      (should-not (nth 3 (syntax-parse-state 20000)))
+      (setq-local parse-sexp-lookup-properties t)
+      (put-text-property 10003 10004 'syntax-table '(1))
+      (should (eq (nth 3 (syntax-parse-state 20000)) ?'))
+      (remove-list-of-text-properties 10003 10004 '(syntax-table))
+      (should-not (nth 3 (syntax-parse-state 20000))))))
+
+(ert-deftest syntax-parse-state-other-changes ()
+  "The parse states follow syntax changes made by other means."
+  (with-temp-buffer
+    (let ((table (make-syntax-table))
+          (parent (make-syntax-table)))
+      (set-syntax-table table)
+      (insert (make-string 10000 ?x) "'a'" (make-string 10000 ?x))
+      (should-not (nth 3 (syntax-parse-state 20000)))
+      (aset table ?' (string-to-syntax "\""))
+      (should (eq (nth 3 (syntax-parse-state 10003)) ?'))
+      (should-not (nth 3 (syntax-parse-state 20000)))
+      (set-char-table-range table '(?' . ?') nil)
+      (set-char-table-parent table parent)
+      (should-not (nth 3 (syntax-parse-state 10003)))
+      (set-char-table-range parent '(?' . ?') (string-to-syntax "\""))
+      (should (eq (nth 3 (syntax-parse-state 10003)) ?'))
+      ;; Properties that are aliases of `syntax-table'.
+      (setq-local parse-sexp-lookup-properties t)
+      (put-text-property 10003 10004 'syntax-tests--syntax '(1))
+      (should-not (nth 3 (syntax-parse-state 20000)))
+      (setq-local char-property-alias-alist
+                  '((syntax-table syntax-tests--syntax)))
+      (should (eq (nth 3 (syntax-parse-state 20000)) ?'))
+      (remove-list-of-text-properties 10003 10004 '(syntax-tests--syntax))
+      (should-not (nth 3 (syntax-parse-state 20000))))))
+
 ;;; syntax-tests.el ends here
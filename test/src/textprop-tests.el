@@ -68,5 +68,65 @@ textprop-tests-font-lock--remove-face-from-text-property
     (should (and (equal-including-properties (pop stack) string)
 		 (null stack)))))
 
+;; Searches for sparse properties skip subtrees of the interval tree
+;; that don't mention them; these compare against a plain scan.
+
+(defun textprop-tests--scan-next (pos prop)
+  (let ((val (get-text-property pos prop)))
+    (while (and (< pos (point-max)) (eq val (get-text-property pos prop)))
+      (setq pos (1+ pos)))
+    (and (< pos (point-max)) pos)))
+
+(defun textprop-tests--fill-sparse (n)
+  "Insert N lines with a face each and `button' on every 97th line."
+  (dotimes (i n)
+    (insert (propertize "abcdefgh" 'face (if (= (% i 2) 1) 'bold 'italic)))
+    (when (zerop (% i 97))
+      (put-text-property (- (point) 4) (point) 'button i))
+    (insert "\n")))
+
+(ert-deftest textprop-tests-next-single-property-change-sparse ()
+  (with-temp-buffer
+    (textprop-tests--fill-sparse 1000)
+    (dolist (pos '(1 2 50 777 4000 8990))
+      (should (equal (next-single-property-change pos 'button)
+                     (textprop-tests--scan-next pos 'button)))
+      (let ((prev (previous-single-property-change (1+ pos) 'button)))
+        (should (or (null prev) (<= prev (1+ pos))))
+        (when prev
+          (should-not (eq (get-text-property (1- prev) 'button)
+                          (get-text-property prev 'button))))))
+    (should (= (text-property-not-all 1 (point-max) 'button nil) 5))
+    (should (= (text-property-any 1 (point-max) 'button 97) (+ (* 97 9) 5)))
+    (should-not (text-property-any 1 (point-max) 'button 98))
+    ;; Properties removed from the buffer must not be found again.
+    (remove-text-properties 1 (point-max) '(button nil))
+    (should-not (next-single-property-change 1 'button))
+    (should-not (text-property-not-all 1 (point-max) 'button nil))))
+
+(ert-deftest textprop-tests-next-single-property-change-indirect ()
+  "Properties found through categories, aliases and defaults."
+  (put 'textprop-tests--cat 'textprop-tests--prop 'from-category)
+  (with-temp-buffer
+    (textprop-tests--fill-sparse 300)
+    (put-text-property 1000 1001 'category 'textprop-tests--cat)
+    (should (= (next-single-property-change 1 'textprop-tests--prop) 1000))
+    (put-text-property 1500 1501 'textprop-tests--alias 'x)
+    (let ((char-property-alias-alist
+           '((textprop-tests--prop textprop-tests--alias))))
+      (should (= (next-single-property-change 1001 'textprop-tests--prop)
+                 1500))
+      (should (= (previous-single-property-change (point-max)
+                                                  'textprop-tests--prop)
+                 1501)))
+    (let ((default-text-properties '(textprop-tests--prop dflt)))
+      (put-text-property 2000 2001 'textprop-tests--prop nil)
+      (should (= (next-single-property-change 1001 'textprop-tests--prop)
+                 2000))
+      (should (= (text-property-not-all 1001 (point-max)
+                                        'textprop-tests--prop 'dflt)
+                 2000))))
+  (put 'textprop-tests--cat 'textprop-tests--prop nil))
+
 (provide 'textprop-tests)
 ;;; textprop-tests.el ends here
@@ -467,5 +467,28 @@ undo-test-skip-invalidated-markers
     (undo-boundary)
     (undo)))
 
+(ert-deftest undo-test-truncate-across-gc ()
+  "Check truncation of a command's undo records after several GCs."
+  (with-temp-buffer
+    (buffer-enable-undo)
+    (let ((undo-limit 1000)
+          (undo-strong-limit 2000)
+          (undo-outer-limit nil))
+      (insert "a")
+      (undo-boundary)
+      (dotimes (i 200)
+        (insert (format "%03d " i))
+        (delete-region (- (point) 4) (- (point) 3))
+        (when (zerop (% i 50))
+          (garbage-collect)))
+      (garbage-collect)
+      ;; The current command is too big to keep the previous one, but
+      ;; nothing it recorded is lost.
+      (should (= (length buffer-undo-list) 400))
+      (should-not (memq nil buffer-undo-list))
+      (let ((pending-undo-list buffer-undo-list))
+        (undo-more 1))
+      (should (equal (buffer-string) "a")))))
+
 (provide 'undo-tests)
 ;;; undo-tests.el ends here
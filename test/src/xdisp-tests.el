@@ -20,6 +20,7 @@
 ;;; Code:
 
 (require 'ert)
+(require 'cl-lib)
 
 (defmacro xdisp-tests--in-minibuffer (&rest body)
   (declare (debug t) (indent 0))
@@ -154,6 +155,73 @@ xdisp-tests--find-directional-overrides-case-3
                                                      nil)
                 138))))
 
+(defun xdisp-tests--visual-successors ()
+  "Return where `move-point-visually' goes from each position of the buffer."
+  (let (result)
+    (dotimes (i (- (point-max) (point-min)))
+      (goto-char (+ (point-min) i))
+      (push (condition-case nil
+                (progn (move-point-visually 1) (point))
+              (error nil))
+            result))
+    (nreverse result)))
+
+(ert-deftest xdisp-tests--bidi-ascii-fast-path ()
+  "Test that skipping resolution of ASCII letters doesn't change reordering."
+  (xdisp-tests--call-with-virtual-tty
+   (lambda ()
+     (with-temp-buffer
+       (switch-to-buffer (current-buffer))
+       (let ((chars "abcdefghijklmnopqrstuvwxyz   (()[]0123,.-+\"\nאבגדהוזח\u202b\u202c\u2067\u2069")
+             (state (cl-make-random-state 17)))
+         (dotimes (_ 600)
+           (insert (aref chars (cl-random (length chars) state)))))
+       (dolist (dir '(nil left-to-right right-to-left))
+         (setq bidi-paragraph-direction dir)
+         (let ((fast (let ((bidi--inhibit-ascii-fast-path nil))
+                       (xdisp-tests--visual-successors)))
+               (slow (let ((bidi--inhibit-ascii-fast-path t))
+                       (xdisp-tests--visual-successors))))
+           (should (equal fast slow))))))))
+
+(ert-deftest xdisp-tests--bidi-paragraph-direction-cache ()
+  (with-temp-buffer
+    (insert "  123 abc\n  456 def\n\n  789 ghi\n")
+    (should (eq (current-bidi-paragraph-direction) 'left-to-right))
+    ;; Changing the first strong character of the paragraph changes
+    ;; its direction.
+    (goto-char 7)
+    (insert "א")
+    (goto-char 4)
+    (should (eq (current-bidi-paragraph-direction) 'right-to-left))
+    (delete-region 7 8)
+    (should (eq (current-bidi-paragraph-direction) 'left-to-right))
+    ;; So does hiding it with a display string, which counts as a
+    ;; neutral character.
+    (goto-char 10)
+    (insert " ב")
+    (put-text-property 7 10 'display "xyz")
+    (should (eq (current-bidi-paragraph-direction) 'right-to-left))
+    (remove-text-properties 7 10 '(display nil))
+    (should (eq (current-bidi-paragraph-direction) 'left-to-right))
+    (delete-region 10 12)
+    ;; The next paragraph has its own direction.
+    (goto-char (point-max))
+    (insert "  ב\n")
+    (forward-line -1)
+    (should (eq (current-bidi-paragraph-direction) 'left-to-right))
+    (goto-char (point-min))
+    (should (eq (current-bidi-paragraph-direction) 'left-to-right))
+    ;; Narrowing can hide the first strong character.
+    (goto-char (point-max))
+    (insert "\n  000 אב\n")
+    (forward-line -1)
+    (should (eq (current-bidi-paragraph-direction) 'right-to-left))
+    (save-restriction
+      (narrow-to-region (point-min) (+ (point) 5))
+      (should (eq (current-bidi-paragraph-direction) 'left-to-right)))
+    (should (eq (current-bidi-paragraph-direction) 'right-to-left))))
+
 (ert-deftest test-get-display-property ()
   (with-temp-buffer
     (insert (propertize "foo" 'face 'bold 'display '(height 2.0)))
@@ -179,4 +247,236 @@ test-messages-buffer-name
         (buffer-string)))
     "foo\n")))
 
+;;; Redisplay statistics.
+
+(defvar xdisp-tests--tty-process nil
+  "Process whose pseudo-terminal shows the test frame, if any.")
+
+(defun xdisp-tests--redisplay ()
+  "Redisplay, then drain what was written to the test terminal."
+  (redisplay t)
+  (when xdisp-tests--tty-process
+    (while (accept-process-output xdisp-tests--tty-process 0))))
+
+(defun xdisp-tests--call-with-virtual-tty (function)
+  "Call FUNCTION with an 80x25 terminal frame selected.
+The frame writes to a pseudo-terminal read by Emacs itself.  If no
+pseudo-terminal is available, call FUNCTION with the selected frame
+instead; in batch mode that is the initial frame, for which redisplay
+lays out windows but writes nothing."
+  (let* ((redisplay-skip-initial-frame nil)
+         (old-frame (selected-frame))
+         (xdisp-tests--tty-process
+          (and (executable-find "sleep")
+               (ignore-errors
+                 (make-process :name "xdisp-tests-tty"
+                               :command '("sleep" "3600")
+                               :connection-type 'pty
+                               :filter #'ignore
+                               :noquery t))))
+         (frame (and xdisp-tests--tty-process
+                     (ignore-errors
+                       (make-terminal-frame
+                        `((tty . ,(process-tty-name
+                                   xdisp-tests--tty-process))
+                          (tty-type . "vt100")))))))
+    (unless frame
+      (setq xdisp-tests--tty-process nil))
+    (unwind-protect
+        (progn
+          (when frame
+            (set-frame-size frame 80 25)
+            (select-frame frame))
+          (save-window-excursion
+            (funcall function)))
+      (when frame
+        (select-frame old-frame)
+        (delete-frame frame t))
+      (when (processp xdisp-tests--tty-process)
+        (delete-process xdisp-tests--tty-process)))))
+
+(defun xdisp-tests--widen-line (line width)
+  "Return LINE repeated to WIDTH columns."
+  (let ((piece (concat line " ")))
+    (truncate-string-to-width
+     (apply #'concat (make-list (1+ (/ width (length piece))) piece))
+     width)))
+
+(defun xdisp-tests--wide-scroll-scenario (n)
+  "Scroll N lines forward one at a time through wide, repeated rows.
+Then scroll back again.  The rows are the first lines of the current
+buffer, widened to three times the window width and repeated, so that
+no row of the window is unique.  Showing trailing whitespace keeps
+the display engine from reusing rows itself, so that `update_window'
+has to find the moved rows on window-system frames."
+  (let* ((width (* 3 (window-width)))
+         (nlines (+ n (window-height)))
+         (lines (save-excursion
+                  (goto-char (point-min))
+                  (cl-loop repeat 4
+                           collect (xdisp-tests--widen-line
+                                    (buffer-substring (point)
+                                                      (line-end-position))
+                                    width)
+                           do (forward-line 1)))))
+    (with-temp-buffer
+      (dotimes (i nlines)
+        (insert (nth (% i 4) lines) "\n"))
+      (setq truncate-lines t
+            show-trailing-whitespace t)
+      (switch-to-buffer (current-buffer))
+      (goto-char (point-min))
+      (xdisp-tests--redisplay)
+      (dotimes (_ n)
+        (ignore-errors (scroll-up 1))
+        (xdisp-tests--redisplay))
+      (dotimes (_ n)
+        (ignore-errors (scroll-down 1))
+        (xdisp-tests--redisplay)))))
+
+;; Moving point or typing on a terminal frame should be handled by
+;; the cheapest redisplay optimizations, and show in the counters.
+(ert-deftest xdisp-tests--redisplay-statistics ()
+  (xdisp-tests--call-with-virtual-tty
+   (lambda ()
+     (with-temp-buffer
+       (dotimes (i 100)
+         (insert (format "line %d\n" i)))
+       ;; With a dynamic paragraph direction, every change redisplays
+       ;; the whole window.
+       (setq bidi-paragraph-direction 'left-to-right)
+       (goto-char (point-min))
+       (forward-line 5)
+       (switch-to-buffer (current-buffer))
+       (redisplay-statistics t)
+       (xdisp-tests--redisplay)
+       (let ((stats (redisplay-statistics t)))
+         (should (> (alist-get 'redisplays stats) 0))
+         (should (> (alist-get 'windows stats) 0))
+         (should (> (alist-get 'rows-displayed stats) 0))
+         (should (>= (alist-get 'redisplay-time stats)
+                     (alist-get 'update-time stats))))
+       (should (cl-every (lambda (elt) (zerop (cdr elt)))
+                         (redisplay-statistics)))
+       (skip-unless xdisp-tests--tty-process)
+       (forward-char 2)
+       (xdisp-tests--redisplay)
+       (let ((stats (redisplay-statistics t)))
+         (should (= (alist-get 'optimization-3 stats) 1))
+         (should (= (alist-get 'rows-displayed stats) 0)))
+       ;; The first change after moving point goes through
+       ;; try_window_id; further typing on the same line redraws just
+       ;; that line.
+       (insert "x")
+       (xdisp-tests--redisplay)
+       (let ((stats (redisplay-statistics t)))
+         (should (= (alist-get 'try-window-id-hits stats) 1)))
+       (insert "y")
+       (xdisp-tests--redisplay)
+       (let ((stats (redisplay-statistics t)))
+         (should (= (alist-get 'optimization-1 stats) 1))
+         (should (= (alist-get 'rows-displayed stats) 1))
+         (should (> (alist-get 'rows-updated stats) 0)))
+       (forward-line 50)
+       (xdisp-tests--redisplay)
+       (let ((stats (redisplay-statistics t)))
+         (should (= (alist-get 'recenter stats) 1)))))))
+
+(defun xdisp-tests--layout-at (positions)
+  "Return how the selected window shows each of POSITIONS in turn.
+For each position, recenter on it and return the window start, the
+screen position of point, and where moving by screen lines gets to."
+  (let ((noninteractive nil))
+    (mapcar (lambda (pos)
+              (goto-char pos)
+              (recenter)
+              (xdisp-tests--redisplay)
+              (list (window-start)
+                    (posn-col-row (posn-at-point))
+                    (save-excursion (vertical-motion -3) (point))
+                    (save-excursion (vertical-motion '(7 . -2)) (point))
+                    (save-excursion
+                      (goto-char (window-start))
+                      (vertical-motion 30)
+                      (point))))
+            positions)))
+
+(ert-deftest xdisp-tests--display-checkpoints ()
+  "Test that laying out a long line from display checkpoints is exact."
+  (xdisp-tests--call-with-virtual-tty
+   (lambda ()
+     (skip-unless xdisp-tests--tty-process)
+     (with-temp-buffer
+       (switch-to-buffer (current-buffer))
+       (setq-local long-line-threshold nil)
+       (let ((pieces ["hello " "world" "\t" "שלום " "中文字" "(a,b) "
+                      "123 " "\1" "é" "a-long-word-without-spaces" "."])
+             (state (cl-make-random-state 17))
+             positions)
+         ;; Only left-to-right paragraphs have checkpoints.
+         (insert "hello ")
+         (dotimes (_ 2500)
+           (insert (aref pieces (cl-random (length pieces) state))))
+         (dotimes (_ 8)
+           (push (1+ (cl-random (buffer-size) state)) positions))
+         (dolist (settings '(nil
+                             ((word-wrap . t))
+                             ((bidi-display-reordering . nil))))
+           (pcase-dolist (`(,var . ,val) settings)
+             (set (make-local-variable var) val))
+           (let ((expected (let ((cache-long-scans nil))
+                             (xdisp-tests--layout-at positions))))
+             ;; The first pass records checkpoints, the second starts
+             ;; from them.
+             (should (equal (xdisp-tests--layout-at positions) expected))
+             (should (equal (xdisp-tests--layout-at positions) expected)))
+           ;; Changing the line discards the checkpoints after the
+           ;; change.
+           (goto-char (/ (point-max) 2))
+           (insert "ab\tcd ")
+           (let ((expected (let ((cache-long-scans nil))
+                             (xdisp-tests--layout-at positions))))
+             (should (equal (xdisp-tests--layout-at positions) expected)))
+           (kill-all-local-variables)
+           (setq-local long-line-threshold nil)))))))
+
+(defun xdisp-tests--call-with-graphic-frame (function)
+  "Call FUNCTION with a window-system frame selected.
+In batch mode, try to open a frame on the X display named by the
+DISPLAY environment variable, and skip the test if that fails."
+  (let* ((redisplay-skip-initial-frame nil)
+         (old-frame (selected-frame))
+         (frame (and (not (display-graphic-p))
+                     (featurep 'x)
+                     (getenv "DISPLAY")
+                     (ignore-errors
+                       (make-frame-on-display (getenv "DISPLAY")
+                                              '((width . 80)
+                                                (height . 25)))))))
+    (unless (or frame (display-graphic-p))
+      (ert-skip "No window-system frame"))
+    (unwind-protect
+        (progn
+          (when frame
+            (select-frame frame))
+          (save-window-excursion
+            (funcall function)))
+      (when frame
+        (select-frame old-frame)
+        (delete-frame frame t)))))
+
+;; When every row of a window appears more than once, there are no
+;; rows to anchor the search for moved rows, and scrolling should
+;; still move them on the display rather than redraw them.
+(ert-deftest xdisp-tests--scroll-repeated-rows ()
+  (xdisp-tests--call-with-graphic-frame
+   (lambda ()
+     (with-temp-buffer
+       (insert "alpha\nbeta\ngamma\ndelta\n")
+       (redisplay-statistics t)
+       (xdisp-tests--wide-scroll-scenario 10)
+       (let ((stats (redisplay-statistics t)))
+         (should (> (alist-get 'rows-moved stats)
+                    (alist-get 'rows-updated stats))))))))
+
 ;;; xdisp-tests.el ends here
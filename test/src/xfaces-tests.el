@@ -52,6 +52,107 @@ xfaces-internal-color-values-from-color-spec
   (should (equal (color-values-from-color-spec "rgbi:0/0x0/0") nil))
   (should (equal (color-values-from-color-spec "rgbi:0/+0x1/0") nil)))
 
+;; Changing a named face on a frame should keep the realized faces
+;; that are still in use, and realize only what the change affects.
+(ert-deftest xfaces-face-cache-refresh ()
+  (let ((redisplay-skip-initial-frame nil)
+        (frame (selected-frame)))
+    (make-face 'xfaces-tests--face)
+    (with-temp-buffer
+      (save-window-excursion
+        (switch-to-buffer (current-buffer))
+        (dotimes (i 20)
+          (insert (propertize "plain " 'face 'bold)
+                  (propertize (format "%d\n" i) 'face 'xfaces-tests--face)))
+        (goto-char (point-min))
+        (redisplay t)
+        (face-cache-statistics t)
+        (set-face-attribute 'xfaces-tests--face frame :foreground "#123456")
+        (redisplay t)
+        (let ((stats (face-cache-statistics t)))
+          (should (> (alist-get 'refreshes stats) 0))
+          (should (= (alist-get 'flushes stats) 0))
+          (should (> (alist-get 'hits stats) 0))
+          (should (> (alist-get 'realized stats) 0)))
+        (should (equal (face-attribute 'xfaces-tests--face :foreground frame)
+                       "#123456"))
+        ;; Nothing changed: all lookups hit.
+        (redisplay t)
+        (let ((stats (face-cache-statistics t)))
+          (should (= (alist-get 'realized stats) 0)))
+        ;; Other faces may share the font of the default face, so
+        ;; changing it flushes the cache.
+        (let ((old (face-attribute 'default :inverse-video frame)))
+          (unwind-protect
+              (progn
+                (set-face-attribute 'default frame :inverse-video t)
+                (redisplay t)
+                (should (> (alist-get 'flushes (face-cache-statistics t))
+                           0)))
+            (set-face-attribute 'default frame :inverse-video old)
+            (redisplay t)))))))
+
+;; The faces merged from former definitions of a changed face are never
+;; found again, and must not pile up in the cache.
+(ert-deftest xfaces-face-cache-refresh-frees-stale-faces ()
+  (let ((redisplay-skip-initial-frame nil)
+        (frame (selected-frame)))
+    (make-face 'xfaces-tests--face)
+    (with-temp-buffer
+      (save-window-excursion
+        (switch-to-buffer (current-buffer))
+        (dotimes (i 20)
+          (insert (propertize "plain " 'face 'bold)
+                  (propertize (format "%d\n" i) 'face 'xfaces-tests--face)))
+        (goto-char (point-min))
+        (redisplay t)
+        (let ((faces (alist-get 'faces (face-cache-statistics t))))
+          (dotimes (i 200)
+            (set-face-attribute 'xfaces-tests--face frame
+                                :foreground (format "#%06x" i))
+            (redisplay t))
+          (let ((stats (face-cache-statistics t)))
+            (should (= (alist-get 'flushes stats) 0))
+            (should (>= (alist-get 'freed stats) 190))
+            (should (< (alist-get 'faces stats) (+ faces 5)))))))))
+
+;; Faces merged from the same stack of text properties and overlays
+;; should be looked up in the memo of merged faces, but changes to
+;; the faces involved must not return stale faces.
+(ert-deftest xfaces-face-merge-memo ()
+  (let ((redisplay-skip-initial-frame nil)
+        (frame (selected-frame))
+        (spec (list :foreground "#111111")))
+    (make-face 'xfaces-tests--face)
+    (with-temp-buffer
+      (save-window-excursion
+        (switch-to-buffer (current-buffer))
+        (dotimes (_ 20)
+          (let ((beg (point)))
+            (insert (propertize "word" 'face spec) " word\n")
+            (overlay-put (make-overlay beg (1- (point))) 'face 'bold)
+            (overlay-put (make-overlay (+ beg 2) (+ beg 7))
+                         'face 'xfaces-tests--face)))
+        (goto-char (point-min))
+        (redisplay t)
+        (face-cache-statistics t)
+        (set-window-start nil (point-min))
+        (redisplay t)
+        (let ((stats (face-cache-statistics t)))
+          (should (> (alist-get 'merge-lookups stats) 20))
+          (should (> (* 2 (alist-get 'merge-hits stats))
+                     (alist-get 'merge-lookups stats)))
+          (should (= (alist-get 'realized stats) 0)))
+        ;; Changing a face in the stack realizes new faces.
+        (set-face-attribute 'xfaces-tests--face frame :foreground "#654321")
+        (redisplay t)
+        (should (> (alist-get 'realized (face-cache-statistics t)) 0))
+        ;; So does modifying a face property list in place.
+        (setcar (cdr spec) "#222222")
+        (redraw-frame)
+        (redisplay t)
+        (should (> (alist-get 'realized (face-cache-statistics t)) 0))))))
+
 (provide 'xfaces-tests)
 
 ;;; xfaces-tests.el ends here